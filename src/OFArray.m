@@ -27,6 +27,7 @@
 #import "OFConcreteArray.h"
 #import "OFData.h"
 #import "OFJSONRepresentationPrivate.h"
+#import "OFMessagePackRepresentationPrivate.h"
 #import "OFNull.h"
 #import "OFString.h"
 #import "OFSubarray.h"
@@ -35,7 +36,8 @@
 #import "OFInvalidArgumentException.h"
 #import "OFOutOfRangeException.h"
 
-@interface OFArray () <OFJSONRepresentationPrivate>
+@interface OFArray () <OFJSONRepresentationPrivate,
+    OFMessagePackRepresentationPrivate>
 @end
 
 @interface OFPlaceholderArray: OFArray
@@ -606,82 +608,87 @@ OF_SINGLETON_METHODS
 
 - (OFString *)JSONRepresentation
 {
-	return [self of_JSONRepresentationWithOptions: 0 depth: 0];
+	return [self JSONRepresentationWithOptions: 0];
 }
 
 - (OFString *)JSONRepresentationWithOptions:
     (OFJSONRepresentationOptions)options
 {
-	return [self of_JSONRepresentationWithOptions: options depth: 0];
+	OFMutableString *JSON = [OFMutableString string];
+
+	[self of_appendJSONRepresentationToString: JSON
+					  options: options
+					    depth: 0];
+	[JSON makeImmutable];
+
+	return JSON;
 }
 
-- (OFString *)
-    of_JSONRepresentationWithOptions: (OFJSONRepresentationOptions)options
-			       depth: (size_t)depth
+- (void)
+    of_appendJSONRepresentationToString: (OFMutableString *)JSON
+				options: (OFJSONRepresentationOptions)options
+				  depth: (size_t)depth
 {
-	OFMutableString *JSON = [OFMutableString stringWithString: @"["];
-	void *pool = objc_autoreleasePoolPush();
 	size_t i, count = self.count;
 
-	if (options & OFJSONRepresentationOptionPretty) {
-		OFMutableString *indentation = [OFMutableString string];
-
-		for (i = 0; i < depth; i++)
-			[indentation appendString: @"\t"];
+	[JSON appendString: @"["];
 
+	if (options & OFJSONRepresentationOptionPretty) {
 		[JSON appendString: @"\n"];
 
 		i = 0;
 		for (id object in self) {
-			void *pool2 = objc_autoreleasePoolPush();
+			void *pool = objc_autoreleasePoolPush();
 
-			[JSON appendString: indentation];
-			[JSON appendString: @"\t"];
-			[JSON appendString: [object
-			    of_JSONRepresentationWithOptions: options
-						       depth: depth + 1]];
+			for (size_t j = 0; j <= depth; j++)
+				[JSON appendString: @"\t"];
+
+			[object of_appendJSONRepresentationToString: JSON
+							    options: options
+							      depth: depth + 1];
 
 			if (++i < count)
 				[JSON appendString: @",\n"];
 			else
 				[JSON appendString: @"\n"];
 
-			objc_autoreleasePoolPop(pool2);
+			objc_autoreleasePoolPop(pool);
 		}
 
-		[JSON appendString: indentation];
+		for (i = 0; i < depth; i++)
+			[JSON appendString: @"\t"];
 	} else {
 		i = 0;
 		for (id object in self) {
-			void *pool2 = objc_autoreleasePoolPush();
+			void *pool = objc_autoreleasePoolPush();
 
-			[JSON appendString: [object
-			    of_JSONRepresentationWithOptions: options
-						       depth: depth + 1]];
+			[object of_appendJSONRepresentationToString: JSON
+							    options: options
+							      depth: depth + 1];
 
 			if (++i < count)
 				[JSON appendString: @","];
 
-			objc_autoreleasePoolPop(pool2);
+			objc_autoreleasePoolPop(pool);
 		}
 	}
 
 	[JSON appendString: @"]"];
-	[JSON makeImmutable];
-
-	objc_autoreleasePoolPop(pool);
-
-	return JSON;
 }
 
 - (OFData *)messagePackRepresentation
 {
-	OFMutableData *data;
-	size_t i, count;
-	void *pool;
+	OFMutableData *data = [OFMutableData data];
 
-	data = [OFMutableData data];
-	count = self.count;
+	[self of_appendMessagePackRepresentationToData: data];
+	[data makeImmutable];
+
+	return data;
+}
+
+- (void)of_appendMessagePackRepresentationToData: (OFMutableData *)data
+{
+	size_t i, count = self.count;
 
 	if (count <= 15) {
 		uint8_t tmp = 0x90 | ((uint8_t)count & 0xF);
@@ -701,28 +708,17 @@ OF_SINGLETON_METHODS
 	} else
 		@throw [OFOutOfRangeException exception];
 
-	pool = objc_autoreleasePoolPush();
-
 	i = 0;
 	for (id object in self) {
-		void *pool2 = objc_autoreleasePoolPush();
-		OFData *child;
+		void *pool = objc_autoreleasePoolPush();
 
 		i++;
+		_OFAppendMessagePackRepresentation(data, object);
 
-		child = [object messagePackRepresentation];
-		[data addItems: child.items count: child.count];
-
-		objc_autoreleasePoolPop(pool2);
+		objc_autoreleasePoolPop(pool);
 	}
 
 	OFAssert(i == count);
-
-	[data makeImmutable];
-
-	objc_autoreleasePoolPop(pool);
-
-	return data;
 }
 
 - (void)makeObjectsPerformSelector: (SEL)selector
@@ -280,5 +280,31 @@ struct ATInterfaceConfig {
 							     errNo: 0];
 	}
 }
+
+/*
+ * The protocol type needs to be prepended and stripped for every packet, so
+ * fall back to sending and receiving one packet at a time.
+ */
+- (size_t)receivePackets: (OFDatagramSocketPacket *)packets
+		   count: (size_t)count
+{
+	if (count == 0)
+		return 0;
+
+	packets[0].length = [self receiveIntoBuffer: packets[0].buffer
+					     length: packets[0].length
+					     sender: &packets[0].address];
+
+	return 1;
+}
+
+- (void)sendPackets: (const OFDatagramSocketPacket *)packets
+	      count: (size_t)count
+{
+	for (size_t i = 0; i < count; i++)
+		[self sendBuffer: packets[i].buffer
+			  length: packets[i].length
+			receiver: &packets[i].address];
+}
 #endif
 @end
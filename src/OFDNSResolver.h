@@ -30,14 +30,13 @@ OF_ASSUME_NONNULL_BEGIN
 
 @class OFArray OF_GENERIC(ObjectType);
 @class OFDNSResolver;
+@class OFDNSResolverCache;
 @class OFDNSResolverContext;
 @class OFDNSResolverSettings;
-@class OFDate;
 @class OFDictionary OF_GENERIC(KeyType, ObjectType);
 @class OFMutableArray OF_GENERIC(ObjectType);
 @class OFMutableDictionary OF_GENERIC(KeyType, ObjectType);
 @class OFNumber;
-@class OFPair OF_GENERIC(FirstType, SecondType);
 @class OFTCPSocket;
 @class OFUDPSocket;
 
@@ -140,12 +139,14 @@ OF_SUBCLASSING_RESTRICTED
 	    *_queries;
 	OFMutableDictionary OF_GENERIC(OFTCPSocket *, OFDNSResolverContext *)
 	    *_TCPQueries;
-	OFMutableDictionary OF_GENERIC(OFDNSQuery *,
-	    OFPair OF_GENERIC(OFDate *, OFDNSResponse *) *) *_cache;
+	OFDNSResolverCache *_cache;
 	OFMutableArray OF_GENERIC(OFString *) *_lastNameServers;
-	OFTimeInterval _lastCacheCleanup;
 }
 
+#ifdef OF_HAVE_CLASS_PROPERTIES
+@property (class, nonatomic) size_t cacheSize;
+#endif
+
 /**
  * @brief A dictionary of static hosts.
  *
@@ -233,6 +234,48 @@ OF_SUBCLASSING_RESTRICTED
  */
 @property (nonatomic) OFTimeInterval configReloadInterval;
 
+/**
+ * @brief The number of queries that were answered from the cache.
+ *
+ * The cache is shared by all resolvers using the same name servers, so this
+ * includes queries performed by other resolvers, e.g. those of other threads.
+ */
+@property (readonly, nonatomic) unsigned long long numberOfCacheHits;
+
+/**
+ * @brief The number of queries that could not be answered from the cache.
+ *
+ * The cache is shared by all resolvers using the same name servers, so this
+ * includes queries performed by other resolvers, e.g. those of other threads.
+ */
+@property (readonly, nonatomic) unsigned long long numberOfCacheMisses;
+
+/**
+ * @brief Returns the maximum number of responses that are cached per set of
+ *	  name servers.
+ *
+ * @return The maximum number of responses that are cached per set of name
+ *	   servers
+ */
++ (size_t)cacheSize;
+
+/**
+ * @brief Sets the maximum number of responses that are cached per set of name
+ *	  servers.
+ *
+ * Responses are cached until the lowest TTL of their records expires. If the
+ * cache is full, the least recently used response is removed from it. Name
+ * errors and responses without answers are cached as specified in RFC 2308.
+ *
+ * The cache is shared by all resolvers that use the same name servers, so a
+ * response received by one thread can be used by all other threads. A size of
+ * 0 disables caching.
+ *
+ * @param cacheSize The maximum number of responses to cache per set of name
+ *		    servers
+ */
++ (void)setCacheSize: (size_t)cacheSize;
+
 /**
  * @brief Creates a new, autoreleased OFDNSResolver.
  */
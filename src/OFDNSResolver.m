@@ -24,6 +24,7 @@
 #import "OFDNSResolver.h"
 #import "OFArray.h"
 #import "OFDNSQuery.h"
+#import "OFDNSResolverCache.h"
 #import "OFDNSResolverSettings.h"
 #import "OFDNSResponse.h"
 #import "OFData.h"
@@ -31,7 +32,6 @@
 #import "OFDictionary.h"
 #import "OFHostAddressResolver.h"
 #import "OFNumber.h"
-#import "OFPair.h"
 #import "OFSocket.h"
 #import "OFSocket+Private.h"
 #import "OFString.h"
@@ -93,6 +93,10 @@ OF_DIRECT_MEMBERS
 		     delegate: (id <OFDNSResolverQueryDelegate>)delegate;
 @end
 
+@interface OFDNSResolverPrefetchDelegate: OFObject
+    <OFDNSResolverQueryDelegate>
+@end
+
 static OFString *
 parseString(const unsigned char *buffer, size_t length, size_t *i)
 {
@@ -520,20 +524,6 @@ parseSection(const unsigned char *buffer, size_t length, size_t *i,
 	return ret;
 }
 
-static bool
-containsExpiredRecord(OFDNSResponseRecords responseRecords, uint32_t age)
-{
-	OFEnumerator *enumerator = [responseRecords objectEnumerator];
-	OFArray OF_GENERIC(OFDNSResourceRecord *) *records;
-
-	while ((records = [enumerator nextObject]) != nil)
-		for (OFDNSResourceRecord *record in records)
-			if (record.TTL < age)
-				return true;
-
-	return false;
-}
-
 @implementation OFDNSResolverContext
 - (instancetype)initWithQuery: (OFDNSQuery *)query
 			   ID: (OFNumber *)ID
@@ -619,7 +609,27 @@ containsExpiredRecord(OFDNSResponseRecords responseRecords, uint32_t age)
 }
 @end
 
+@implementation OFDNSResolverPrefetchDelegate
+-  (void)resolver: (OFDNSResolver *)resolver
+  didPerformQuery: (OFDNSQuery *)query
+	 response: (OFDNSResponse *)response
+	exception: (id)exception
+{
+	/* The resolver already updated the cache. */
+}
+@end
+
 @implementation OFDNSResolver
++ (size_t)cacheSize
+{
+	return [OFDNSResolverCache cacheSize];
+}
+
++ (void)setCacheSize: (size_t)cacheSize
+{
+	[OFDNSResolverCache setCacheSize: cacheSize];
+}
+
 + (instancetype)resolver
 {
 	return [[[self alloc] init] autorelease];
@@ -637,7 +647,6 @@ containsExpiredRecord(OFDNSResponseRecords responseRecords, uint32_t age)
 		_settings = [[OFDNSResolverSettings alloc] init];
 		_queries = [[OFMutableDictionary alloc] init];
 		_TCPQueries = [[OFMutableDictionary alloc] init];
-		_cache = [[OFMutableDictionary alloc] init];
 
 		[_settings reload];
 	} @catch (id e) {
@@ -853,41 +862,34 @@ containsExpiredRecord(OFDNSResponseRecords responseRecords, uint32_t age)
 
 - (void)of_cleanUpCache
 {
-	OFTimeInterval now = [[OFDate date] timeIntervalSince1970];
-	OFMutableArray *removeList;
+	if (_cache == nil || (_lastNameServers != _settings->_nameServers &&
+	    ![_lastNameServers isEqual: _settings->_nameServers])) {
+		OFArray *oldNameServers = _lastNameServers;
+		OFDNSResolverCache *oldCache = _cache;
 
-	if (_lastNameServers != _settings->_nameServers &&
-	    ![_lastNameServers isEqual: _settings->_nameServers]) {
-		OFArray *old = _lastNameServers;
 		_lastNameServers = [_settings->_nameServers copy];
-		[old release];
-
-		[_cache removeAllObjects];
+		[oldNameServers release];
 
-		return;
+		_cache = [[OFDNSResolverCache
+		    cacheForNameServers: _lastNameServers] retain];
+		[oldCache release];
 	}
 
-	if (now - _lastCacheCleanup < 1)
-		return;
+	[_cache removeExpiredEntries];
+}
 
-	_lastCacheCleanup = now;
-	removeList = [OFMutableArray arrayWithCapacity: _cache.count];
+- (unsigned long long)numberOfCacheHits
+{
+	[self of_cleanUpCache];
 
-	for (OFDNSQuery *query in _cache) {
-		OFPair OF_GENERIC(OFDate *, OFDNSResponse *) *entry =
-		    [_cache objectForKey: query];
-		uint32_t age = (uint32_t)now -
-		    (uint32_t)[entry.firstObject timeIntervalSince1970];
-		OFDNSResponse *response = entry.secondObject;
+	return _cache.numberOfHits;
+}
 
-		if (containsExpiredRecord(response.answerRecords, age) ||
-		    containsExpiredRecord(response.authorityRecords, age) ||
-		    containsExpiredRecord(response.additionalRecords, age))
-			[removeList addObject: query];
-	}
+- (unsigned long long)numberOfCacheMisses
+{
+	[self of_cleanUpCache];
 
-	for (OFDNSQuery *query in removeList)
-		[_cache removeObjectForKey: query];
+	return _cache.numberOfMisses;
 }
 
 - (void)asyncPerformQuery: (OFDNSQuery *)query
@@ -898,43 +900,12 @@ containsExpiredRecord(OFDNSResponseRecords responseRecords, uint32_t age)
 		       delegate: delegate];
 }
 
-- (void)asyncPerformQuery: (OFDNSQuery *)query
-	      runLoopMode: (OFRunLoopMode)runLoopMode
-		 delegate: (id <OFDNSResolverQueryDelegate>)delegate
+- (void)of_performQuery: (OFDNSQuery *)query
+	    runLoopMode: (OFRunLoopMode)runLoopMode
+	       delegate: (id <OFDNSResolverQueryDelegate>)delegate
 {
-	void *pool = objc_autoreleasePoolPush();
 	OFNumber *ID;
 	OFDNSResolverContext *context;
-	OFPair OF_GENERIC(OFDate *, OFDNSResponse *) *cacheEntry;
-
-	[self of_cleanUpCache];
-
-	if ((cacheEntry = [_cache objectForKey: query]) != nil) {
-		uint32_t age =
-		    (uint32_t)-[cacheEntry.firstObject timeIntervalSinceNow];
-		OFDNSResponse *response = cacheEntry.secondObject;
-
-		if (!containsExpiredRecord(response.answerRecords, age) &&
-		    !containsExpiredRecord(response.authorityRecords, age) &&
-		    !containsExpiredRecord(response.additionalRecords, age)) {
-			OFTimer *timer = [OFTimer
-			    timerWithTimeInterval: 0
-					   target: delegate
-					 selector: @selector(resolver:
-						       didPerformQuery:response:
-						       exception:)
-					   object: self
-					   object: query
-					   object: response
-					   object: nil
-					  repeats: false];
-			[[OFRunLoop currentRunLoop] addTimer: timer
-						     forMode: runLoopMode];
-
-			objc_autoreleasePoolPop(pool);
-			return;
-		}
-	}
 
 	/* Random, unused ID */
 	do {
@@ -961,6 +932,62 @@ containsExpiredRecord(OFDNSResponseRecords responseRecords, uint32_t age)
 		 settings: _settings
 		 delegate: delegate] autorelease];
 	[self of_sendQueryForContext: context runLoopMode: runLoopMode];
+}
+
+- (void)asyncPerformQuery: (OFDNSQuery *)query
+	      runLoopMode: (OFRunLoopMode)runLoopMode
+		 delegate: (id <OFDNSResolverQueryDelegate>)delegate
+{
+	void *pool = objc_autoreleasePoolPush();
+	OFDNSResolverCacheEntry *cacheEntry;
+	bool shouldPrefetch;
+
+	[self of_cleanUpCache];
+
+	if ((cacheEntry = [_cache entryForQuery: query
+				 shouldPrefetch: &shouldPrefetch]) != nil) {
+		OFDNSResponse *response = nil;
+		id exception = nil;
+		OFTimer *timer;
+
+		if (cacheEntry->_nameError)
+			exception = [OFDNSQueryFailedException
+			    exceptionWithQuery: query
+				     errorCode:
+				     OFDNSResolverErrorCodeServerNameError];
+		else
+			response = cacheEntry->_response;
+
+		timer = [OFTimer
+		    timerWithTimeInterval: 0
+				   target: delegate
+				 selector: @selector(resolver:didPerformQuery:
+					       response:exception:)
+				   object: self
+				   object: query
+				   object: response
+				   object: exception
+				  repeats: false];
+		[[OFRunLoop currentRunLoop] addTimer: timer
+					     forMode: runLoopMode];
+
+		/*
+		 * Refresh popular entries before they expire, so that they
+		 * can still be answered from the cache afterwards.
+		 */
+		if (shouldPrefetch)
+			[self of_performQuery: query
+				  runLoopMode: runLoopMode
+				     delegate: [[[OFDNSResolverPrefetchDelegate
+						   alloc] init] autorelease]];
+
+		objc_autoreleasePoolPop(pool);
+		return;
+	}
+
+	[self of_performQuery: query
+		  runLoopMode: runLoopMode
+		     delegate: delegate];
 
 	objc_autoreleasePoolPop(pool);
 }
@@ -1025,6 +1052,7 @@ containsExpiredRecord(OFDNSResponseRecords responseRecords, uint32_t age)
 	OFDictionary *additionalRecords = nil;
 	OFDNSResponse *response = nil;
 	id exception = nil;
+	bool nameError = false;
 	OFNumber *ID;
 	OFDNSResolverContext *context;
 
@@ -1131,7 +1159,13 @@ containsExpiredRecord(OFDNSResponseRecords responseRecords, uint32_t age)
 			}
 		}
 
-		if (buffer[3] & 0x0F)
+		/*
+		 * Name errors still get their sections parsed, so that they
+		 * can be cached (RFC 2308).
+		 */
+		if (errorCode == OFDNSResolverErrorCodeServerNameError)
+			nameError = true;
+		else if (buffer[3] & 0x0F)
 			@throw [OFDNSQueryFailedException
 			    exceptionWithQuery: context->_query
 				     errorCode: errorCode];
@@ -1168,17 +1202,32 @@ containsExpiredRecord(OFDNSResponseRecords responseRecords, uint32_t age)
 		exception = e;
 	}
 
-	if (exception != nil)
-		response = nil;
+	/* If parsing the name error failed, that is what gets reported. */
+	if (nameError && exception == nil)
+		exception = [OFDNSQueryFailedException
+		    exceptionWithQuery: context->_query
+			     errorCode: OFDNSResolverErrorCodeServerNameError];
 
 	[self of_cleanUpCache];
 
-	if (response != nil)
-		[_cache setObject: [OFPair pairWithFirstObject: [OFDate date]
-						  secondObject: response]
-			   forKey: context->_query];
-	else
-		[_cache removeObjectForKey: context->_query];
+	if (exception == nil)
+		[_cache addResponse: response
+			  nameError: false
+			   forQuery: context->_query];
+	else if (nameError && response != nil)
+		[_cache addResponse: response
+			  nameError: true
+			   forQuery: context->_query];
+	else if (![context->_delegate isKindOfClass:
+	    [OFDNSResolverPrefetchDelegate class]])
+		/*
+		 * A failed prefetch keeps the entry, as it is still valid
+		 * until it expires.
+		 */
+		[_cache removeEntryForQuery: context->_query];
+
+	if (exception != nil)
+		response = nil;
 
 	[context->_delegate resolver: self
 		     didPerformQuery: context->_query
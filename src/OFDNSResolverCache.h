@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#import "OFObject.h"
+#import "OFList.h"
+
+OF_ASSUME_NONNULL_BEGIN
+
+@class OFArray OF_GENERIC(ObjectType);
+@class OFDNSQuery;
+@class OFDNSResponse;
+@class OFMutableDictionary OF_GENERIC(KeyType, ObjectType);
+#ifdef OF_HAVE_THREADS
+@class OFMutex;
+#endif
+
+OF_DIRECT_MEMBERS
+@interface OFDNSResolverCacheEntry: OFObject
+{
+@public
+	OFDNSQuery *_query;
+	OFDNSResponse *_response;
+	bool _nameError, _prefetching;
+	uint32_t _TTL;
+	OFTimeInterval _expiration;
+	unsigned long _numberOfHits;
+	OFListItem _listItem;
+}
+@end
+
+@interface OFDNSResolverCache: OFObject
+{
+	OFMutableDictionary OF_GENERIC(OFDNSQuery *, OFDNSResolverCacheEntry *)
+	    *_entries;
+	/* Most recently used first */
+	OFList OF_GENERIC(OFDNSResolverCacheEntry *) *_LRUList;
+	size_t _size;
+	OFTimeInterval _nextExpiration;
+	unsigned long long _numberOfHits, _numberOfMisses;
+#ifdef OF_HAVE_THREADS
+	OFMutex *_mutex;
+#endif
+}
+
+#ifdef OF_HAVE_CLASS_PROPERTIES
+@property (class, nonatomic) size_t cacheSize;
+#endif
+@property (readonly, nonatomic) unsigned long long numberOfHits;
+@property (readonly, nonatomic) unsigned long long numberOfMisses;
+
++ (size_t)cacheSize;
++ (void)setCacheSize: (size_t)cacheSize;
++ (OFDNSResolverCache *)cacheForNameServers:
+    (nullable OFArray OF_GENERIC(OFString *) *)nameServers;
+- (nullable OFDNSResolverCacheEntry *)entryForQuery: (OFDNSQuery *)query
+				     shouldPrefetch: (bool *)shouldPrefetch;
+- (void)addResponse: (OFDNSResponse *)response
+	  nameError: (bool)nameError
+	   forQuery: (OFDNSQuery *)query;
+- (void)removeEntryForQuery: (OFDNSQuery *)query;
+- (void)removeExpiredEntries;
+@end
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* No OF_VISIBILITY_HIDDEN so tests can call it. */
+extern uint32_t _OFDNSResolverCacheTTL(OFDNSResponse *response,
+    bool nameError);
+#ifdef __cplusplus
+}
+#endif
+
+OF_ASSUME_NONNULL_END
@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "config.h"
+
+#include <math.h>
+
+#import "OFDNSResolverCache.h"
+#import "OFArray.h"
+#import "OFDNSQuery.h"
+#import "OFDNSResponse.h"
+#import "OFDate.h"
+#import "OFDictionary.h"
+#import "OFList.h"
+#ifdef OF_HAVE_THREADS
+# import "OFMutex.h"
+#endif
+#import "OFSOADNSResourceRecord.h"
+
+/*
+ * RFC 8767 recommends to cap the TTL at 7 days, while RFC 2308 recommends to
+ * cache negative responses for no longer than 3 hours.
+ */
+static const uint32_t maxCacheTTL = 604800;
+static const uint32_t maxNegativeCacheTTL = 10800;
+
+/*
+ * Entries that were hit at least this often are refreshed in the background
+ * when less than a tenth of their TTL is left, so that popular names never
+ * expire from the cache.
+ */
+static const unsigned long prefetchMinHits = 2;
+static const uint32_t prefetchTTLDivisor = 10;
+
+/* Protected by cachesMutex. */
+static size_t cacheSize = 1024;
+
+@interface OFDNSResolverCache ()
+- (void)of_setSize: (size_t)size;
+@end
+
+static OFMutableDictionary OF_GENERIC(OFArray *, OFDNSResolverCache *) *caches;
+#ifdef OF_HAVE_THREADS
+static OFMutex *cachesMutex;
+#endif
+
+static uint32_t
+minTTLOfRecords(OFDNSResponseRecords responseRecords, uint32_t TTL)
+{
+	OFEnumerator *enumerator = [responseRecords objectEnumerator];
+	OFArray OF_GENERIC(OFDNSResourceRecord *) *records;
+
+	while ((records = [enumerator nextObject]) != nil)
+		for (OFDNSResourceRecord *record in records)
+			if (record.TTL < TTL)
+				TTL = record.TTL;
+
+	return TTL;
+}
+
+uint32_t
+_OFDNSResolverCacheTTL(OFDNSResponse *response, bool nameError)
+{
+	OFEnumerator *enumerator;
+	OFArray OF_GENERIC(OFDNSResourceRecord *) *records;
+	uint32_t TTL;
+
+	if (!nameError && response.answerRecords.count > 0) {
+		TTL = minTTLOfRecords(response.answerRecords, maxCacheTTL);
+		TTL = minTTLOfRecords(response.authorityRecords, TTL);
+		TTL = minTTLOfRecords(response.additionalRecords, TTL);
+
+		return TTL;
+	}
+
+	/*
+	 * RFC 2308: Negative responses are cached for the minimum of the TTL
+	 * of the SOA record in the authority section and its minimum field.
+	 * Negative responses without a SOA record must not be cached.
+	 */
+	TTL = UINT32_MAX;
+	enumerator = [response.authorityRecords objectEnumerator];
+	while ((records = [enumerator nextObject]) != nil) {
+		for (OFDNSResourceRecord *record in records) {
+			OFSOADNSResourceRecord *SOARecord;
+
+			if (![record isKindOfClass:
+			    [OFSOADNSResourceRecord class]])
+				continue;
+
+			SOARecord = (OFSOADNSResourceRecord *)record;
+
+			if (SOARecord.TTL < TTL)
+				TTL = SOARecord.TTL;
+			if (SOARecord.minTTL < TTL)
+				TTL = SOARecord.minTTL;
+		}
+	}
+
+	if (TTL == UINT32_MAX)
+		return 0;
+
+	return (TTL < maxNegativeCacheTTL ? TTL : maxNegativeCacheTTL);
+}
+
+@implementation OFDNSResolverCacheEntry
+- (void)dealloc
+{
+	[_query release];
+	[_response release];
+
+	[super dealloc];
+}
+@end
+
+@implementation OFDNSResolverCache
++ (void)initialize
+{
+	if (self != [OFDNSResolverCache class])
+		return;
+
+	caches = [[OFMutableDictionary alloc] init];
+#ifdef OF_HAVE_THREADS
+	cachesMutex = [[OFMutex alloc] init];
+#endif
+}
+
++ (OFDNSResolverCache *)cacheForNameServers: (OFArray *)nameServers
+{
+	OFDNSResolverCache *cache;
+
+	if (nameServers == nil)
+		nameServers = [OFArray array];
+
+#ifdef OF_HAVE_THREADS
+	[cachesMutex lock];
+	@try {
+#endif
+		cache = [caches objectForKey: nameServers];
+
+		if (cache == nil) {
+			cache = [[[OFDNSResolverCache alloc] init] autorelease];
+			cache->_size = cacheSize;
+			[caches setObject: cache forKey: nameServers];
+		}
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[cachesMutex unlock];
+	}
+#endif
+
+	return cache;
+}
+
++ (size_t)cacheSize
+{
+	size_t size;
+
+#ifdef OF_HAVE_THREADS
+	[cachesMutex lock];
+#endif
+	size = cacheSize;
+#ifdef OF_HAVE_THREADS
+	[cachesMutex unlock];
+#endif
+
+	return size;
+}
+
++ (void)setCacheSize: (size_t)size
+{
+	void *pool = objc_autoreleasePoolPush();
+
+#ifdef OF_HAVE_THREADS
+	[cachesMutex lock];
+	@try {
+#endif
+		cacheSize = size;
+
+		/*
+		 * The caches mutex is held until all caches are resized, so
+		 * that concurrent calls can't leave them with different sizes.
+		 */
+		for (OFDNSResolverCache *cache in caches.allObjects)
+			[cache of_setSize: size];
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[cachesMutex unlock];
+	}
+#endif
+
+	objc_autoreleasePoolPop(pool);
+}
+
+- (instancetype)init
+{
+	self = [super init];
+
+	@try {
+		_entries = [[OFMutableDictionary alloc] init];
+		_LRUList = [[OFList alloc] init];
+		_nextExpiration = INFINITY;
+#ifdef OF_HAVE_THREADS
+		_mutex = [[OFMutex alloc] init];
+#endif
+	} @catch (id e) {
+		[self release];
+		@throw e;
+	}
+
+	return self;
+}
+
+- (void)dealloc
+{
+	[_entries release];
+	[_LRUList release];
+#ifdef OF_HAVE_THREADS
+	[_mutex release];
+#endif
+
+	[super dealloc];
+}
+
+- (unsigned long long)numberOfHits
+{
+	unsigned long long numberOfHits;
+
+#ifdef OF_HAVE_THREADS
+	[_mutex lock];
+#endif
+	numberOfHits = _numberOfHits;
+#ifdef OF_HAVE_THREADS
+	[_mutex unlock];
+#endif
+
+	return numberOfHits;
+}
+
+- (unsigned long long)numberOfMisses
+{
+	unsigned long long numberOfMisses;
+
+#ifdef OF_HAVE_THREADS
+	[_mutex lock];
+#endif
+	numberOfMisses = _numberOfMisses;
+#ifdef OF_HAVE_THREADS
+	[_mutex unlock];
+#endif
+
+	return numberOfMisses;
+}
+
+/* Must be called with the mutex locked. */
+- (void)of_removeEntry: (OFDNSResolverCacheEntry *)entry
+{
+	/* The list still retains the entry. */
+	[_entries removeObjectForKey: entry->_query];
+	[_LRUList removeListItem: entry->_listItem];
+}
+
+- (OFDNSResolverCacheEntry *)entryForQuery: (OFDNSQuery *)query
+			    shouldPrefetch: (bool *)shouldPrefetch
+{
+	OFTimeInterval now = [[OFDate date] timeIntervalSince1970];
+	OFDNSResolverCacheEntry *entry;
+
+	*shouldPrefetch = false;
+
+#ifdef OF_HAVE_THREADS
+	[_mutex lock];
+	@try {
+#endif
+		entry = [_entries objectForKey: query];
+
+		if (entry != nil && entry->_expiration <= now) {
+			[self of_removeEntry: entry];
+			entry = nil;
+		}
+
+		if (entry == nil) {
+			_numberOfMisses++;
+			return nil;
+		}
+
+		_numberOfHits++;
+		entry->_numberOfHits++;
+
+		[[entry retain] autorelease];
+
+		if (entry->_listItem != _LRUList.firstListItem) {
+			[_LRUList removeListItem: entry->_listItem];
+			entry->_listItem = [_LRUList prependObject: entry];
+		}
+
+		if (!entry->_nameError && !entry->_prefetching &&
+		    entry->_numberOfHits >= prefetchMinHits &&
+		    entry->_expiration - now <
+		    entry->_TTL / prefetchTTLDivisor) {
+			entry->_prefetching = true;
+			*shouldPrefetch = true;
+		}
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[_mutex unlock];
+	}
+#endif
+
+	return entry;
+}
+
+- (void)addResponse: (OFDNSResponse *)response
+	  nameError: (bool)nameError
+	   forQuery: (OFDNSQuery *)query
+{
+	uint32_t TTL = _OFDNSResolverCacheTTL(response, nameError);
+	OFDNSResolverCacheEntry *entry = nil, *oldEntry;
+
+	if (TTL > 0) {
+		entry = [[[OFDNSResolverCacheEntry alloc] init] autorelease];
+		entry->_query = [query copy];
+		entry->_response = [response retain];
+		entry->_nameError = nameError;
+		entry->_TTL = TTL;
+		entry->_expiration =
+		    [[OFDate date] timeIntervalSince1970] + TTL;
+	}
+
+#ifdef OF_HAVE_THREADS
+	[_mutex lock];
+	@try {
+#endif
+		if ((oldEntry = [_entries objectForKey: query]) != nil)
+			[self of_removeEntry: oldEntry];
+
+		if (entry == nil || _size == 0)
+			return;
+
+		entry->_listItem = [_LRUList prependObject: entry];
+		@try {
+			[_entries setObject: entry forKey: entry->_query];
+		} @catch (id e) {
+			[_LRUList removeListItem: entry->_listItem];
+			@throw e;
+		}
+
+		if (entry->_expiration < _nextExpiration)
+			_nextExpiration = entry->_expiration;
+
+		while (_entries.count > _size)
+			[self of_removeEntry: _LRUList.lastObject];
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[_mutex unlock];
+	}
+#endif
+}
+
+- (void)removeEntryForQuery: (OFDNSQuery *)query
+{
+#ifdef OF_HAVE_THREADS
+	[_mutex lock];
+	@try {
+#endif
+		OFDNSResolverCacheEntry *entry = [_entries objectForKey: query];
+
+		if (entry != nil)
+			[self of_removeEntry: entry];
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[_mutex unlock];
+	}
+#endif
+}
+
+- (void)removeExpiredEntries
+{
+	OFTimeInterval now = [[OFDate date] timeIntervalSince1970];
+
+#ifdef OF_HAVE_THREADS
+	[_mutex lock];
+	@try {
+#endif
+		OFTimeInterval nextExpiration = INFINITY;
+		OFListItem iter;
+
+		/*
+		 * Only look at the entries once the earliest expiration has
+		 * been reached, instead of every time.
+		 */
+		if (now < _nextExpiration)
+			return;
+
+		iter = _LRUList.firstListItem;
+		while (iter != NULL) {
+			OFDNSResolverCacheEntry *entry = OFListItemObject(iter);
+
+			iter = OFListItemNext(iter);
+
+			if (entry->_expiration <= now)
+				[self of_removeEntry: entry];
+			else if (entry->_expiration < nextExpiration)
+				nextExpiration = entry->_expiration;
+		}
+
+		_nextExpiration = nextExpiration;
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[_mutex unlock];
+	}
+#endif
+}
+
+- (void)of_setSize: (size_t)size
+{
+#ifdef OF_HAVE_THREADS
+	[_mutex lock];
+	@try {
+#endif
+		_size = size;
+
+		while (_entries.count > size)
+			[self of_removeEntry: _LRUList.lastObject];
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[_mutex unlock];
+	}
+#endif
+}
+@end
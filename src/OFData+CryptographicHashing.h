@@ -21,7 +21,9 @@
 
 OF_ASSUME_NONNULL_BEGIN
 
+@class OFArray OF_GENERIC(ObjectType);
 @class OFString;
+@protocol OFCryptographicHash;
 
 #ifdef __cplusplus
 extern "C" {
@@ -66,6 +68,23 @@ extern int _OFData_CryptographicHashing_reference OF_VISIBILITY_HIDDEN;
  * @brief The SHA-512 hash of the data as a string.
  */
 @property (readonly, nonatomic) OFString *stringBySHA512Hashing;
+
+/**
+ * @brief Hashes each of the data in the specified array and returns all
+ *	  digests.
+ *
+ * For MD5, SHA-1, SHA-224 and SHA-256, several data are hashed at the same
+ * time using SIMD, which is a lot faster than hashing one after another when
+ * there are many small data. If the CPU has instructions for the hash, they
+ * are hashed one after another instead, as that is faster then.
+ *
+ * @param array An array of data to hash
+ * @param hashClass The class of the cryptographic hash to use
+ * @return Data with an item size of the digest size of the hash class that
+ *	   contains the digest of each data in the array, in the same order
+ */
++ (OFData *)digestsOfDataInArray: (OFArray OF_GENERIC(OFData *) *)array
+		       hashClass: (Class <OFCryptographicHash>)hashClass;
 @end
 
 OF_ASSUME_NONNULL_END
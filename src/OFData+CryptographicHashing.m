@@ -20,9 +20,11 @@
 #include "config.h"
 
 #import "OFData+CryptographicHashing.h"
+#import "OFArray.h"
 #import "OFString.h"
 #import "OFCryptographicHash.h"
 #import "OFMD5Hash.h"
+#import "OFMultiBufferHash.h"
 #import "OFRIPEMD160Hash.h"
 #import "OFSHA1Hash.h"
 #import "OFSHA224Hash.h"
@@ -65,6 +67,44 @@ stringByHashing(Class <OFCryptographicHash> class, OFData *self)
 				    length: digestSize * 2];
 }
 
++ (OFData *)digestsOfDataInArray: (OFArray OF_GENERIC(OFData *) *)array
+		       hashClass: (Class <OFCryptographicHash>)hashClass
+{
+	size_t count = array.count, digestSize = [hashClass digestSize];
+	const unsigned char **buffers = OFAllocMemory(count, sizeof(*buffers));
+	size_t *lengths = NULL;
+	unsigned char *digests = NULL;
+	OFData *ret;
+
+	@try {
+		size_t i = 0;
+
+		lengths = OFAllocMemory(count, sizeof(*lengths));
+		digests = OFAllocMemory(count, digestSize);
+
+		for (OFData *data in array) {
+			buffers[i] = data.items;
+			lengths[i++] = data.count * data.itemSize;
+		}
+
+		_OFMultiBufferHash(hashClass, NULL, buffers, lengths, count,
+		    digests, true);
+
+		ret = [OFData dataWithItemsNoCopy: digests
+					    count: count
+					 itemSize: digestSize
+				     freeWhenDone: true];
+	} @catch (id e) {
+		OFFreeMemory(digests);
+		@throw e;
+	} @finally {
+		OFFreeMemory(buffers);
+		OFFreeMemory(lengths);
+	}
+
+	return ret;
+}
+
 - (OFString *)stringByMD5Hashing
 {
 	return stringByHashing([OFMD5Hash class], self);
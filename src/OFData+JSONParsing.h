@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#import "OFData.h"
+
+OF_ASSUME_NONNULL_BEGIN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern int _OFData_JSONParsing_reference OF_VISIBILITY_HIDDEN;
+#ifdef __cplusplus
+}
+#endif
+
+@interface OFData (JSONParsing)
+/**
+ * @brief The data interpreted as UTF-8 encoded JSON and parsed as an object.
+ *
+ * This avoids creating an OFString for the entire document first. Strings
+ * contained in the JSON are validated when they are created. To parse a buffer
+ * without copying it, create the data using
+ * @ref dataWithItemsNoCopy:count:freeWhenDone:.
+ *
+ * @note This also allows parsing JSON5, an extension of JSON. See
+ *	 http://json5.org/ for more details.
+ *
+ * @warning Although not specified by the JSON specification, this can also
+ *          return primitives like strings and numbers. See
+ *          @ref OFString#objectByParsingJSON for details.
+ *
+ * @throw OFInvalidJSONException The data contained invalid JSON
+ * @throw OFInvalidArgumentException The item size of the data is not 1
+ */
+@property (readonly, nonatomic) id objectByParsingJSON;
+
+/**
+ * @brief Creates an object from the data interpreted as UTF-8 encoded JSON.
+ *
+ * This avoids creating an OFString for the entire document first. Strings
+ * contained in the JSON are validated when they are created. To parse a buffer
+ * without copying it, create the data using
+ * @ref dataWithItemsNoCopy:count:freeWhenDone:.
+ *
+ * @note This also allows parsing JSON5, an extension of JSON. See
+ *	 http://json5.org/ for more details.
+ *
+ * @warning Although not specified by the JSON specification, this can also
+ *          return primitives like strings and numbers. See
+ *          @ref OFString#objectByParsingJSON for details.
+ *
+ * @param depthLimit The maximum depth the parser should accept (defaults to 32
+ *		     if not specified, 0 means no limit (insecure!))
+ * @return An object
+ * @throw OFInvalidJSONException The data contained invalid JSON
+ * @throw OFInvalidArgumentException The item size of the data is not 1
+ */
+- (id)objectByParsingJSONWithDepthLimit: (size_t)depthLimit;
+@end
+
+OF_ASSUME_NONNULL_END
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#import "OFData+JSONParsing.h"
+#import "OFString.h"
+#import "OFString+Private.h"
+
+#import "OFInvalidArgumentException.h"
+#import "OFInvalidEncodingException.h"
+#import "OFInvalidJSONException.h"
+
+int _OFData_JSONParsing_reference;
+
+@implementation OFData (JSONParsing)
+- (id)objectByParsingJSON
+{
+	return [self objectByParsingJSONWithDepthLimit: 32];
+}
+
+- (id)objectByParsingJSONWithDepthLimit: (size_t)depthLimit
+{
+	void *pool = objc_autoreleasePoolPush();
+	size_t count = self.count;
+	id object;
+	size_t line = 1;
+
+	if (self.itemSize != 1)
+		@throw [OFInvalidArgumentException exception];
+
+	@try {
+		object = _OFJSONParse(self.items, count, depthLimit, &line);
+	} @catch (OFInvalidEncodingException *e) {
+		object = nil;
+	}
+
+	if (object == nil) {
+		OFString *string = nil;
+
+		@try {
+			string = [OFString stringWithUTF8String: self.items
+							 length: count];
+		} @catch (OFInvalidEncodingException *e) {
+		}
+
+		@throw [OFInvalidJSONException exceptionWithString: string
+							      line: line];
+	}
+
+	[object retain];
+
+	objc_autoreleasePoolPop(pool);
+
+	return [object autorelease];
+}
+@end
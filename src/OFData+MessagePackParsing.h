@@ -34,6 +34,9 @@ extern int _OFData_MessagePackParsing_reference OF_VISIBILITY_HIDDEN;
  * @brief The data interpreted as MessagePack representation and parsed as an
  *	  object.
  *
+ * Binary data and extensions in the result reference the receiver instead of
+ * being copied, unless the receiver is mutable.
+ *
  * @throw OFInvalidFormatException The MessagePack representation contained in
  *				   the data contained an invalid format
  * @throw OFTruncatedDataException The MessagePack representation contained in
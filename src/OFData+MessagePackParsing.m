@@ -37,8 +37,8 @@
 
 int _OFData_MessagePackParsing_reference;
 
-static size_t parseObject(const unsigned char *buffer, size_t length,
-    id *object, size_t depthLimit);
+static size_t parseObject(OFData *parent, const unsigned char *buffer,
+    size_t length, id *object, size_t depthLimit);
 
 static uint16_t
 readUInt16(const unsigned char *buffer)
@@ -63,8 +63,8 @@ readUInt64(const unsigned char *buffer)
 }
 
 static size_t
-parseArray(const unsigned char *buffer, size_t length, id *object, size_t count,
-    size_t depthLimit)
+parseArray(OFData *parent, const unsigned char *buffer, size_t length,
+    id *object, size_t count, size_t depthLimit)
 {
 	void *pool;
 	size_t pos = 0;
@@ -84,7 +84,7 @@ parseArray(const unsigned char *buffer, size_t length, id *object, size_t count,
 
 		pool = objc_autoreleasePoolPush();
 
-		pos += parseObject(buffer + pos, length - pos, &child,
+		pos += parseObject(parent, buffer + pos, length - pos, &child,
 		    depthLimit);
 
 		[*object addObject: child];
@@ -96,8 +96,8 @@ parseArray(const unsigned char *buffer, size_t length, id *object, size_t count,
 }
 
 static size_t
-parseTable(const unsigned char *buffer, size_t length, id *object, size_t count,
-    size_t depthLimit)
+parseTable(OFData *parent, const unsigned char *buffer, size_t length,
+    id *object, size_t count, size_t depthLimit)
 {
 	void *pool;
 	size_t pos = 0;
@@ -117,9 +117,9 @@ parseTable(const unsigned char *buffer, size_t length, id *object, size_t count,
 
 		pool = objc_autoreleasePoolPush();
 
-		pos += parseObject(buffer + pos, length - pos, &key,
+		pos += parseObject(parent, buffer + pos, length - pos, &key,
 		    depthLimit);
-		pos += parseObject(buffer + pos, length - pos, &value,
+		pos += parseObject(parent, buffer + pos, length - pos, &value,
 		    depthLimit);
 
 		[*object setObject: value forKey: key];
@@ -130,6 +130,17 @@ parseTable(const unsigned char *buffer, size_t length, id *object, size_t count,
 	return pos;
 }
 
+/*
+ * Binary data and extensions reference the parsed data instead of copying it.
+ * For mutable data, this still creates a copy, as it could be modified.
+ */
+static OFData *
+subdata(OFData *parent, const unsigned char *start, size_t count)
+{
+	return [parent subdataWithRange: OFMakeRange(
+	    start - (const unsigned char *)parent.items, count)];
+}
+
 static OFDate *
 createDate(OFData *data)
 {
@@ -183,11 +194,10 @@ createExtension(int8_t type, OFData *data)
 }
 
 static size_t
-parseObject(const unsigned char *buffer, size_t length, id *object,
-    size_t depthLimit)
+parseObject(OFData *parent, const unsigned char *buffer, size_t length,
+    id *object, size_t depthLimit)
 {
 	size_t count;
-	OFData *data;
 
 	if (length < 1)
 		@throw [OFTruncatedDataException exception];
@@ -219,12 +229,12 @@ parseObject(const unsigned char *buffer, size_t length, id *object,
 
 	/* fixarray */
 	if ((buffer[0] & 0xF0) == 0x90)
-		return parseArray(buffer + 1, length - 1, object,
+		return parseArray(parent, buffer + 1, length - 1, object,
 		    buffer[0] & 0xF, depthLimit) + 1;
 
 	/* fixmap */
 	if ((buffer[0] & 0xF0) == 0x80)
-		return parseTable(buffer + 1, length - 1, object,
+		return parseTable(parent, buffer + 1, length - 1, object,
 		    buffer[0] & 0xF, depthLimit) + 1;
 
 	/* Prefix byte */
@@ -328,7 +338,7 @@ parseObject(const unsigned char *buffer, size_t length, id *object,
 		if (length < count + 2)
 			@throw [OFTruncatedDataException exception];
 
-		*object = [OFData dataWithItems: buffer + 2 count: count];
+		*object = subdata(parent, buffer + 2, count);
 
 		return count + 2;
 	case 0xC5: /* bin 16 */
@@ -340,7 +350,7 @@ parseObject(const unsigned char *buffer, size_t length, id *object,
 		if (length < count + 3)
 			@throw [OFTruncatedDataException exception];
 
-		*object = [OFData dataWithItems: buffer + 3 count: count];
+		*object = subdata(parent, buffer + 3, count);
 
 		return count + 3;
 	case 0xC6: /* bin 32 */
@@ -352,7 +362,7 @@ parseObject(const unsigned char *buffer, size_t length, id *object,
 		if (length < count + 5)
 			@throw [OFTruncatedDataException exception];
 
-		*object = [OFData dataWithItems: buffer + 5 count: count];
+		*object = subdata(parent, buffer + 5, count);
 
 		return count + 5;
 	/* Extensions */
@@ -365,12 +375,8 @@ parseObject(const unsigned char *buffer, size_t length, id *object,
 		if (length < count + 3)
 			@throw [OFTruncatedDataException exception];
 
-		data = [[OFData alloc] initWithItems: buffer + 3 count: count];
-		@try {
-			*object = createExtension(buffer[2], data);
-		} @finally {
-			[data release];
-		}
+		*object = createExtension(buffer[2],
+		    subdata(parent, buffer + 3, count));
 
 		return count + 3;
 	case 0xC8: /* ext 16 */
@@ -382,12 +388,8 @@ parseObject(const unsigned char *buffer, size_t length, id *object,
 		if (length < count + 4)
 			@throw [OFTruncatedDataException exception];
 
-		data = [[OFData alloc] initWithItems: buffer + 4 count: count];
-		@try {
-			*object = createExtension(buffer[3], data);
-		} @finally {
-			[data release];
-		}
+		*object = createExtension(buffer[3],
+		    subdata(parent, buffer + 4, count));
 
 		return count + 4;
 	case 0xC9: /* ext 32 */
@@ -399,72 +401,48 @@ parseObject(const unsigned char *buffer, size_t length, id *object,
 		if (length < count + 6)
 			@throw [OFTruncatedDataException exception];
 
-		data = [[OFData alloc] initWithItems: buffer + 6 count: count];
-		@try {
-			*object = createExtension(buffer[5], data);
-		} @finally {
-			[data release];
-		}
+		*object = createExtension(buffer[5],
+		    subdata(parent, buffer + 6, count));
 
 		return count + 6;
 	case 0xD4: /* fixext 1 */
 		if (length < 3)
 			@throw [OFTruncatedDataException exception];
 
-		data = [[OFData alloc] initWithItems: buffer + 2 count: 1];
-		@try {
-			*object = createExtension(buffer[1], data);
-		} @finally {
-			[data release];
-		}
+		*object = createExtension(buffer[1],
+		    subdata(parent, buffer + 2, 1));
 
 		return 3;
 	case 0xD5: /* fixext 2 */
 		if (length < 4)
 			@throw [OFTruncatedDataException exception];
 
-		data = [[OFData alloc] initWithItems: buffer + 2 count: 2];
-		@try {
-			*object = createExtension(buffer[1], data);
-		} @finally {
-			[data release];
-		}
+		*object = createExtension(buffer[1],
+		    subdata(parent, buffer + 2, 2));
 
 		return 4;
 	case 0xD6: /* fixext 4 */
 		if (length < 6)
 			@throw [OFTruncatedDataException exception];
 
-		data = [[OFData alloc] initWithItems: buffer + 2 count: 4];
-		@try {
-			*object = createExtension(buffer[1], data);
-		} @finally {
-			[data release];
-		}
+		*object = createExtension(buffer[1],
+		    subdata(parent, buffer + 2, 4));
 
 		return 6;
 	case 0xD7: /* fixext 8 */
 		if (length < 10)
 			@throw [OFTruncatedDataException exception];
 
-		data = [[OFData alloc] initWithItems: buffer + 2 count: 8];
-		@try {
-			*object = createExtension(buffer[1], data);
-		} @finally {
-			[data release];
-		}
+		*object = createExtension(buffer[1],
+		    subdata(parent, buffer + 2, 8));
 
 		return 10;
 	case 0xD8: /* fixext 16 */
 		if (length < 18)
 			@throw [OFTruncatedDataException exception];
 
-		data = [[OFData alloc] initWithItems: buffer + 2 count: 16];
-		@try {
-			*object = createExtension(buffer[1], data);
-		} @finally {
-			[data release];
-		}
+		*object = createExtension(buffer[1],
+		    subdata(parent, buffer + 2, 16));
 
 		return 18;
 	/* Strings */
@@ -512,26 +490,26 @@ parseObject(const unsigned char *buffer, size_t length, id *object,
 		if (length < 3)
 			@throw [OFTruncatedDataException exception];
 
-		return parseArray(buffer + 3, length - 3, object,
+		return parseArray(parent, buffer + 3, length - 3, object,
 		    readUInt16(buffer + 1), depthLimit) + 3;
 	case 0xDD: /* array 32 */
 		if (length < 5)
 			@throw [OFTruncatedDataException exception];
 
-		return parseArray(buffer + 5, length - 5, object,
+		return parseArray(parent, buffer + 5, length - 5, object,
 		    readUInt32(buffer + 1), depthLimit) + 5;
 	/* Maps */
 	case 0xDE: /* map 16 */
 		if (length < 3)
 			@throw [OFTruncatedDataException exception];
 
-		return parseTable(buffer + 3, length - 3, object,
+		return parseTable(parent, buffer + 3, length - 3, object,
 		    readUInt16(buffer + 1), depthLimit) + 3;
 	case 0xDF: /* map 32 */
 		if (length < 5)
 			@throw [OFTruncatedDataException exception];
 
-		return parseTable(buffer + 5, length - 5, object,
+		return parseTable(parent, buffer + 5, length - 5, object,
 		    readUInt32(buffer + 1), depthLimit) + 5;
 	default:
 		@throw [OFInvalidFormatException exception];
@@ -553,7 +531,8 @@ parseObject(const unsigned char *buffer, size_t length, id *object,
 	if (self.itemSize != 1)
 		@throw [OFInvalidArgumentException exception];
 
-	if (parseObject(self.items, count, &object, depthLimit) != count)
+	if (parseObject(self, self.items, count, &object, depthLimit) !=
+	    count)
 		@throw [OFInvalidFormatException exception];
 
 	[object retain];
@@ -33,6 +33,7 @@
 #endif
 #import "OFIRI.h"
 #import "OFIRIHandler.h"
+#import "OFMessagePackRepresentationPrivate.h"
 #import "OFStream.h"
 #import "OFString.h"
 #import "OFSubdata.h"
@@ -50,6 +51,9 @@ static struct {
 	Class isa;
 } placeholder;
 
+@interface OFData () <OFMessagePackRepresentationPrivate>
+@end
+
 @interface OFPlaceholderData: OFString
 @end
 
@@ -58,6 +62,7 @@ void OF_VISIBILITY_HIDDEN
 _references_to_categories_of_OFData(void)
 {
 	_OFData_CryptographicHashing_reference = 1;
+	_OFData_JSONParsing_reference = 1;
 	_OFData_MessagePackParsing_reference = 1;
 }
 
@@ -697,8 +702,19 @@ OF_SINGLETON_METHODS
 
 - (OFData *)messagePackRepresentation
 {
-	OFMutableData *data;
-	size_t count;
+	OFMutableData *data =
+	    [OFMutableData dataWithCapacity: self.count * self.itemSize + 5];
+
+	[self of_appendMessagePackRepresentationToData: data];
+	[data makeImmutable];
+
+	return data;
+}
+
+- (void)of_appendMessagePackRepresentationToData: (OFMutableData *)data
+{
+	unsigned char buffer[5];
+	size_t count, bufferLength;
 
 	if (self.itemSize != 1)
 		@throw [OFNotImplementedException exceptionWithSelector: _cmd
@@ -707,32 +723,25 @@ OF_SINGLETON_METHODS
 	count = self.count;
 
 	if (count <= UINT8_MAX) {
-		uint8_t type = 0xC4;
-		uint8_t tmp = (uint8_t)count;
-
-		data = [OFMutableData dataWithCapacity: count + 2];
-		[data addItem: &type];
-		[data addItem: &tmp];
+		buffer[0] = 0xC4;
+		buffer[1] = (uint8_t)count;
+		bufferLength = 2;
 	} else if (count <= UINT16_MAX) {
-		uint8_t type = 0xC5;
 		uint16_t tmp = OFToBigEndian16((uint16_t)count);
 
-		data = [OFMutableData dataWithCapacity: count + 3];
-		[data addItem: &type];
-		[data addItems: &tmp count: sizeof(tmp)];
+		buffer[0] = 0xC5;
+		memcpy(buffer + 1, &tmp, sizeof(tmp));
+		bufferLength = 3;
 	} else if (count <= UINT32_MAX) {
-		uint8_t type = 0xC6;
 		uint32_t tmp = OFToBigEndian32((uint32_t)count);
 
-		data = [OFMutableData dataWithCapacity: count + 5];
-		[data addItem: &type];
-		[data addItems: &tmp count: sizeof(tmp)];
+		buffer[0] = 0xC6;
+		memcpy(buffer + 1, &tmp, sizeof(tmp));
+		bufferLength = 5;
 	} else
 		@throw [OFOutOfRangeException exception];
 
+	[data addItems: buffer count: bufferLength];
 	[data addItems: self.items count: count];
-	[data makeImmutable];
-
-	return data;
 }
 @end
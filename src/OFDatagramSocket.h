@@ -29,6 +29,25 @@ OF_ASSUME_NONNULL_BEGIN
 @class OFData;
 @class OFDatagramSocket;
 
+/**
+ * @struct OFDatagramSocketPacket OFDatagramSocket.h ObjFW/ObjFW.h
+ *
+ * @brief A datagram for sending or receiving multiple datagrams at once.
+ */
+typedef struct {
+	/** @brief The buffer holding the datagram */
+	void *buffer;
+	/**
+	 * @brief The length of the datagram in the buffer.
+	 *
+	 * When receiving, this needs to be set to the length of the buffer and
+	 * is updated to the length of the received datagram.
+	 */
+	size_t length;
+	/** @brief The sender of a received or the receiver of a sent datagram */
+	OFSocketAddress address;
+} OFDatagramSocketPacket;
+
 #ifdef OF_HAVE_BLOCKS
 /**
  * @brief A block which is called when a packet has been received.
@@ -88,6 +107,35 @@ typedef OFData *_Nullable (^OFDatagramSocketAsyncSendDataBlock)(
 typedef OFData *_Nullable (^OFDatagramSocketDataSentHandler)(
     OFDatagramSocket *socket, OFData *data,
     const OFSocketAddress *_Nonnull receiver, id _Nullable exception);
+
+/**
+ * @brief A handler which is called when one or more packets have been
+ *	  received.
+ *
+ * @param socket The socket that received the packets
+ * @param packets The packets that have been received
+ * @param count The number of packets that have been received
+ * @param exception An exception which occurred while receiving or `nil` on
+ *		    success
+ * @return A bool whether the same handler should be used for the next receive
+ */
+typedef bool (^OFDatagramSocketPacketsReceivedHandler)(
+    OFDatagramSocket *socket, OFDatagramSocketPacket *packets, size_t count,
+    id _Nullable exception);
+
+/**
+ * @brief A handler which is called when one or more packets have been sent.
+ *
+ * @param socket The socket that sent the packets
+ * @param packets The packets that should have been sent
+ * @param count The number of packets that have been sent
+ * @param exception An exception which occurred while sending or `nil` on
+ *		    success
+ * @return A bool whether the same packets should be sent again
+ */
+typedef bool (^OFDatagramSocketPacketsSentHandler)(OFDatagramSocket *socket,
+    const OFDatagramSocketPacket *packets, size_t count,
+    id _Nullable exception);
 #endif
 
 /**
@@ -127,6 +175,35 @@ typedef OFData *_Nullable (^OFDatagramSocketDataSentHandler)(
 		didSendData: (OFData *)data
 		   receiver: (const OFSocketAddress *_Nonnull)receiver
 		  exception: (nullable id)exception;
+
+/**
+ * @brief This method is called when one or more packets have been received.
+ *
+ * @param socket The datagram socket which received the packets
+ * @param packets The packets that have been received
+ * @param count The number of packets that have been received
+ * @param exception An exception that occurred while receiving, or nil on
+ *		    success
+ * @return A bool whether the same packets should be used for the next receive
+ */
+-    (bool)socket: (OFDatagramSocket *)socket
+  didReceivePackets: (OFDatagramSocketPacket *)packets
+	      count: (size_t)count
+	  exception: (nullable id)exception;
+
+/**
+ * @brief This method is called when one or more packets have been sent.
+ *
+ * @param socket The datagram socket which sent the packets
+ * @param packets The packets that should have been sent
+ * @param count The number of packets that have been sent
+ * @param exception An exception that occurred while sending, or nil on success
+ * @return A bool whether the same packets should be sent again
+ */
+-   (bool)socket: (OFDatagramSocket *)socket
+  didSendPackets: (const OFDatagramSocketPacket *)packets
+	   count: (size_t)count
+       exception: (nullable id)exception;
 @end
 
 /**
@@ -327,6 +404,88 @@ typedef OFData *_Nullable (^OFDatagramSocketDataSentHandler)(
 		       handler: (OFDatagramSocketPacketReceivedHandler)handler;
 #endif
 
+/**
+ * @brief Receives up to the specified number of datagrams at once.
+ *
+ * Where supported, this receives all datagrams with a single system call.
+ *
+ * If the socket can block, this blocks until at least one datagram has been
+ * received, but does not wait for further datagrams once one has been
+ * received.
+ *
+ * The `length` of each packet needs to be set to the length of its buffer and
+ * is updated to the length of the received datagram. If the buffer is too
+ * small, the datagram is truncated.
+ *
+ * @param packets The packets to receive the datagrams into
+ * @param count The maximum number of datagrams to receive
+ * @return The number of datagrams that have been received
+ * @throw OFReadFailedException Receiving failed
+ * @throw OFNotOpenException The socket is not open
+ */
+- (size_t)receivePackets: (OFDatagramSocketPacket *)packets
+		   count: (size_t)count;
+
+/**
+ * @brief Asynchronously receives up to the specified number of datagrams at
+ *	  once.
+ *
+ * @param packets The packets to receive the datagrams into. Their lengths are
+ *		  remembered and restored before every receive.
+ * @param count The maximum number of datagrams to receive
+ */
+- (void)asyncReceivePackets: (OFDatagramSocketPacket *)packets
+		      count: (size_t)count;
+
+/**
+ * @brief Asynchronously receives up to the specified number of datagrams at
+ *	  once.
+ *
+ * @param packets The packets to receive the datagrams into. Their lengths are
+ *		  remembered and restored before every receive.
+ * @param count The maximum number of datagrams to receive
+ * @param runLoopMode The run loop mode in which to perform the asynchronous
+ *		      receive
+ */
+- (void)asyncReceivePackets: (OFDatagramSocketPacket *)packets
+		      count: (size_t)count
+		runLoopMode: (OFRunLoopMode)runLoopMode;
+
+#ifdef OF_HAVE_BLOCKS
+/**
+ * @brief Asynchronously receives up to the specified number of datagrams at
+ *	  once.
+ *
+ * @param packets The packets to receive the datagrams into. Their lengths are
+ *		  remembered and restored before every receive.
+ * @param count The maximum number of datagrams to receive
+ * @param handler The handler to call when datagrams have been received. If
+ *		  the handler returns true, it will be called again with the
+ *		  same packets when more datagrams have been received.
+ */
+- (void)asyncReceivePackets: (OFDatagramSocketPacket *)packets
+		      count: (size_t)count
+		    handler: (OFDatagramSocketPacketsReceivedHandler)handler;
+
+/**
+ * @brief Asynchronously receives up to the specified number of datagrams at
+ *	  once.
+ *
+ * @param packets The packets to receive the datagrams into. Their lengths are
+ *		  remembered and restored before every receive.
+ * @param count The maximum number of datagrams to receive
+ * @param runLoopMode The run loop mode in which to perform the asynchronous
+ *		      receive
+ * @param handler The handler to call when datagrams have been received. If
+ *		  the handler returns true, it will be called again with the
+ *		  same packets when more datagrams have been received.
+ */
+- (void)asyncReceivePackets: (OFDatagramSocketPacket *)packets
+		      count: (size_t)count
+		runLoopMode: (OFRunLoopMode)runLoopMode
+		    handler: (OFDatagramSocketPacketsReceivedHandler)handler;
+#endif
+
 /**
  * @brief Sends the specified datagram to the specified address.
  *
@@ -341,6 +500,89 @@ typedef OFData *_Nullable (^OFDatagramSocketDataSentHandler)(
 	    length: (size_t)length
 	  receiver: (const OFSocketAddress *)receiver;
 
+/**
+ * @brief Sends the specified datagrams, each to the address of its packet.
+ *
+ * Where supported, this sends all datagrams with a single system call.
+ *
+ * @param packets The packets to send
+ * @param count The number of packets to send
+ * @throw OFWriteFailedException Sending failed
+ * @throw OFNotOpenException The socket is not open
+ */
+- (void)sendPackets: (const OFDatagramSocketPacket *)packets
+	      count: (size_t)count;
+
+/**
+ * @brief Asynchronously sends the specified datagrams, each to the address of
+ *	  its packet.
+ *
+ * Where supported, the datagrams are sent with as few system calls as
+ * possible.
+ *
+ * @param packets The packets to send. They are not copied and need to stay
+ *		  valid until the send has finished.
+ * @param count The number of packets to send
+ */
+- (void)asyncSendPackets: (const OFDatagramSocketPacket *)packets
+		   count: (size_t)count;
+
+/**
+ * @brief Asynchronously sends the specified datagrams, each to the address of
+ *	  its packet.
+ *
+ * Where supported, the datagrams are sent with as few system calls as
+ * possible.
+ *
+ * @param packets The packets to send. They are not copied and need to stay
+ *		  valid until the send has finished.
+ * @param count The number of packets to send
+ * @param runLoopMode The run loop mode in which to perform the asynchronous
+ *		      send
+ */
+- (void)asyncSendPackets: (const OFDatagramSocketPacket *)packets
+		   count: (size_t)count
+	     runLoopMode: (OFRunLoopMode)runLoopMode;
+
+#ifdef OF_HAVE_BLOCKS
+/**
+ * @brief Asynchronously sends the specified datagrams, each to the address of
+ *	  its packet.
+ *
+ * Where supported, the datagrams are sent with as few system calls as
+ * possible.
+ *
+ * @param packets The packets to send. They are not copied and need to stay
+ *		  valid until the send has finished.
+ * @param count The number of packets to send
+ * @param handler The handler to call when the packets have been sent. If the
+ *		  handler returns true, the same packets are sent again.
+ */
+- (void)asyncSendPackets: (const OFDatagramSocketPacket *)packets
+		   count: (size_t)count
+		 handler: (OFDatagramSocketPacketsSentHandler)handler;
+
+/**
+ * @brief Asynchronously sends the specified datagrams, each to the address of
+ *	  its packet.
+ *
+ * Where supported, the datagrams are sent with as few system calls as
+ * possible.
+ *
+ * @param packets The packets to send. They are not copied and need to stay
+ *		  valid until the send has finished.
+ * @param count The number of packets to send
+ * @param runLoopMode The run loop mode in which to perform the asynchronous
+ *		      send
+ * @param handler The handler to call when the packets have been sent. If the
+ *		  handler returns true, the same packets are sent again.
+ */
+- (void)asyncSendPackets: (const OFDatagramSocketPacket *)packets
+		   count: (size_t)count
+	     runLoopMode: (OFRunLoopMode)runLoopMode
+		 handler: (OFDatagramSocketPacketsSentHandler)handler;
+#endif
+
 /**
  * @brief Asynchronously sends the specified datagram to the specified address.
  *
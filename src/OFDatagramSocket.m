@@ -31,6 +31,7 @@
 #endif
 
 #import "OFDatagramSocket.h"
+#import "OFDatagramSocket+Private.h"
 #import "OFData.h"
 #import "OFRunLoop.h"
 #import "OFRunLoop+Private.h"
@@ -52,6 +53,49 @@
 # define UNIQUE_ID -1
 #endif
 
+#if defined(HAVE_RECVMMSG) || defined(HAVE_SENDMMSG)
+/* The number of datagrams to pass to a single recvmmsg() / sendmmsg(). */
+# define maxBatchSize 64
+#endif
+
+static void
+setSocketAddressFamily(OFSocketAddress *address)
+{
+	struct sockaddr *sa = (struct sockaddr *)&address->sockaddr;
+
+	if (address->length >= (socklen_t)sizeof(sa->sa_family)) {
+		switch (sa->sa_family) {
+		case AF_INET:
+			address->family = OFSocketAddressFamilyIPv4;
+			break;
+#ifdef OF_HAVE_IPV6
+		case AF_INET6:
+			address->family = OFSocketAddressFamilyIPv6;
+			break;
+#endif
+#ifdef OF_HAVE_UNIX_SOCKETS
+		case AF_UNIX:
+			address->family = OFSocketAddressFamilyUNIX;
+			break;
+#endif
+#ifdef OF_HAVE_IPX
+		case AF_IPX:
+			address->family = OFSocketAddressFamilyIPX;
+			break;
+#endif
+#ifdef OF_HAVE_APPLETALK
+		case AF_APPLETALK:
+			address->family = OFSocketAddressFamilyAppleTalk;
+			break;
+#endif
+		default:
+			address->family = OFSocketAddressFamilyUnknown;
+			break;
+		}
+	} else
+		address->family = OFSocketAddressFamilyUnknown;
+}
+
 @implementation OFDatagramSocket
 @synthesize delegate = _delegate;
 
@@ -210,41 +254,8 @@ retry:
 				  errNo: _OFSocketErrNo()];
 #endif
 
-	if (sender != NULL) {
-		struct sockaddr *sa = (struct sockaddr *)&sender->sockaddr;
-
-		if (sender->length >= (socklen_t)sizeof(sa->sa_family)) {
-			switch (sa->sa_family) {
-			case AF_INET:
-				sender->family = OFSocketAddressFamilyIPv4;
-				break;
-#ifdef OF_HAVE_IPV6
-			case AF_INET6:
-				sender->family = OFSocketAddressFamilyIPv6;
-				break;
-#endif
-#ifdef OF_HAVE_UNIX_SOCKETS
-			case AF_UNIX:
-				sender->family = OFSocketAddressFamilyUNIX;
-				break;
-#endif
-#ifdef OF_HAVE_IPX
-			case AF_IPX:
-				sender->family = OFSocketAddressFamilyIPX;
-				break;
-#endif
-#ifdef OF_HAVE_APPLETALK
-			case AF_APPLETALK:
-				sender->family = OFSocketAddressFamilyAppleTalk;
-				break;
-#endif
-			default:
-				sender->family = OFSocketAddressFamilyUnknown;
-				break;
-			}
-		} else
-			sender->family = OFSocketAddressFamilyUnknown;
-	}
+	if (sender != NULL)
+		setSocketAddressFamily(sender);
 
 	return ret;
 }
@@ -328,6 +339,119 @@ retry:
 }
 #endif
 
+- (size_t)receivePackets: (OFDatagramSocketPacket *)packets
+		   count: (size_t)count
+{
+#ifdef HAVE_RECVMMSG
+	struct mmsghdr messages[maxBatchSize];
+	struct iovec iov[maxBatchSize];
+	int ret;
+
+	if (_socket == OFInvalidSocketHandle)
+		@throw [OFNotOpenException exceptionWithObject: self];
+
+	if (count == 0)
+		return 0;
+
+	if (count > maxBatchSize)
+		count = maxBatchSize;
+
+	memset(messages, 0, count * sizeof(*messages));
+
+	for (size_t i = 0; i < count; i++) {
+		iov[i].iov_base = packets[i].buffer;
+		iov[i].iov_len = packets[i].length;
+		messages[i].msg_hdr.msg_iov = &iov[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+		messages[i].msg_hdr.msg_name =
+		    (struct sockaddr *)&packets[i].address.sockaddr;
+		messages[i].msg_hdr.msg_namelen =
+		    (socklen_t)sizeof(packets[i].address.sockaddr);
+	}
+
+	/*
+	 * MSG_WAITFORONE makes recvmmsg() block only until the first datagram
+	 * has been received, just like receiveIntoBuffer:length:sender:.
+	 */
+	while ((ret = recvmmsg(_socket, messages, (unsigned int)count,
+	    MSG_WAITFORONE, NULL)) < 0) {
+		int errNo = _OFSocketErrNo();
+
+		if (errNo == EINTR)
+			continue;
+
+		@throw [OFReadFailedException
+		    exceptionWithObject: self
+			requestedLength: packets[0].length
+				  errNo: errNo];
+	}
+
+	for (int i = 0; i < ret; i++) {
+		packets[i].length = messages[i].msg_len;
+		packets[i].address.length = messages[i].msg_hdr.msg_namelen;
+		setSocketAddressFamily(&packets[i].address);
+	}
+
+	return ret;
+#else
+	if (count == 0)
+		return 0;
+
+	packets[0].length = [self receiveIntoBuffer: packets[0].buffer
+					     length: packets[0].length
+					     sender: &packets[0].address];
+
+	return 1;
+#endif
+}
+
+- (void)asyncReceivePackets: (OFDatagramSocketPacket *)packets
+		      count: (size_t)count
+{
+	[self asyncReceivePackets: packets
+			    count: count
+		      runLoopMode: OFDefaultRunLoopMode];
+}
+
+- (void)asyncReceivePackets: (OFDatagramSocketPacket *)packets
+		      count: (size_t)count
+		runLoopMode: (OFRunLoopMode)runLoopMode
+{
+	[OFRunLoop of_addAsyncReceiveForDatagramSocket: self
+					       packets: packets
+						 count: count
+						  mode: runLoopMode
+# ifdef OF_HAVE_BLOCKS
+					       handler: NULL
+# endif
+					      delegate: _delegate];
+}
+
+#ifdef OF_HAVE_BLOCKS
+- (void)asyncReceivePackets: (OFDatagramSocketPacket *)packets
+		      count: (size_t)count
+		    handler: (OFDatagramSocketPacketsReceivedHandler)handler
+{
+	[self asyncReceivePackets: packets
+			    count: count
+		      runLoopMode: OFDefaultRunLoopMode
+			  handler: handler];
+}
+
+- (void)asyncReceivePackets: (OFDatagramSocketPacket *)packets
+		      count: (size_t)count
+		runLoopMode: (OFRunLoopMode)runLoopMode
+		    handler: (OFDatagramSocketPacketsReceivedHandler)handler
+{
+	[OFRunLoop of_addAsyncReceiveForDatagramSocket: self
+					       packets: packets
+						 count: count
+						  mode: runLoopMode
+					       handler: handler
+					      delegate: nil];
+}
+#endif
+
 - (void)sendBuffer: (const void *)buffer
 	    length: (size_t)length
 	  receiver: (const OFSocketAddress *)receiver
@@ -376,6 +500,136 @@ retry:
 							     errNo: 0];
 }
 
+- (size_t)of_sendPackets: (const OFDatagramSocketPacket *)packets
+		   count: (size_t)count
+{
+#ifdef HAVE_SENDMMSG
+	struct mmsghdr messages[maxBatchSize];
+	struct iovec iov[maxBatchSize];
+	int ret;
+
+	if (_socket == OFInvalidSocketHandle)
+		@throw [OFNotOpenException exceptionWithObject: self];
+
+	if (count == 0)
+		return 0;
+
+	if (count > maxBatchSize)
+		count = maxBatchSize;
+
+	memset(messages, 0, count * sizeof(*messages));
+
+	for (size_t i = 0; i < count; i++) {
+		if (packets[i].length > SSIZE_MAX)
+			@throw [OFOutOfRangeException exception];
+
+		iov[i].iov_base = packets[i].buffer;
+		iov[i].iov_len = packets[i].length;
+		messages[i].msg_hdr.msg_iov = &iov[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+		messages[i].msg_hdr.msg_name =
+		    (struct sockaddr *)&packets[i].address.sockaddr;
+		messages[i].msg_hdr.msg_namelen = packets[i].address.length;
+	}
+
+	/*
+	 * sendmmsg() only returns an error if the first datagram could not be
+	 * sent. Otherwise, the error is returned by the next call, which
+	 * starts with the datagram that failed.
+	 */
+	while ((ret = sendmmsg(_socket, messages, (unsigned int)count,
+	    0)) < 0) {
+		int errNo = _OFSocketErrNo();
+
+		if (errNo == EINTR)
+			continue;
+
+		@throw [OFWriteFailedException
+		    exceptionWithObject: self
+			requestedLength: packets[0].length
+			   bytesWritten: 0
+				  errNo: errNo];
+	}
+
+	for (int i = 0; i < ret; i++)
+		if (messages[i].msg_len != packets[i].length)
+			@throw [OFWriteFailedException
+			    exceptionWithObject: self
+				requestedLength: packets[i].length
+				   bytesWritten: messages[i].msg_len
+					  errNo: 0];
+
+	return ret;
+#else
+	if (count == 0)
+		return 0;
+
+	[self sendBuffer: packets[0].buffer
+		  length: packets[0].length
+		receiver: &packets[0].address];
+
+	return 1;
+#endif
+}
+
+- (void)sendPackets: (const OFDatagramSocketPacket *)packets
+	      count: (size_t)count
+{
+	while (count > 0) {
+		size_t sent = [self of_sendPackets: packets count: count];
+
+		packets += sent;
+		count -= sent;
+	}
+}
+
+- (void)asyncSendPackets: (const OFDatagramSocketPacket *)packets
+		   count: (size_t)count
+{
+	[self asyncSendPackets: packets
+			 count: count
+		   runLoopMode: OFDefaultRunLoopMode];
+}
+
+- (void)asyncSendPackets: (const OFDatagramSocketPacket *)packets
+		   count: (size_t)count
+	     runLoopMode: (OFRunLoopMode)runLoopMode
+{
+	[OFRunLoop of_addAsyncSendForDatagramSocket: self
+					    packets: packets
+					      count: count
+					       mode: runLoopMode
+# ifdef OF_HAVE_BLOCKS
+					    handler: NULL
+# endif
+					   delegate: _delegate];
+}
+
+#ifdef OF_HAVE_BLOCKS
+- (void)asyncSendPackets: (const OFDatagramSocketPacket *)packets
+		   count: (size_t)count
+		 handler: (OFDatagramSocketPacketsSentHandler)handler
+{
+	[self asyncSendPackets: packets
+			 count: count
+		   runLoopMode: OFDefaultRunLoopMode
+		       handler: handler];
+}
+
+- (void)asyncSendPackets: (const OFDatagramSocketPacket *)packets
+		   count: (size_t)count
+	     runLoopMode: (OFRunLoopMode)runLoopMode
+		 handler: (OFDatagramSocketPacketsSentHandler)handler
+{
+	[OFRunLoop of_addAsyncSendForDatagramSocket: self
+					    packets: packets
+					      count: count
+					       mode: runLoopMode
+					    handler: handler
+					   delegate: nil];
+}
+#endif
+
 - (void)asyncSendData: (OFData *)data
 	     receiver: (const OFSocketAddress *)receiver
 {
@@ -28,13 +28,15 @@
 #import "OFData.h"
 #import "OFEnumerator.h"
 #import "OFJSONRepresentationPrivate.h"
+#import "OFMessagePackRepresentationPrivate.h"
 #import "OFString.h"
 
 #import "OFInvalidArgumentException.h"
 #import "OFOutOfRangeException.h"
 #import "OFUndefinedKeyException.h"
 
-@interface OFDictionary () <OFJSONRepresentationPrivate>
+@interface OFDictionary () <OFJSONRepresentationPrivate,
+    OFMessagePackRepresentationPrivate>
 @end
 
 @interface OFPlaceholderDictionary: OFDictionary
@@ -678,54 +680,58 @@ OF_SINGLETON_METHODS
 
 - (OFString *)JSONRepresentation
 {
-	return [self of_JSONRepresentationWithOptions: 0 depth: 0];
+	return [self JSONRepresentationWithOptions: 0];
 }
 
 - (OFString *)JSONRepresentationWithOptions:
     (OFJSONRepresentationOptions)options
 {
-	return [self of_JSONRepresentationWithOptions: options depth: 0];
+	OFMutableString *JSON = [OFMutableString string];
+
+	[self of_appendJSONRepresentationToString: JSON
+					  options: options
+					    depth: 0];
+	[JSON makeImmutable];
+
+	return JSON;
 }
 
-- (OFString *)
-    of_JSONRepresentationWithOptions: (OFJSONRepresentationOptions)options
-			       depth: (size_t)depth
+- (void)
+    of_appendJSONRepresentationToString: (OFMutableString *)JSON
+				options: (OFJSONRepresentationOptions)options
+				  depth: (size_t)depth
 {
-	OFMutableString *JSON = [OFMutableString stringWithString: @"{"];
 	void *pool = objc_autoreleasePoolPush();
 	OFArray *keys = self.allKeys;
 	size_t i, count = self.count;
+	int keyOptions = options | OFJSONRepresentationOptionIsIdentifier;
 
 	if (options & OFJSONRepresentationOptionSorted)
 		keys = keys.sortedArray;
 
-	if (options & OFJSONRepresentationOptionPretty) {
-		OFMutableString *indentation = [OFMutableString string];
-
-		for (i = 0; i < depth; i++)
-			[indentation appendString: @"\t"];
+	[JSON appendString: @"{"];
 
+	if (options & OFJSONRepresentationOptionPretty) {
 		[JSON appendString: @"\n"];
 
 		i = 0;
 		for (id key in keys) {
 			void *pool2 = objc_autoreleasePoolPush();
 			id object = [self objectForKey: key];
-			int identifierOptions =
-			    options | OFJSONRepresentationOptionIsIdentifier;
 
 			if (![key isKindOfClass: [OFString class]])
 				@throw [OFInvalidArgumentException exception];
 
-			[JSON appendString: indentation];
-			[JSON appendString: @"\t"];
-			[JSON appendString: [key
-			    of_JSONRepresentationWithOptions: identifierOptions
-						       depth: depth + 1]];
+			for (size_t j = 0; j <= depth; j++)
+				[JSON appendString: @"\t"];
+
+			[key of_appendJSONRepresentationToString: JSON
+							 options: keyOptions
+							   depth: depth + 1];
 			[JSON appendString: @": "];
-			[JSON appendString: [object
-			    of_JSONRepresentationWithOptions: options
-						       depth: depth + 1]];
+			[object of_appendJSONRepresentationToString: JSON
+							    options: options
+							      depth: depth + 1];
 
 			if (++i < count)
 				[JSON appendString: @",\n"];
@@ -735,25 +741,24 @@ OF_SINGLETON_METHODS
 			objc_autoreleasePoolPop(pool2);
 		}
 
-		[JSON appendString: indentation];
+		for (i = 0; i < depth; i++)
+			[JSON appendString: @"\t"];
 	} else {
 		i = 0;
 		for (id key in keys) {
 			void *pool2 = objc_autoreleasePoolPush();
 			id object = [self objectForKey: key];
-			int identifierOptions =
-			    options | OFJSONRepresentationOptionIsIdentifier;
 
 			if (![key isKindOfClass: [OFString class]])
 				@throw [OFInvalidArgumentException exception];
 
-			[JSON appendString: [key
-			    of_JSONRepresentationWithOptions: identifierOptions
-						       depth: depth + 1]];
+			[key of_appendJSONRepresentationToString: JSON
+							 options: keyOptions
+							   depth: depth + 1];
 			[JSON appendString: @":"];
-			[JSON appendString: [object
-			    of_JSONRepresentationWithOptions: options
-						       depth: depth + 1]];
+			[object of_appendJSONRepresentationToString: JSON
+							    options: options
+							      depth: depth + 1];
 
 			if (++i < count)
 				[JSON appendString: @","];
@@ -763,23 +768,26 @@ OF_SINGLETON_METHODS
 	}
 
 	[JSON appendString: @"}"];
-	[JSON makeImmutable];
 
 	objc_autoreleasePoolPop(pool);
-
-	return JSON;
 }
 
 - (OFData *)messagePackRepresentation
 {
-	OFMutableData *data;
-	size_t i, count;
+	OFMutableData *data = [OFMutableData data];
+
+	[self of_appendMessagePackRepresentationToData: data];
+	[data makeImmutable];
+
+	return data;
+}
+
+- (void)of_appendMessagePackRepresentationToData: (OFMutableData *)data
+{
+	size_t i, count = self.count;
 	void *pool;
 	OFEnumerator *keyEnumerator, *objectEnumerator;
-	id <OFMessagePackRepresentation> key, object;
-
-	data = [OFMutableData data];
-	count = self.count;
+	id key, object;
 
 	if (count <= 15) {
 		uint8_t tmp = 0x80 | ((uint8_t)count & 0xF);
@@ -807,26 +815,17 @@ OF_SINGLETON_METHODS
 	while ((key = [keyEnumerator nextObject]) != nil &&
 	    (object = [objectEnumerator nextObject]) != nil) {
 		void *pool2 = objc_autoreleasePoolPush();
-		OFData *child;
 
 		i++;
-
-		child = key.messagePackRepresentation;
-		[data addItems: child.items count: child.count];
-
-		child = object.messagePackRepresentation;
-		[data addItems: child.items count: child.count];
+		_OFAppendMessagePackRepresentation(data, key);
+		_OFAppendMessagePackRepresentation(data, object);
 
 		objc_autoreleasePoolPop(pool2);
 	}
 
 	OFAssert(i == count);
 
-	[data makeImmutable];
-
 	objc_autoreleasePoolPop(pool);
-
-	return data;
 }
 @end
 
@@ -87,6 +87,8 @@ OF_SUBCLASSING_RESTRICTED
 	OFDate *_Nullable _modificationDate;
 	uint16_t _extraLength;
 	uint32_t _CRC32, _uncompressedSize;
+	size_t _numberOfThreads;
+	struct _OFGZIPStreamBGZF *_Nullable _BGZF;
 }
 
 /**
@@ -106,6 +108,23 @@ OF_SUBCLASSING_RESTRICTED
  */
 @property OF_NULLABLE_PROPERTY (readonly, nonatomic) OFDate *modificationDate;
 
+/**
+ * @brief The number of threads to use for decompression.
+ *
+ * If this is larger than 1 and the data consists of BGZF blocks (GZIP members
+ * that store the size of the member in an extra field, as written by bgzip),
+ * several blocks are decompressed in parallel. Other GZIP data is always
+ * decompressed by the calling thread.
+ *
+ * At most as many threads as there are CPUs are used, and never more than 16.
+ *
+ * Decompressing in parallel requires the underlying stream to be in blocking
+ * mode.
+ *
+ * The default is 1.
+ */
+@property (nonatomic) size_t numberOfThreads;
+
 /**
  * @brief Creates a new OFGZIPStream with the specified underlying stream.
  *
@@ -23,6 +23,11 @@
 #import "OFCRC32.h"
 #import "OFDate.h"
 #import "OFInflateStream.h"
+#ifdef OF_HAVE_THREADS
+# import "OFMemoryStream.h"
+# import "OFPlainThread.h"
+# import "OFSystemInfo.h"
+#endif
 
 #import "OFChecksumMismatchException.h"
 #import "OFInvalidFormatException.h"
@@ -30,9 +35,365 @@
 #import "OFNotOpenException.h"
 #import "OFTruncatedDataException.h"
 
+#ifdef OF_HAVE_THREADS
+/* BGZF limits both the compressed and the uncompressed size of a block. */
+static const size_t BGZFMaxBlockSize = 65536;
+static const size_t BGZFMaxExtraLength = 256;
+static const size_t BGZFBlocksPerThread = 4;
+static const size_t BGZFMaxThreads = 16;
+
+struct _OFGZIPStreamBGZF {
+	unsigned char *input, *output;
+	size_t numberOfThreads, maxBlocks, outputLength, outputPosition;
+};
+
+struct BGZFBlock {
+	unsigned char *input, *output;
+	size_t inputLength, outputLength;
+	uint32_t CRC32;
+	id exception;
+};
+
+struct BGZFThread {
+	struct BGZFBlock *blocks;
+	size_t count, firstBlock, blockStep;
+};
+#endif
+
 @implementation OFGZIPStream
 @synthesize operatingSystemMadeOn = _operatingSystemMadeOn;
 @synthesize modificationDate = _modificationDate;
+@synthesize numberOfThreads = _numberOfThreads;
+
+#ifdef OF_HAVE_THREADS
+static void
+inflateBGZFBlock(struct BGZFBlock *block)
+{
+	void *pool = objc_autoreleasePoolPush();
+
+	@try {
+		OFMemoryStream *stream = [OFMemoryStream
+		    streamWithMemoryAddress: block->input
+				       size: block->inputLength
+				   writable: false];
+		OFInflateStream *inflateStream =
+		    [OFInflateStream streamWithStream: stream];
+		size_t length = 0;
+		uint32_t CRC32;
+
+		/*
+		 * Read one byte more than expected to detect blocks that are
+		 * larger than their trailer claims.
+		 */
+		while (length <= block->outputLength) {
+			unsigned char tmp;
+			size_t bytesRead;
+
+			if (length < block->outputLength)
+				bytesRead = [inflateStream
+				    readIntoBuffer: block->output + length
+					    length: block->outputLength -
+						    length];
+			else
+				bytesRead = [inflateStream readIntoBuffer: &tmp
+								   length: 1];
+
+			length += bytesRead;
+
+			if (inflateStream.atEndOfStream)
+				break;
+
+			/* All input is in memory, so no progress means EOF. */
+			if (bytesRead == 0)
+				@throw [OFTruncatedDataException exception];
+		}
+
+		if (length != block->outputLength) {
+			OFString *actual = [OFString stringWithFormat:
+			    @"%zu", length];
+			OFString *expected = [OFString stringWithFormat:
+			    @"%zu", block->outputLength];
+
+			@throw [OFChecksumMismatchException
+			    exceptionWithActualChecksum: actual
+				       expectedChecksum: expected];
+		}
+
+		CRC32 = ~_OFCRC32(~0, block->output, length);
+		if (CRC32 != block->CRC32) {
+			OFString *actual = [OFString stringWithFormat:
+			    @"%08" PRIX32, CRC32];
+			OFString *expected = [OFString stringWithFormat:
+			    @"%08" PRIX32, block->CRC32];
+
+			@throw [OFChecksumMismatchException
+			    exceptionWithActualChecksum: actual
+				       expectedChecksum: expected];
+		}
+	} @catch (id e) {
+		block->exception = [e retain];
+	}
+
+	objc_autoreleasePoolPop(pool);
+}
+
+static void
+inflateBGZFBlocksOfThread(struct BGZFThread *thread)
+{
+	for (size_t i = thread->firstBlock; i < thread->count;
+	    i += thread->blockStep)
+		inflateBGZFBlock(&thread->blocks[i]);
+}
+
+static void
+BGZFThreadMain(id object)
+{
+	inflateBGZFBlocksOfThread((struct BGZFThread *)(void *)object);
+}
+
+static size_t
+readUpTo(OFStream *stream, unsigned char *buffer, size_t length)
+{
+	size_t bytesRead = 0;
+
+	while (bytesRead < length) {
+		size_t tmp = [stream readIntoBuffer: buffer + bytesRead
+					     length: length - bytesRead];
+
+		if (tmp == 0)
+			break;
+
+		bytesRead += tmp;
+	}
+
+	return bytesRead;
+}
+
+/*
+ * Reads the header of a BGZF block. If the next member is not a BGZF block,
+ * everything that was read is unread again and 0 is returned. Otherwise, the
+ * number of bytes of the block following the header is returned.
+ */
+static size_t
+readBGZFHeader(OFGZIPStream *self, uint32_t *modificationDate,
+    uint8_t *operatingSystem)
+{
+	unsigned char header[12 + BGZFMaxExtraLength];
+	size_t headerLength, extraLength, blockSize = 0;
+
+	headerLength = readUpTo(self->_stream, header, 12);
+	if (headerLength < 12 || header[0] != 0x1F || header[1] != 0x8B ||
+	    header[2] != 8 || header[3] != OFGZIPStreamFlagExtra)
+		goto notBGZF;
+
+	extraLength = header[10] | (header[11] << 8);
+	if (extraLength < 6 || extraLength > BGZFMaxExtraLength)
+		goto notBGZF;
+
+	headerLength += readUpTo(self->_stream, header + 12, extraLength);
+	if (headerLength < 12 + extraLength)
+		goto notBGZF;
+
+	for (size_t i = 12; i + 4 <= headerLength;) {
+		size_t subfieldLength = header[i + 2] | (header[i + 3] << 8);
+
+		if (header[i] == 'B' && header[i + 1] == 'C' &&
+		    subfieldLength == 2 && i + 6 <= headerLength) {
+			blockSize = (header[i + 4] | (header[i + 5] << 8)) + 1;
+			break;
+		}
+
+		i += 4 + subfieldLength;
+	}
+
+	if (blockSize == 0)
+		goto notBGZF;
+
+	/* The block needs at least the empty deflate block and the trailer. */
+	if (blockSize < headerLength + 2 + 8)
+		@throw [OFInvalidFormatException exception];
+
+	*modificationDate = ((uint32_t)header[7] << 24) | (header[6] << 16) |
+	    (header[5] << 8) | header[4];
+	*operatingSystem = header[9];
+
+	return blockSize - headerLength;
+
+notBGZF:
+	if (headerLength > 0)
+		[self->_stream unreadFromBuffer: header length: headerLength];
+
+	return 0;
+}
+
+static struct _OFGZIPStreamBGZF *
+allocBGZF(OFGZIPStream *self)
+{
+	size_t numberOfThreads = self->_numberOfThreads;
+	size_t numberOfCPUs = [OFSystemInfo numberOfCPUs];
+	size_t maxBlocks;
+	struct _OFGZIPStreamBGZF *BGZF;
+
+	if (numberOfCPUs > 0 && numberOfThreads > numberOfCPUs)
+		numberOfThreads = numberOfCPUs;
+	if (numberOfThreads > BGZFMaxThreads)
+		numberOfThreads = BGZFMaxThreads;
+
+	maxBlocks = numberOfThreads * BGZFBlocksPerThread;
+
+	BGZF = OFAllocZeroedMemory(1, sizeof(*BGZF));
+	@try {
+		BGZF->input = OFAllocMemory(maxBlocks, BGZFMaxBlockSize);
+		BGZF->output = OFAllocMemory(maxBlocks, BGZFMaxBlockSize);
+	} @catch (id e) {
+		OFFreeMemory(BGZF->input);
+		OFFreeMemory(BGZF);
+		@throw e;
+	}
+	BGZF->numberOfThreads = numberOfThreads;
+	BGZF->maxBlocks = maxBlocks;
+	self->_BGZF = BGZF;
+
+	return BGZF;
+}
+
+/*
+ * Reads as many BGZF blocks as there are threads to keep busy and inflates
+ * them in parallel. Returns false if the next member is not a BGZF block.
+ *
+ * The threads are created for every batch and joined again, rather than being
+ * kept around between batches. Creating a thread takes in the order of tens of
+ * microseconds, while every thread inflates up to BGZFBlocksPerThread blocks
+ * of up to 64 KiB per batch, which takes orders of magnitude longer. Keeping
+ * the threads would save little, but would require synchronizing with them
+ * for every batch and stopping them when the stream is closed.
+ */
+static bool
+inflateBGZFBlocks(OFGZIPStream *self)
+{
+	struct _OFGZIPStreamBGZF *BGZF = self->_BGZF;
+	size_t count = 0, inputLength = 0, threadsCount, length;
+	uint32_t modificationDate = 0;
+	uint8_t operatingSystem = 0;
+
+	/* Only allocate the buffers once the data turned out to be BGZF. */
+	if ((length = readBGZFHeader(self, &modificationDate,
+	    &operatingSystem)) == 0)
+		return false;
+
+	if (BGZF == NULL)
+		BGZF = allocBGZF(self);
+
+	{
+		struct BGZFBlock blocks[BGZF->maxBlocks];
+
+		for (;;) {
+			struct BGZFBlock *block = &blocks[count];
+			const unsigned char *trailer;
+
+			block->input = BGZF->input + inputLength;
+			block->inputLength = length - 8;
+			block->exception = nil;
+
+			[self->_stream readIntoBuffer: block->input
+					  exactLength: length];
+			inputLength += length;
+
+			trailer = block->input + block->inputLength;
+			block->CRC32 = ((uint32_t)trailer[3] << 24) |
+			    (trailer[2] << 16) | (trailer[1] << 8) | trailer[0];
+			block->outputLength = ((size_t)trailer[7] << 24) |
+			    (trailer[6] << 16) | (trailer[5] << 8) | trailer[4];
+
+			if (block->outputLength > BGZFMaxBlockSize)
+				@throw [OFInvalidFormatException exception];
+
+			if (++count == BGZF->maxBlocks)
+				break;
+
+			if ((length = readBGZFHeader(self, &modificationDate,
+			    &operatingSystem)) == 0)
+				break;
+		}
+
+		BGZF->outputLength = 0;
+		for (size_t i = 0; i < count; i++) {
+			blocks[i].output = BGZF->output + BGZF->outputLength;
+			BGZF->outputLength += blocks[i].outputLength;
+		}
+		BGZF->outputPosition = 0;
+
+		threadsCount = BGZF->numberOfThreads;
+		if (threadsCount > count)
+			threadsCount = count;
+
+		{
+			struct BGZFThread threads[threadsCount];
+			OFPlainThread plainThreads[threadsCount];
+			bool started[threadsCount];
+			OFPlainThreadAttributes attr;
+			bool haveAttr =
+			    (OFPlainThreadAttributesInit(&attr) == 0);
+			id exception = nil;
+
+			for (size_t i = 0; i < threadsCount; i++) {
+				threads[i].blocks = blocks;
+				threads[i].count = count;
+				threads[i].firstBlock = i;
+				threads[i].blockStep = threadsCount;
+
+				started[i] = (i > 0 && haveAttr &&
+				    OFPlainThreadNew(&plainThreads[i],
+				    "OFGZIPStream", BGZFThreadMain,
+				    (id)(void *)&threads[i], &attr) == 0);
+			}
+
+			inflateBGZFBlocksOfThread(&threads[0]);
+
+			for (size_t i = 1; i < threadsCount; i++) {
+				if (started[i])
+					OFPlainThreadJoin(plainThreads[i]);
+				else
+					inflateBGZFBlocksOfThread(&threads[i]);
+			}
+
+			for (size_t i = 0; i < count; i++) {
+				if (exception == nil)
+					exception = blocks[i].exception;
+				else
+					[blocks[i].exception release];
+			}
+
+			if (exception != nil) {
+				BGZF->outputLength = 0;
+				@throw [exception autorelease];
+			}
+		}
+	}
+
+	[self->_modificationDate release];
+	self->_modificationDate = nil;
+	self->_modificationDate = [[OFDate alloc]
+	    initWithTimeIntervalSince1970: modificationDate];
+	self->_operatingSystemMadeOn = operatingSystem;
+
+	return true;
+}
+
+static size_t
+readBGZFOutput(OFGZIPStream *self, void *buffer, size_t length)
+{
+	struct _OFGZIPStreamBGZF *BGZF = self->_BGZF;
+
+	if (length > BGZF->outputLength - BGZF->outputPosition)
+		length = BGZF->outputLength - BGZF->outputPosition;
+
+	memcpy(buffer, BGZF->output + BGZF->outputPosition, length);
+	BGZF->outputPosition += length;
+
+	return length;
+}
+#endif
 
 + (instancetype)streamWithStream: (OFStream *)stream mode: (OFString *)mode
 {
@@ -57,6 +418,7 @@
 		_stream = [stream retain];
 		_operatingSystemMadeOn = OFGZIPStreamOperatingSystemUnknown;
 		_CRC32 = ~0;
+		_numberOfThreads = 1;
 	} @catch (id e) {
 		[self release];
 		@throw e;
@@ -73,6 +435,14 @@
 	[_inflateStream release];
 	[_modificationDate release];
 
+#ifdef OF_HAVE_THREADS
+	if (_BGZF != NULL) {
+		OFFreeMemory(_BGZF->input);
+		OFFreeMemory(_BGZF->output);
+		OFFreeMemory(_BGZF);
+	}
+#endif
+
 	[super dealloc];
 }
 
@@ -81,6 +451,11 @@
 	if (_stream == nil)
 		@throw [OFNotOpenException exceptionWithObject: self];
 
+#ifdef OF_HAVE_THREADS
+	if (_BGZF != NULL && _BGZF->outputPosition < _BGZF->outputLength)
+		return readBGZFOutput(self, buffer, length);
+#endif
+
 	for (;;) {
 		uint8_t byte;
 		uint32_t CRC32, uncompressedSize;
@@ -98,6 +473,16 @@
 			return 0;
 		}
 
+#ifdef OF_HAVE_THREADS
+		if (_state == OFGZIPStreamStateID1 && _numberOfThreads > 1 &&
+		    inflateBGZFBlocks(self)) {
+			if (_BGZF->outputLength > 0)
+				return readBGZFOutput(self, buffer, length);
+
+			continue;
+		}
+#endif
+
 		switch (_state) {
 		case OFGZIPStreamStateID1:
 		case OFGZIPStreamStateID2:
@@ -326,11 +711,21 @@
 	if (_state == OFGZIPStreamStateData && !_inflateStream.atEndOfStream)
 		return false;
 
+#ifdef OF_HAVE_THREADS
+	if (_BGZF != NULL && _BGZF->outputPosition < _BGZF->outputLength)
+		return false;
+#endif
+
 	return _stream.atEndOfStream;
 }
 
 - (bool)lowlevelHasDataInReadBuffer
 {
+#ifdef OF_HAVE_THREADS
+	if (_BGZF != NULL && _BGZF->outputPosition < _BGZF->outputLength)
+		return true;
+#endif
+
 	if (_state == OFGZIPStreamStateData)
 		return _inflateStream.hasDataInReadBuffer;
 	else
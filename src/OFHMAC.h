@@ -22,6 +22,10 @@
 
 OF_ASSUME_NONNULL_BEGIN
 
+@class OFArray OF_GENERIC(ObjectType);
+@class OFData;
+@class OFSecureData;
+
 /**
  * @class OFHMAC OFHMAC.h ObjFW/ObjFW.h
  *
@@ -34,6 +38,7 @@ OF_SUBCLASSING_RESTRICTED
 	bool _allowsSwappableMemory;
 	id <OFCryptographicHash> _Nullable _outerHash, _innerHash;
 	id <OFCryptographicHash> _Nullable _outerHashCopy, _innerHashCopy;
+	OFSecureData *_Nullable _outerKeyPad, *_Nullable _innerKeyPad;
 	bool _calculated;
 }
 
@@ -117,6 +122,22 @@ OF_SUBCLASSING_RESTRICTED
  */
 - (void)calculate;
 
+/**
+ * @brief Calculates the HMAC of each of the data in the specified array with
+ *	  the key of the receiver and returns all HMACs.
+ *
+ * This neither uses nor changes the message the receiver is calculating the
+ * HMAC of. For the hashes that @ref OFData#digestsOfDataInArray:hashClass:
+ * hashes at the same time, this is a lot faster than calculating the HMACs one
+ * after another when there are many small data.
+ *
+ * @param array An array of data to calculate the HMAC of
+ * @return Data with an item size of @ref digestSize that contains the HMAC of
+ *	   each data in the array, in the same order
+ * @throw OFInvalidArgumentException No key has been set
+ */
+- (OFData *)digestsOfDataInArray: (OFArray OF_GENERIC(OFData *) *)array;
+
 /**
  * @brief Resets the HMAC so that it can be calculated for a new message.
  *
@@ -20,6 +20,8 @@
 #include "config.h"
 
 #import "OFHMAC.h"
+#import "OFArray.h"
+#import "OFMultiBufferHash.h"
 #import "OFSecureData.h"
 
 #import "OFHashAlreadyCalculatedException.h"
@@ -60,6 +62,8 @@
 	[_innerHash release];
 	[_outerHashCopy release];
 	[_innerHashCopy release];
+	[_outerKeyPad release];
+	[_innerKeyPad release];
 
 	[super dealloc];
 }
@@ -81,7 +85,10 @@
 	[_innerHash release];
 	[_outerHashCopy release];
 	[_innerHashCopy release];
+	[_outerKeyPad release];
+	[_innerKeyPad release];
 	_outerHash = _innerHash = _outerHashCopy = _innerHashCopy = nil;
+	_outerKeyPad = _innerKeyPad = nil;
 
 	@try {
 		if (length > blockSize) {
@@ -126,6 +133,9 @@
 		@throw e;
 	}
 
+	_outerKeyPad = [outerKeyPad retain];
+	_innerKeyPad = [innerKeyPad retain];
+
 	objc_autoreleasePoolPop(pool);
 
 	_outerHashCopy = [_outerHash copy];
@@ -162,6 +172,67 @@
 	_calculated = true;
 }
 
+- (OFData *)digestsOfDataInArray: (OFArray OF_GENERIC(OFData *) *)array
+{
+	void *pool;
+	size_t count = array.count, digestSize = [_hashClass digestSize];
+	const unsigned char **buffers;
+	size_t *lengths = NULL;
+	unsigned char *digests = NULL;
+	OFData *ret;
+
+	if (_outerKeyPad == nil || _innerKeyPad == nil)
+		@throw [OFInvalidArgumentException exception];
+
+	pool = objc_autoreleasePoolPush();
+	buffers = OFAllocMemory(count, sizeof(*buffers));
+
+	@try {
+		OFSecureData *innerDigests;
+		unsigned char *innerDigestsItems;
+		size_t i = 0;
+
+		lengths = OFAllocMemory(count, sizeof(*lengths));
+		digests = OFAllocMemory(count, digestSize);
+		innerDigests = [OFSecureData
+			    dataWithCount: count
+				 itemSize: digestSize
+		    allowsSwappableMemory: _allowsSwappableMemory];
+		innerDigestsItems = innerDigests.mutableItems;
+
+		for (OFData *data in array) {
+			buffers[i] = data.items;
+			lengths[i++] = data.count * data.itemSize;
+		}
+
+		_OFMultiBufferHash(_hashClass, _innerKeyPad.items, buffers,
+		    lengths, count, innerDigestsItems, _allowsSwappableMemory);
+
+		for (i = 0; i < count; i++) {
+			buffers[i] = innerDigestsItems + i * digestSize;
+			lengths[i] = digestSize;
+		}
+
+		_OFMultiBufferHash(_hashClass, _outerKeyPad.items, buffers,
+		    lengths, count, digests, _allowsSwappableMemory);
+
+		ret = [[OFData alloc] initWithItemsNoCopy: digests
+						    count: count
+						 itemSize: digestSize
+					     freeWhenDone: true];
+	} @catch (id e) {
+		OFFreeMemory(digests);
+		@throw e;
+	} @finally {
+		OFFreeMemory(buffers);
+		OFFreeMemory(lengths);
+	}
+
+	objc_autoreleasePoolPop(pool);
+
+	return [ret autorelease];
+}
+
 - (const unsigned char *)digest
 {
 	if (!_calculated)
@@ -193,7 +264,10 @@
 	[_innerHash release];
 	[_outerHashCopy release];
 	[_innerHashCopy release];
+	[_outerKeyPad release];
+	[_innerKeyPad release];
 	_outerHash = _innerHash = _outerHashCopy = _innerHashCopy = nil;
+	_outerKeyPad = _innerKeyPad = nil;
 
 	_calculated = false;
 }
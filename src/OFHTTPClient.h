@@ -30,9 +30,11 @@ OF_ASSUME_NONNULL_BEGIN
 @class OFHTTPRequest;
 @class OFHTTPResponse;
 @class OFIRI;
+@class OFMutableDictionary OF_GENERIC(KeyType, ObjectType);
 @class OFStream;
 @class OFTCPSocket;
 @class OFTLSStream;
+@class OFTimer;
 
 /**
  * @protocol OFHTTPClientDelegate OFHTTPClient.h ObjFW/ObjFW.h
@@ -147,6 +149,12 @@ OF_ASSUME_NONNULL_BEGIN
  * @class OFHTTPClient OFHTTPClient.h ObjFW/ObjFW.h
  *
  * @brief A class for performing HTTP requests.
+ *
+ * Multiple asynchronous requests can be performed at the same time, but a
+ * synchronous request can only be performed while no other request is in
+ * progress. Keep-alive connections are pooled per scheme, host and port and
+ * reused by later requests to the same server, which avoids both the TCP and
+ * the TLS handshake.
  */
 OF_SUBCLASSING_RESTRICTED
 @interface OFHTTPClient: OFObject
@@ -155,11 +163,13 @@ OF_SUBCLASSING_RESTRICTED
 @public
 #endif
 	OFObject <OFHTTPClientDelegate> *_Nullable _delegate;
-	bool _allowsInsecureRedirects, _inProgress;
-	OFStream *_Nullable _stream;
-	OFIRI *_Nullable _lastIRI;
-	bool _lastWasHEAD;
-	OFHTTPResponse *_Nullable _lastResponse;
+	bool _allowsInsecureRedirects;
+	OFMutableDictionary *_idleConnections;
+	unsigned int _maximumIdleConnectionsPerHost;
+	OFTimeInterval _idleConnectionTimeout;
+	OFTimer *_Nullable _idleConnectionsTimer;
+	size_t _numberOfRequestsInProgress;
+	bool _performingSyncRequest;
 }
 
 /**
@@ -173,6 +183,28 @@ OF_SUBCLASSING_RESTRICTED
  */
 @property (nonatomic) bool allowsInsecureRedirects;
 
+/**
+ * @brief The maximum number of keep-alive connections kept per scheme, host
+ *	  and port for reuse by later requests.
+ *
+ * A connection is only kept once the body of its response has been read
+ * completely. Kept connections are closed when the client is deallocated.
+ *
+ * Defaults to 6.
+ */
+@property (nonatomic) unsigned int maximumIdleConnectionsPerHost;
+
+/**
+ * @brief The time after which a keep-alive connection that has not been
+ *	  reused is closed.
+ *
+ * Idle connections are closed by a timer in the current thread's run loop,
+ * which means they are only closed while the run loop is running.
+ *
+ * Defaults to 60 seconds.
+ */
+@property (nonatomic) OFTimeInterval idleConnectionTimeout;
+
 /**
  * @brief Creates a new OFHTTPClient.
  *
@@ -222,7 +254,8 @@ OF_SUBCLASSING_RESTRICTED
  * @brief Asynchronously performs the specified HTTP request.
  *
  * @param request The request to perform
- * @throw OFAlreadyOpenException The client is already performing a request
+ * @throw OFAlreadyOpenException The client is performing a synchronous
+ *				  request
  */
 - (void)asyncPerformRequest: (OFHTTPRequest *)request;
 
@@ -233,7 +266,8 @@ OF_SUBCLASSING_RESTRICTED
  * @param redirects The maximum number of redirects after which no further
  *		    attempt is done to follow the redirect, but instead the
  *		    redirect is treated as an OFHTTPResponse
- * @throw OFAlreadyOpenException The client is already performing a request
+ * @throw OFAlreadyOpenException The client is performing a synchronous
+ *				  request
  */
 - (void)asyncPerformRequest: (OFHTTPRequest *)request
 		  redirects: (unsigned int)redirects;
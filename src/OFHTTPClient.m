@@ -22,10 +22,13 @@
 #include "config.h"
 
 #include <errno.h>
+#include <math.h>
 #include <string.h>
 
 #import "OFHTTPClient.h"
+#import "OFArray.h"
 #import "OFData.h"
+#import "OFDate.h"
 #import "OFDictionary.h"
 #import "OFHTTPRequest.h"
 #import "OFHTTPResponse.h"
@@ -36,6 +39,7 @@
 #import "OFString.h"
 #import "OFTCPSocket.h"
 #import "OFTLSStream.h"
+#import "OFTimer.h"
 
 #import "OFAlreadyOpenException.h"
 #import "OFHTTPRequestFailedException.h"
@@ -53,6 +57,14 @@
 #import "OFWriteFailedException.h"
 
 static const unsigned int defaultRedirects = 10;
+static const unsigned int defaultMaximumIdleConnectionsPerHost = 6;
+static const OFTimeInterval defaultIdleConnectionTimeout = 60;
+
+@interface OFHTTPClient ()
+- (void)of_asyncPerformRequest: (OFHTTPRequest *)request
+		     redirects: (unsigned int)redirects;
+- (void)of_closeIdleConnections;
+@end
 
 OF_DIRECT_MEMBERS
 @interface OFHTTPClientRequestHandler: OFObject <OFTCPSocketDelegate,
@@ -62,6 +74,7 @@ OF_DIRECT_MEMBERS
 	OFHTTPClient *_client;
 	OFHTTPRequest *_request;
 	unsigned int _redirects;
+	bool _finished;
 	bool _firstLine;
 	OFString *_version;
 	short _status;
@@ -72,9 +85,32 @@ OF_DIRECT_MEMBERS
 		       request: (OFHTTPRequest *)request
 		     redirects: (unsigned int)redirects;
 - (void)start;
+- (void)finish;
 - (void)closeAndReconnect;
 @end
 
+OF_DIRECT_MEMBERS
+@interface OFHTTPClientConnection: OFObject
+{
+@public
+	OFStream *_stream;
+	OFDate *_idleSince;
+}
+@end
+
+/*
+ * The timer retains its target, which must not keep the client alive. The
+ * client invalidates the timer before it goes away.
+ */
+@interface OFHTTPClientIdleConnectionsTimerTarget: OFObject
+{
+@public
+	OFHTTPClient *_client;
+}
+
+- (void)closeIdleConnections;
+@end
+
 OF_DIRECT_MEMBERS
 @interface OFHTTPClientRequestBodyStream: OFStream <OFReadyForWritingObserving>
 {
@@ -93,14 +129,16 @@ OF_DIRECT_MEMBERS
 @interface OFHTTPClientResponse: OFHTTPResponse <OFReadyForReadingObserving>
 {
 	OFStream *_stream;
-	bool _hasContentLength, _chunked, _keepAlive;
+	bool _hasContentLength, _chunked;
 	bool _atEndOfStream, _setAtEndOfStream;
 	long long _toRead;
+	OFHTTPClient *_Nullable _keepAliveClient;
+	OFIRI *_Nullable _keepAliveIRI;
 }
 
-@property (nonatomic, setter=of_setKeepAlive:) bool of_keepAlive;
-
 - (instancetype)initWithStream: (OFStream *)stream;
+- (void)keepAliveForClient: (OFHTTPClient *)client IRI: (OFIRI *)IRI;
+- (void)didReadBody;
 @end
 
 OF_DIRECT_MEMBERS
@@ -260,6 +298,124 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 	return follow;
 }
 
+static OFString *
+connectionKey(OFIRI *IRI)
+{
+	OFString *scheme = IRI.scheme.lowercaseString;
+	OFNumber *IRIPort = IRI.port;
+	uint16_t port;
+
+	if (IRIPort != nil)
+		port = IRIPort.unsignedShortValue;
+	else if ([scheme isEqual: @"https"])
+		port = 443;
+	else
+		port = 80;
+
+	return [OFString stringWithFormat: @"%@://%@:%" PRIu16,
+	    scheme, IRI.host.lowercaseString, port];
+}
+
+static void
+stopIdleConnectionsTimer(OFHTTPClient *client)
+{
+	[client->_idleConnectionsTimer invalidate];
+	[client->_idleConnectionsTimer release];
+	client->_idleConnectionsTimer = nil;
+}
+
+static void
+startIdleConnectionsTimer(OFHTTPClient *client, OFTimeInterval interval)
+{
+	OFHTTPClientIdleConnectionsTimerTarget *target =
+	    [[[OFHTTPClientIdleConnectionsTimerTarget alloc] init] autorelease];
+
+	target->_client = client;
+
+	client->_idleConnectionsTimer = [[OFTimer
+	    scheduledTimerWithTimeInterval: interval
+				    target: target
+				  selector: @selector(closeIdleConnections)
+				   repeats: false] retain];
+}
+
+/* Called once the response has been read completely. */
+static void
+addIdleConnection(OFHTTPClient *client, OFIRI *IRI, OFStream *stream)
+{
+	void *pool = objc_autoreleasePoolPush();
+	OFString *key = connectionKey(IRI);
+	OFMutableArray *connections;
+	OFHTTPClientConnection *connection;
+
+	if (client->_maximumIdleConnectionsPerHost == 0) {
+		objc_autoreleasePoolPop(pool);
+		return;
+	}
+
+	connections = [client->_idleConnections objectForKey: key];
+	if (connections == nil) {
+		connections = [OFMutableArray array];
+		[client->_idleConnections setObject: connections forKey: key];
+	}
+
+	/* Evict the connections that have been idle for the longest time. */
+	while (connections.count >= client->_maximumIdleConnectionsPerHost)
+		[connections removeObjectAtIndex: 0];
+
+	connection = [[[OFHTTPClientConnection alloc] init] autorelease];
+	connection->_stream = [stream retain];
+	connection->_idleSince = [[OFDate alloc] init];
+	[connections addObject: connection];
+
+	if (client->_idleConnectionsTimer == nil)
+		startIdleConnectionsTimer(client,
+		    client->_idleConnectionTimeout);
+
+	objc_autoreleasePoolPop(pool);
+}
+
+static OFStream *
+takeIdleConnection(OFHTTPClient *client, OFIRI *IRI)
+{
+	void *pool = objc_autoreleasePoolPush();
+	OFString *key = connectionKey(IRI);
+	OFMutableArray OF_GENERIC(OFHTTPClientConnection *) *connections =
+	    [client->_idleConnections objectForKey: key];
+	OFStream *stream = nil;
+	size_t i = connections.count;
+
+	/*
+	 * Prefer the most recently used connection, as it is the least likely
+	 * to have been closed by the server in the meantime.
+	 */
+	while (i-- > 0) {
+		OFHTTPClientConnection *connection =
+		    [connections objectAtIndex: i];
+
+		if (connection->_stream.atEndOfStream ||
+		    -connection->_idleSince.timeIntervalSinceNow >
+		    client->_idleConnectionTimeout) {
+			[connections removeObjectAtIndex: i];
+			continue;
+		}
+
+		stream = [connection->_stream retain];
+		[connections removeObjectAtIndex: i];
+		break;
+	}
+
+	if (connections != nil && connections.count == 0)
+		[client->_idleConnections removeObjectForKey: key];
+
+	if (client->_idleConnections.count == 0)
+		stopIdleConnectionsTimer(client);
+
+	objc_autoreleasePoolPop(pool);
+
+	return [stream autorelease];
+}
+
 @implementation OFHTTPClientRequestHandler
 - (instancetype)initWithClient: (OFHTTPClient *)client
 		       request: (OFHTTPRequest *)request
@@ -269,6 +425,9 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 
 	@try {
 		_client = [client retain];
+		/* Decremented by -[finish], at the latest on deallocation. */
+		_client->_numberOfRequestsInProgress++;
+
 		_request = [request retain];
 		_redirects = redirects;
 		_serverHeaders = [[OFMutableDictionary alloc] init];
@@ -282,6 +441,8 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 
 - (void)dealloc
 {
+	[self finish];
+
 	[_client release];
 	[_request release];
 	[_version release];
@@ -290,10 +451,18 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 	[super dealloc];
 }
 
+- (void)finish
+{
+	if (_finished || _client == nil)
+		return;
+
+	_finished = true;
+	_client->_numberOfRequestsInProgress--;
+}
+
 - (void)raiseException: (id)exception
 {
-	[_client close];
-	_client->_inProgress = false;
+	[self finish];
 
 	[_client->_delegate client: _client
 		 didPerformRequest: _request
@@ -319,7 +488,8 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 	connectionHeader = [_serverHeaders objectForKey: @"Connection"];
 	if ([_version isEqual: @"1.1"]) {
 		if (connectionHeader != nil)
-			keepAlive = [connectionHeader isEqual: @"close"];
+			keepAlive = ([connectionHeader caseInsensitiveCompare:
+			    @"close"] != OFOrderedSame);
 		else
 			keepAlive = true;
 	} else {
@@ -331,13 +501,14 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 	}
 
 	if (keepAlive) {
-		response.of_keepAlive = true;
-
-		_client->_stream = [stream retain];
-		_client->_lastIRI = [IRI copy];
-		_client->_lastWasHEAD =
-		    (_request.method == OFHTTPRequestMethodHead);
-		_client->_lastResponse = [response retain];
+		/*
+		 * The connection goes back to the pool once the body has been
+		 * read. A response to HEAD has no body.
+		 */
+		if (_request.method == OFHTTPRequestMethodHead)
+			addIdleConnection(_client, IRI, stream);
+		else
+			[response keepAliveForClient: _client IRI: IRI];
 	}
 
 	if (_redirects > 0 && (_status == 301 || _status == 302 ||
@@ -403,16 +574,14 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 			newRequest.IRI = newIRI;
 			newRequest.headers = newHeaders;
 
-			_client->_inProgress = false;
-
-			[_client asyncPerformRequest: newRequest
-					   redirects: _redirects - 1];
+			/* The new request takes over from this one. */
+			[_client of_asyncPerformRequest: newRequest
+					      redirects: _redirects - 1];
+			[self finish];
 			return;
 		}
 	}
 
-	_client->_inProgress = false;
-
 	if (_status / 100 != 2)
 		exception = [OFHTTPRequestFailedException
 		    exceptionWithRequest: _request
@@ -420,6 +589,8 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 	else
 		exception = nil;
 
+	[self finish];
+
 	[_client->_delegate performSelector: @selector(client:didPerformRequest:
 						 response:exception:)
 				 withObject: _client
@@ -687,30 +858,15 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 
 - (void)start
 {
-	OFIRI *IRI = _request.IRI;
-	OFStream *stream;
-
-	/* Can we reuse the last socket? */
-	if (_client->_stream != nil && !_client->_stream.atEndOfStream &&
-	    [_client->_lastIRI.scheme isEqual: IRI.scheme] &&
-	    [_client->_lastIRI.host isEqual: IRI.host] &&
-	    (_client->_lastIRI.port == IRI.port ||
-	    [_client->_lastIRI.port isEqual: IRI.port]) &&
-	    (_client->_lastWasHEAD || _client->_lastResponse.atEndOfStream)) {
-		/*
-		 * Set _stream to nil, so that in case of an error it won't be
-		 * reused. If everything is successful, we set _stream again
-		 * at the end.
-		 */
-		stream = [_client->_stream autorelease];
-		_client->_stream = nil;
-
-		[_client->_lastIRI release];
-		_client->_lastIRI = nil;
-
-		[_client->_lastResponse release];
-		_client->_lastResponse = nil;
+	/*
+	 * Can we reuse a kept-alive connection? It is taken out of the pool,
+	 * so that in case of an error it won't be reused. If everything is
+	 * successful, it is added to the pool again once the response has been
+	 * received.
+	 */
+	OFStream *stream = takeIdleConnection(_client, _request.IRI);
 
+	if (stream != nil) {
 		stream.delegate = self;
 
 		[self performSelector: @selector(handleStream:)
@@ -729,8 +885,6 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 		uint16_t port;
 		OFNumber *URIPort;
 
-		[_client close];
-
 		sock = [OFTCPSocket socket];
 		sock.allowsMPTCP = true;
 
@@ -752,6 +906,23 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 }
 @end
 
+@implementation OFHTTPClientConnection
+- (void)dealloc
+{
+	[_stream release];
+	[_idleSince release];
+
+	[super dealloc];
+}
+@end
+
+@implementation OFHTTPClientIdleConnectionsTimerTarget
+- (void)closeIdleConnections
+{
+	[_client of_closeIdleConnections];
+}
+@end
+
 @implementation OFHTTPClientRequestBodyStream
 - (instancetype)initWithHandler: (OFHTTPClientRequestHandler *)handler
 			 stream: (OFStream *)stream
@@ -869,8 +1040,6 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 @end
 
 @implementation OFHTTPClientResponse
-@synthesize of_keepAlive = _keepAlive;
-
 - (instancetype)initWithStream: (OFStream *)stream
 {
 	self = [super init];
@@ -885,9 +1054,35 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 	if (_stream != nil)
 		[self close];
 
+	[_keepAliveClient release];
+	[_keepAliveIRI release];
+
 	[super dealloc];
 }
 
+- (void)keepAliveForClient: (OFHTTPClient *)client IRI: (OFIRI *)IRI
+{
+	_keepAliveClient = [client retain];
+	_keepAliveIRI = [IRI copy];
+
+	/* An empty body has already been read completely. */
+	if (_hasContentLength && _toRead == 0)
+		[self didReadBody];
+}
+
+- (void)didReadBody
+{
+	_atEndOfStream = true;
+
+	if (_keepAliveClient == nil)
+		return;
+
+	addIdleConnection(_keepAliveClient, _keepAliveIRI, _stream);
+
+	[_keepAliveClient release];
+	_keepAliveClient = nil;
+}
+
 - (void)setHeaders: (OFDictionary *)headers
 {
 	OFString *contentLength;
@@ -946,7 +1141,7 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 		_toRead -= ret;
 
 		if (_toRead == 0)
-			_atEndOfStream = true;
+			[self didReadBody];
 
 		return ret;
 	}
@@ -969,7 +1164,7 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 		}
 
 		if (_setAtEndOfStream && _toRead == 0)
-			_atEndOfStream = true;
+			[self didReadBody];
 
 		return 0;
 	} else if (_toRead == -1) {
@@ -983,7 +1178,7 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 		}
 
 		if (_setAtEndOfStream && _toRead == 0)
-			_atEndOfStream = true;
+			[self didReadBody];
 
 		return 0;
 	} else if (_toRead > 0) {
@@ -1082,6 +1277,10 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 
 	_atEndOfStream = false;
 
+	/* A partially read connection can't be reused. */
+	[_keepAliveClient release];
+	_keepAliveClient = nil;
+
 	[_stream release];
 	_stream = nil;
 
@@ -1118,7 +1317,7 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 - (OFHTTPResponse *)performRequest: (OFHTTPRequest *)request
 			 redirects: (unsigned int)redirects
 {
-	[_client asyncPerformRequest: request redirects: redirects];
+	[_client of_asyncPerformRequest: request redirects: redirects];
 	[[OFRunLoop currentRunLoop] run];
 	return _response;
 }
@@ -1217,16 +1416,37 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 @implementation OFHTTPClient
 @synthesize delegate = _delegate;
 @synthesize allowsInsecureRedirects = _allowsInsecureRedirects;
+@synthesize maximumIdleConnectionsPerHost = _maximumIdleConnectionsPerHost;
+@synthesize idleConnectionTimeout = _idleConnectionTimeout;
 
 + (instancetype)client
 {
 	return [[[self alloc] init] autorelease];
 }
 
+- (instancetype)init
+{
+	self = [super init];
+
+	@try {
+		_idleConnections = [[OFMutableDictionary alloc] init];
+		_maximumIdleConnectionsPerHost =
+		    defaultMaximumIdleConnectionsPerHost;
+		_idleConnectionTimeout = defaultIdleConnectionTimeout;
+	} @catch (id e) {
+		[self release];
+		@throw e;
+	}
+
+	return self;
+}
+
 - (void)dealloc
 {
 	[self close];
 
+	[_idleConnections release];
+
 	[super dealloc];
 }
 
@@ -1238,12 +1458,27 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 - (OFHTTPResponse *)performRequest: (OFHTTPRequest *)request
 			 redirects: (unsigned int)redirects
 {
-	void *pool = objc_autoreleasePoolPush();
-	OFHTTPClientSyncPerformer *syncPerformer =
-	    [[[OFHTTPClientSyncPerformer alloc] initWithClient: self]
-	    autorelease];
-	OFHTTPResponse *response = [syncPerformer performRequest: request
-						       redirects: redirects];
+	void *pool;
+	OFHTTPClientSyncPerformer *syncPerformer;
+	OFHTTPResponse *response;
+
+	/*
+	 * The synchronous request takes over the delegate, so it would also
+	 * receive the responses for any other requests.
+	 */
+	if (_numberOfRequestsInProgress > 0)
+		@throw [OFAlreadyOpenException exceptionWithObject: self];
+
+	pool = objc_autoreleasePoolPush();
+	_performingSyncRequest = true;
+	@try {
+		syncPerformer = [[[OFHTTPClientSyncPerformer alloc]
+		    initWithClient: self] autorelease];
+		response = [syncPerformer performRequest: request
+					       redirects: redirects];
+	} @finally {
+		_performingSyncRequest = false;
+	}
 
 	[response retain];
 
@@ -1259,6 +1494,15 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 
 - (void)asyncPerformRequest: (OFHTTPRequest *)request
 		  redirects: (unsigned int)redirects
+{
+	if (_performingSyncRequest)
+		@throw [OFAlreadyOpenException exceptionWithObject: self];
+
+	[self of_asyncPerformRequest: request redirects: redirects];
+}
+
+- (void)of_asyncPerformRequest: (OFHTTPRequest *)request
+		     redirects: (unsigned int)redirects
 {
 	void *pool = objc_autoreleasePoolPush();
 	OFIRI *IRI = request.IRI;
@@ -1268,11 +1512,6 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 	    [scheme caseInsensitiveCompare: @"https"] != OFOrderedSame)
 		@throw [OFUnsupportedProtocolException exceptionWithIRI: IRI];
 
-	if (_inProgress)
-		@throw [OFAlreadyOpenException exceptionWithObject: self];
-
-	_inProgress = true;
-
 	[[[[OFHTTPClientRequestHandler alloc]
 	    initWithClient: self
 		   request: request
@@ -1281,15 +1520,52 @@ defaultShouldFollow(OFHTTPRequestMethod method, short statusCode)
 	objc_autoreleasePoolPop(pool);
 }
 
-- (void)close
+- (void)of_closeIdleConnections
 {
-	[_stream release];
-	_stream = nil;
+	void *pool = objc_autoreleasePoolPush();
+	OFTimeInterval nextExpiration = INFINITY;
+	OFMutableArray OF_GENERIC(OFString *) *emptyKeys =
+	    [OFMutableArray array];
+
+	/* The timer has fired and invalidates itself. */
+	[_idleConnectionsTimer release];
+	_idleConnectionsTimer = nil;
+
+	for (OFString *key in _idleConnections) {
+		OFMutableArray OF_GENERIC(OFHTTPClientConnection *)
+		    *connections = [_idleConnections objectForKey: key];
+		size_t i = connections.count;
+
+		while (i-- > 0) {
+			OFHTTPClientConnection *connection =
+			    [connections objectAtIndex: i];
+			OFTimeInterval remaining = _idleConnectionTimeout +
+			    connection->_idleSince.timeIntervalSinceNow;
+
+			if (remaining <= 0 ||
+			    connection->_stream.atEndOfStream)
+				[connections removeObjectAtIndex: i];
+			else if (remaining < nextExpiration)
+				nextExpiration = remaining;
+		}
+
+		if (connections.count == 0)
+			[emptyKeys addObject: key];
+	}
+
+	for (OFString *key in emptyKeys)
+		[_idleConnections removeObjectForKey: key];
+
+	if (_idleConnections.count > 0)
+		startIdleConnectionsTimer(self, nextExpiration);
 
-	[_lastIRI release];
-	_lastIRI = nil;
+	objc_autoreleasePoolPop(pool);
+}
+
+- (void)close
+{
+	[_idleConnections removeAllObjects];
 
-	[_lastResponse release];
-	_lastResponse = nil;
+	stopIdleConnectionsTimer(self);
 }
 @end
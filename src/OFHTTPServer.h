@@ -26,9 +26,15 @@
 OF_ASSUME_NONNULL_BEGIN
 
 @class OFArray OF_GENERIC(ObjectType);
+@class OFData;
+@class OFDictionary OF_GENERIC(KeyType, ObjectType);
 @class OFHTTPRequest;
 @class OFHTTPResponse;
 @class OFHTTPServer;
+@class OFIRI;
+@class OFList;
+@class OFMutableDictionary OF_GENERIC(KeyType, ObjectType);
+@class OFMutex;
 @class OFStream;
 @class OFTCPSocket;
 @class OFX509Certificate;
@@ -43,6 +49,12 @@ OF_ASSUME_NONNULL_BEGIN
  * @brief This method is called when the HTTP server received a request from a
  *	  client.
  *
+ * If the client requested to keep the connection alive, the response sets
+ * either a `Content-Length` or `Transfer-Encoding: chunked` and the request
+ * body has been read completely, the server waits for the next request on the
+ * same connection once the response has been closed. Pipelined requests are
+ * processed in order, one after another.
+ *
  * @param server The HTTP server which received the request
  * @param request The request the HTTP server received
  * @param requestBody A stream to read the body of the request from, if any
@@ -143,6 +155,12 @@ OF_SUBCLASSING_RESTRICTED
 #ifdef OF_HAVE_THREADS
 	size_t _numberOfThreads, _nextThreadIndex;
 	OFArray *_threadPool;
+#endif
+	OFMutableDictionary *_responseCache;
+	OFList *_responseCacheList;
+	size_t _responseCacheSize, _responseCacheUsage;
+#ifdef OF_HAVE_THREADS
+	OFMutex *_responseCacheMutex;
 #endif
 }
 
@@ -205,6 +223,19 @@ OF_SUBCLASSING_RESTRICTED
  */
 @property OF_NULLABLE_PROPERTY (copy, nonatomic) OFString *name;
 
+/**
+ * @brief The maximum number of bytes the response cache may use.
+ *
+ * Responses stored with
+ * @ref cacheResponseWithStatusCode:headers:body:forIRI: are sent to clients
+ * directly by the thread handling the connection, without calling the
+ * delegate. If storing a response exceeds this size, the least recently used
+ * responses are evicted.
+ *
+ * The default is 0, which disables the response cache.
+ */
+@property (nonatomic) size_t responseCacheSize;
+
 /**
  * @brief Creates a new HTTP server.
  *
@@ -225,6 +256,54 @@ OF_SUBCLASSING_RESTRICTED
  *	  finished or timed out.
  */
 - (void)stop;
+
+/**
+ * @brief Stores a response in the response cache.
+ *
+ * Subsequent `GET` and `HEAD` requests without a body for the specified IRI
+ * are answered from the cache instead of being passed to the delegate. The
+ * IRI is compared to the IRI of the request, so the easiest way is to pass
+ * @ref OFHTTPRequest#IRI.
+ *
+ * The `Content-Length` header is set automatically and an `ETag` header is
+ * generated from the body if none is specified. Requests with a matching
+ * `If-None-Match` or an `If-Modified-Since` that is not older than the
+ * `Last-Modified` header are answered with `304 Not Modified`, which repeats
+ * the `Cache-Control`, `Content-Location`, `ETag`, `Expires`, `Server` and
+ * `Vary` headers of the cached response.
+ *
+ * If the headers contain a `Content-Encoding`, the body is considered to be
+ * pre-compressed with that encoding and it is only sent to clients that list
+ * the encoding in their `Accept-Encoding`. Such a response is stored in
+ * addition to the uncompressed one. `Accept-Encoding` is added to the `Vary`
+ * header of every cached response, as it selects the variant that is sent.
+ *
+ * If the response is larger than @ref responseCacheSize, it is not cached.
+ *
+ * @param statusCode The status code of the response
+ * @param headers The headers of the response
+ * @param body The body of the response
+ * @param IRI The IRI of the request to send the response for
+ * @throw OFInvalidArgumentException The item size of the body is not 1
+ */
+- (void)cacheResponseWithStatusCode: (short)statusCode
+			    headers: (nullable OFDictionary OF_GENERIC(
+					 OFString *, OFString *) *)headers
+			       body: (OFData *)body
+			     forIRI: (OFIRI *)IRI;
+
+/**
+ * @brief Removes all cached responses for the specified IRI from the response
+ *	  cache.
+ *
+ * @param IRI The IRI for which to remove all cached responses
+ */
+- (void)removeCachedResponsesForIRI: (OFIRI *)IRI;
+
+/**
+ * @brief Removes all responses from the response cache.
+ */
+- (void)removeAllCachedResponses;
 @end
 
 OF_ASSUME_NONNULL_END
@@ -27,6 +27,7 @@
 
 #import "OFHTTPServer.h"
 #import "OFArray.h"
+#import "OFCRC32.h"
 #import "OFData.h"
 #import "OFDate.h"
 #import "OFDictionary.h"
@@ -34,6 +35,10 @@
 #import "OFHTTPResponse.h"
 #import "OFIRI.h"
 #import "OFIRI+Private.h"
+#import "OFList.h"
+#ifdef OF_HAVE_THREADS
+# import "OFMutex.h"
+#endif
 #import "OFNumber.h"
 #import "OFSocket.h"
 #import "OFSocket+Private.h"
@@ -61,7 +66,13 @@
  * FIXME: Errors are not reported to the user.
  */
 
+@class OFHTTPServerCachedResponse;
+@class OFHTTPServerConnection;
+
 @interface OFHTTPServer () <OFTCPSocketDelegate, OFTLSStreamDelegate>
+- (nullable OFHTTPServerCachedResponse *)
+    of_cachedResponseForIRIString: (OFString *)IRIString
+		   acceptEncoding: (nullable OFString *)acceptEncoding;
 @end
 
 OF_DIRECT_MEMBERS
@@ -70,12 +81,12 @@ OF_DIRECT_MEMBERS
 	OFStream <OFReadyForWritingObserving> *_stream;
 	OFHTTPServer *_server;
 	OFHTTPRequest *_request;
-	bool _chunked, _headersSent;
+	OFHTTPServerConnection *_connection;
+	bool _chunked, _headersSent, _keepAlive;
 }
 
-- (instancetype)initWithStream: (OFStream <OFReadyForWritingObserving> *)stream
-			server: (OFHTTPServer *)server
-		       request: (OFHTTPRequest *)request;
+- (instancetype)initWithConnection: (OFHTTPServerConnection *)connection
+			   request: (OFHTTPRequest *)request;
 @end
 
 OF_DIRECT_MEMBERS
@@ -98,6 +109,10 @@ OF_DIRECT_MEMBERS
 	OFMutableDictionary *_headers;
 	size_t _contentLength;
 	OFStream *_requestBody;
+	bool _keepAlive;
+#ifdef OF_HAVE_THREADS
+	OFThread *_thread;
+#endif
 }
 
 - (instancetype)initWithStream: (OFStream <OFReadyForReadingObserving,
@@ -107,6 +122,12 @@ OF_DIRECT_MEMBERS
 - (bool)parseHeaders: (OFString *)line;
 - (bool)sendErrorAndClose: (short)statusCode;
 - (void)createResponse;
+- (void)sendCachedResponse: (OFHTTPServerCachedResponse *)cachedResponse;
+@end
+
+/* Not direct, as it gets performed on the connection's thread. */
+@interface OFHTTPServerConnection ()
+- (void)awaitNextRequest;
 @end
 
 OF_DIRECT_MEMBERS
@@ -123,6 +144,20 @@ OF_DIRECT_MEMBERS
 		 contentLength: (unsigned long long)contentLength;
 @end
 
+OF_DIRECT_MEMBERS
+@interface OFHTTPServerCachedResponse: OFObject
+{
+@public
+	OFString *_IRIString, *_contentEncoding, *_ETag;
+	short _statusCode;
+	/* The heads lack the protocol version, which depends on the request. */
+	OFData *_head, *_notModifiedHead, *_body;
+	OFDate *_lastModified;
+	OFListItem _listItem;
+	size_t _size;
+}
+@end
+
 #ifdef OF_HAVE_THREADS
 OF_DIRECT_MEMBERS
 @interface OFHTTPServerThread: OFThread
@@ -130,30 +165,117 @@ OF_DIRECT_MEMBERS
 @end
 #endif
 
+static OFString *const dateFormat = @"%a, %d %b %Y %H:%M:%S GMT";
+
+static const struct {
+	const char *name;
+	OFString *string;
+} commonHeaders[] = {
+	{ "Host", @"Host" },
+	{ "User-Agent", @"User-Agent" },
+	{ "Accept", @"Accept" },
+	{ "Accept-Encoding", @"Accept-Encoding" },
+	{ "Accept-Language", @"Accept-Language" },
+	{ "Connection", @"Connection" },
+	{ "Content-Length", @"Content-Length" },
+	{ "Content-Type", @"Content-Type" },
+	{ "Transfer-Encoding", @"Transfer-Encoding" },
+	{ "Cookie", @"Cookie" },
+	{ "Authorization", @"Authorization" },
+	{ "Cache-Control", @"Cache-Control" },
+	{ "If-Modified-Since", @"If-Modified-Since" },
+	{ "If-None-Match", @"If-None-Match" },
+	{ "Referer", @"Referer" },
+	{ "Origin", @"Origin" },
+	{ "Range", @"Range" },
+	{ "Expect", @"Expect" },
+	{ "Upgrade", @"Upgrade" },
+	{ "Pragma", @"Pragma" }
+};
+
+/* The headers of a cached response that are repeated in a 304 for it. */
+static OFString *const notModifiedHeaders[] = {
+	@"Cache-Control",
+	@"Content-Location",
+	@"ETag",
+	@"Expires",
+	@"Server",
+	@"Vary"
+};
+
+static const struct {
+	const char *name;
+	OFHTTPRequestMethod method;
+} methods[] = {
+	{ "GET", OFHTTPRequestMethodGet },
+	{ "POST", OFHTTPRequestMethodPost },
+	{ "HEAD", OFHTTPRequestMethodHead },
+	{ "PUT", OFHTTPRequestMethodPut },
+	{ "DELETE", OFHTTPRequestMethodDelete },
+	{ "OPTIONS", OFHTTPRequestMethodOptions },
+	{ "TRACE", OFHTTPRequestMethodTrace },
+	{ "CONNECT", OFHTTPRequestMethodConnect }
+};
+
+static bool
+parseMethod(const char *string, size_t length, OFHTTPRequestMethod *method)
+{
+	for (size_t i = 0; i < sizeof(methods) / sizeof(*methods); i++) {
+		if (strlen(methods[i].name) == length &&
+		    memcmp(methods[i].name, string, length) == 0) {
+			*method = methods[i].method;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Returns the normalized key for the specified bytes of a header line. The
+ * most common header names are returned as constant strings so that no
+ * allocation is necessary for them.
+ */
 static OFString *
-normalizedKey(OFString *key)
+normalizedKey(const char *key, size_t length)
 {
-	char *cString = _OFStrDup(key.UTF8String);
-	unsigned char *tmp = (unsigned char *)cString;
+	char *cString;
 	bool firstLetter = true;
 	OFString *ret;
 
-	while (*tmp != '\0') {
-		if (!OFASCIIIsAlpha(*tmp)) {
+	for (size_t i = 0; i < sizeof(commonHeaders) / sizeof(*commonHeaders);
+	    i++) {
+		const char *name = commonHeaders[i].name;
+		size_t j;
+
+		for (j = 0; j < length; j++)
+			if (name[j] == '\0' ||
+			    OFASCIIToLower(name[j]) != OFASCIIToLower(key[j]))
+				break;
+
+		if (j == length && name[j] == '\0')
+			return commonHeaders[i].string;
+	}
+
+	cString = OFAllocMemory(length + 1, 1);
+	for (size_t i = 0; i < length; i++) {
+		unsigned char c = (unsigned char)key[i];
+
+		if (!OFASCIIIsAlpha(c)) {
 			firstLetter = true;
-			tmp++;
+			cString[i] = c;
 			continue;
 		}
 
-		*tmp = (firstLetter
-		    ? OFASCIIToUpper(*tmp) : OFASCIIToLower(*tmp));
-
+		cString[i] = (firstLetter
+		    ? OFASCIIToUpper(c) : OFASCIIToLower(c));
 		firstLetter = false;
-		tmp++;
 	}
+	cString[length] = '\0';
 
 	@try {
 		ret = [OFString stringWithUTF8StringNoCopy: cString
+						    length: length
 					      freeWhenDone: true];
 	} @catch (id e) {
 		OFFreeMemory(cString);
@@ -163,17 +285,135 @@ normalizedKey(OFString *key)
 	return ret;
 }
 
+static OFString *
+stripWeakETagPrefix(OFString *ETag)
+{
+	if ([ETag hasPrefix: @"W/"])
+		return [ETag substringFromIndex: 2];
+
+	return ETag;
+}
+
+static bool
+ETagMatches(OFString *ifNoneMatch, OFString *ETag)
+{
+	void *pool = objc_autoreleasePoolPush();
+	bool matches = false;
+
+	ETag = stripWeakETagPrefix(ETag);
+
+	for (OFString *tag in [ifNoneMatch componentsSeparatedByString: @","]) {
+		tag = stripWeakETagPrefix(
+		    tag.stringByDeletingEnclosingWhitespaces);
+
+		if ([tag isEqual: @"*"] || [tag isEqual: ETag]) {
+			matches = true;
+			break;
+		}
+	}
+
+	objc_autoreleasePoolPop(pool);
+
+	return matches;
+}
+
+/*
+ * Returns the lowercase encoding of an Accept-Encoding element, or nil if the
+ * element has a q value of 0.
+ */
+static OFString *
+acceptedEncoding(OFString *element)
+{
+	size_t pos = [element rangeOfString: @";"].location;
+
+	if (pos != OFNotFound) {
+		OFString *parameter = [element substringFromIndex: pos + 1]
+		    .stringByDeletingEnclosingWhitespaces;
+
+		if ([parameter hasPrefix: @"q="]) {
+			@try {
+				if ([parameter substringFromIndex: 2]
+				    .doubleValue <= 0)
+					return nil;
+			} @catch (OFInvalidFormatException *e) {
+				return nil;
+			}
+		}
+
+		element = [element substringToIndex: pos];
+	}
+
+	return element.stringByDeletingEnclosingWhitespaces.lowercaseString;
+}
+
+static bool
+varyIncludesAcceptEncoding(OFString *vary)
+{
+	void *pool = objc_autoreleasePoolPush();
+	bool includes = false;
+
+	for (OFString *field in [vary componentsSeparatedByString: @","]) {
+		field = field.stringByDeletingEnclosingWhitespaces;
+
+		if ([field isEqual: @"*"] || [field caseInsensitiveCompare:
+		    @"Accept-Encoding"] == OFOrderedSame) {
+			includes = true;
+			break;
+		}
+	}
+
+	objc_autoreleasePoolPop(pool);
+
+	return includes;
+}
+
+/* Must be called with the response cache mutex locked. */
+static void
+removeCachedResponse(OFHTTPServer *self,
+    OFHTTPServerCachedResponse *cachedResponse)
+{
+	OFMutableDictionary *variants;
+
+	[cachedResponse retain];
+	@try {
+		variants = [self->_responseCache
+		    objectForKey: cachedResponse->_IRIString];
+
+		[self->_responseCacheList
+		    removeListItem: cachedResponse->_listItem];
+		[variants removeObjectForKey: cachedResponse->_contentEncoding];
+
+		if (variants.count == 0)
+			[self->_responseCache
+			    removeObjectForKey: cachedResponse->_IRIString];
+
+		self->_responseCacheUsage -= cachedResponse->_size;
+	} @finally {
+		[cachedResponse release];
+	}
+}
+
+/* Must be called with the response cache mutex locked. */
+static void
+evictCachedResponses(OFHTTPServer *self)
+{
+	while (self->_responseCacheUsage > self->_responseCacheSize)
+		removeCachedResponse(self, OFListItemObject(
+		    self->_responseCacheList.lastListItem));
+}
+
 @implementation OFHTTPServerResponse
-- (instancetype)initWithStream: (OFStream <OFReadyForWritingObserving> *)stream
-			server: (OFHTTPServer *)server
-		       request: (OFHTTPRequest *)request
+- (instancetype)initWithConnection: (OFHTTPServerConnection *)connection
+			   request: (OFHTTPRequest *)request
 {
 	self = [super init];
 
 	_statusCode = 500;
-	_stream = [stream retain];
-	_server = [server retain];
+	_stream = [connection->_stream retain];
+	_server = [connection->_server retain];
 	_request = [request retain];
+	_connection = [connection retain];
+	_keepAlive = connection->_keepAlive;
 
 	return self;
 }
@@ -185,6 +425,7 @@ normalizedKey(OFString *key)
 
 	[_server release];
 	[_request release];
+	[_connection release];
 
 	[super dealloc];
 }
@@ -204,7 +445,7 @@ normalizedKey(OFString *key)
 
 	if ([headers objectForKey: @"Date"] == nil) {
 		OFString *date = [[OFDate date]
-		    dateStringWithFormat: @"%a, %d %b %Y %H:%M:%S GMT"];
+		    dateStringWithFormat: dateFormat];
 		[headers setObject: date forKey: @"Date"];
 	}
 
@@ -215,6 +456,36 @@ normalizedKey(OFString *key)
 			[headers setObject: name forKey: @"Server"];
 	}
 
+	_chunked = [[headers objectForKey: @"Transfer-Encoding"]
+	    isEqual: @"chunked"];
+
+	/*
+	 * The connection can only be kept alive if the client can tell where
+	 * the response ends without the connection being closed.
+	 */
+	if (_keepAlive) {
+		OFString *connection = [headers objectForKey: @"Connection"];
+
+		if (connection != nil && [connection
+		    caseInsensitiveCompare: @"close"] == OFOrderedSame)
+			_keepAlive = false;
+		else if (_statusCode / 100 == 1)
+			_keepAlive = false;
+		else if (!_chunked &&
+		    [headers objectForKey: @"Content-Length"] == nil &&
+		    _request.method != OFHTTPRequestMethodHead &&
+		    _statusCode != 204 && _statusCode != 304)
+			_keepAlive = false;
+	}
+
+	if ([headers objectForKey: @"Connection"] == nil) {
+		if (!_keepAlive && _request.protocolVersion.minor > 0)
+			[headers setObject: @"close" forKey: @"Connection"];
+		else if (_keepAlive && _request.protocolVersion.minor == 0)
+			[headers setObject: @"keep-alive"
+				    forKey: @"Connection"];
+	}
+
 	keyEnumerator = [headers keyEnumerator];
 	valueEnumerator = [headers objectEnumerator];
 	while ((key = [keyEnumerator nextObject]) != nil &&
@@ -224,8 +495,6 @@ normalizedKey(OFString *key)
 	[_stream writeString: @"\r\n"];
 
 	_headersSent = true;
-	_chunked = [[headers objectForKey: @"Transfer-Encoding"]
-	    isEqual: @"chunked"];
 
 	objc_autoreleasePoolPop(pool);
 }
@@ -267,6 +536,8 @@ normalizedKey(OFString *key)
 
 - (void)close
 {
+	OFHTTPServerConnection *connection;
+
 	if (_stream == nil)
 		@throw [OFNotOpenException exceptionWithObject: self];
 
@@ -279,6 +550,8 @@ normalizedKey(OFString *key)
 	} @catch (OFWriteFailedException *e) {
 		id <OFHTTPServerDelegate> delegate = _server.delegate;
 
+		_keepAlive = false;
+
 #if OF_GCC_VERSION >= 402
 # pragma GCC diagnostic push
 # pragma GCC diagnostic ignored "-Wdeprecated"
@@ -303,6 +576,32 @@ normalizedKey(OFString *key)
 	[_stream release];
 	_stream = nil;
 
+	connection = _connection;
+	_connection = nil;
+
+	/*
+	 * If the request body has not been read completely, we don't know
+	 * where the next request starts.
+	 */
+	if (connection->_requestBody != nil &&
+	    !connection->_requestBody.atEndOfStream)
+		_keepAlive = false;
+
+	if (_keepAlive) {
+#ifdef OF_HAVE_THREADS
+		OFThread *thread = connection->_thread;
+
+		if (thread != nil && thread != [OFThread currentThread])
+			[connection performSelector: @selector(awaitNextRequest)
+					   onThread: thread
+				      waitUntilDone: false];
+		else
+#endif
+			[connection awaitNextRequest];
+	}
+
+	[connection release];
+
 	[super close];
 }
 
@@ -332,6 +631,9 @@ normalizedKey(OFString *key)
 							cancelAsyncRequests)
 					   repeats: false] retain];
 		_state = stateAwaitingProlog;
+#ifdef OF_HAVE_THREADS
+		_thread = [[OFThread currentThread] retain];
+#endif
 	} @catch (id e) {
 		[self release];
 		@throw e;
@@ -352,6 +654,9 @@ normalizedKey(OFString *key)
 	[_path release];
 	[_headers release];
 	[_requestBody release];
+#ifdef OF_HAVE_THREADS
+	[_thread release];
+#endif
 
 	[super dealloc];
 }
@@ -381,55 +686,49 @@ normalizedKey(OFString *key)
 
 - (bool)parseProlog: (OFString *)line
 {
-	OFString *method;
-	OFMutableString *path;
-	size_t pos;
-
-	@try {
-		OFString *version = [line
-		    substringWithRange: OFMakeRange(line.length - 9, 9)];
-		OFUnichar tmp;
+	const char *UTF8String = line.UTF8String;
+	size_t length = line.UTF8StringLength;
+	const char *space, *path;
+	size_t methodLength, pathLength;
+	char minorVersion;
 
-		if (![version hasPrefix: @" HTTP/1."])
-			return [self sendErrorAndClose: 505];
+	if (length < 9)
+		return [self sendErrorAndClose: 400];
 
-		tmp = [version characterAtIndex: 8];
-		if (tmp < '0' || tmp > '9')
-			return [self sendErrorAndClose: 400];
+	if (memcmp(UTF8String + length - 9, " HTTP/1.", 8) != 0)
+		return [self sendErrorAndClose: 505];
 
-		_HTTPMinorVersion = (uint8_t)(tmp - '0');
-	} @catch (OFOutOfRangeException *e) {
+	minorVersion = UTF8String[length - 1];
+	if (minorVersion < '0' || minorVersion > '9')
 		return [self sendErrorAndClose: 400];
-	}
 
-	pos = [line rangeOfString: @" "].location;
-	if (pos == OFNotFound)
+	_HTTPMinorVersion = (uint8_t)(minorVersion - '0');
+
+	if ((space = memchr(UTF8String, ' ', length)) == NULL)
 		return [self sendErrorAndClose: 400];
 
-	method = [line substringToIndex: pos];
-	@try {
-		_method = OFHTTPRequestMethodParseString(method);
-	} @catch (OFInvalidArgumentException *e) {
+	methodLength = space - UTF8String;
+	if (!parseMethod(UTF8String, methodLength, &_method))
 		return [self sendErrorAndClose: 405];
-	}
 
-	@try {
-		OFRange range = OFMakeRange(pos + 1, line.length - pos - 10);
-
-		path = [[[line substringWithRange:
-		    range] mutableCopy] autorelease];
-	} @catch (OFOutOfRangeException *e) {
+	if (methodLength + 10 > length)
 		return [self sendErrorAndClose: 400];
-	}
 
-	[path deleteEnclosingWhitespaces];
-	[path makeImmutable];
+	path = space + 1;
+	pathLength = length - methodLength - 10;
+
+	while (pathLength > 0 && OFASCIIIsSpace(*path)) {
+		path++;
+		pathLength--;
+	}
+	while (pathLength > 0 && OFASCIIIsSpace(path[pathLength - 1]))
+		pathLength--;
 
-	if (![path hasPrefix: @"/"])
+	if (pathLength == 0 || *path != '/')
 		return [self sendErrorAndClose: 400];
 
 	_headers = [[OFMutableDictionary alloc] init];
-	_path = [path copy];
+	_path = [[OFString alloc] initWithUTF8String: path length: pathLength];
 	_state = stateParsingHeaders;
 
 	return true;
@@ -437,15 +736,20 @@ normalizedKey(OFString *key)
 
 - (bool)parseHeaders: (OFString *)line
 {
+	const char *UTF8String = line.UTF8String;
+	size_t length = line.UTF8StringLength;
+	const char *colon, *valueString;
+	size_t keyLength, valueLength;
 	OFString *key, *value, *old;
 	size_t pos;
 
-	if (line.length == 0) {
+	if (length == 0) {
 		bool chunked = [[_headers objectForKey: @"Transfer-Encoding"]
 		    isEqual: @"chunked"];
 		OFString *contentLengthString =
 		    [_headers objectForKey: @"Content-Length"];
 		unsigned long long contentLength = 0;
+		OFString *connection;
 
 		if (contentLengthString != nil) {
 			if (chunked || contentLengthString.length == 0)
@@ -472,21 +776,46 @@ normalizedKey(OFString *key)
 			_timer = nil;
 		}
 
+		connection = [_headers objectForKey: @"Connection"];
+		if (_HTTPMinorVersion > 0)
+			_keepAlive = (connection == nil || [connection
+			    caseInsensitiveCompare: @"close"] != OFOrderedSame);
+		else
+			_keepAlive = (connection != nil && [connection
+			    caseInsensitiveCompare: @"keep-alive"] ==
+			    OFOrderedSame);
+
 		_state = stateSendResponse;
 		[self createResponse];
 
 		return false;
 	}
 
-	pos = [line rangeOfString: @":"].location;
-	if (pos == OFNotFound)
+	/*
+	 * A line starting with whitespace continues the previous header. This
+	 * is obsolete and RFC 9112 allows rejecting it, which avoids ambiguity
+	 * with intermediaries that handle it differently.
+	 */
+	if (OFASCIIIsSpace(UTF8String[0]))
+		return [self sendErrorAndClose: 400];
+
+	if ((colon = memchr(UTF8String, ':', length)) == NULL)
 		return [self sendErrorAndClose: 400];
 
-	key = [line substringToIndex: pos];
-	value = [line substringFromIndex: pos + 1];
+	keyLength = colon - UTF8String;
+	while (keyLength > 0 && OFASCIIIsSpace(UTF8String[keyLength - 1]))
+		keyLength--;
 
-	key = normalizedKey(key.stringByDeletingTrailingWhitespaces);
-	value = value.stringByDeletingLeadingWhitespaces;
+	valueString = colon + 1;
+	valueLength = length - (size_t)(valueString - UTF8String);
+	while (valueLength > 0 && OFASCIIIsSpace(*valueString)) {
+		valueString++;
+		valueLength--;
+	}
+
+	key = normalizedKey(UTF8String, keyLength);
+	value = [OFString stringWithUTF8String: valueString
+					length: valueLength];
 
 	old = [_headers objectForKey: key];
 	if (old != nil)
@@ -538,7 +867,7 @@ normalizedKey(OFString *key)
 - (bool)sendErrorAndClose: (short)statusCode
 {
 	OFString *date = [[OFDate date]
-	    dateStringWithFormat: @"%a, %d %b %Y %H:%M:%S GMT"];
+	    dateStringWithFormat: dateFormat];
 	[_stream writeFormat: @"HTTP/1.1 %hd %@\r\n"
 			      @"Date: %@\r\n"
 			      @"Server: %@\r\n"
@@ -597,6 +926,20 @@ normalizedKey(OFString *key)
 
 	[IRI makeImmutable];
 
+	if (_requestBody == nil && (_method == OFHTTPRequestMethodGet ||
+	    _method == OFHTTPRequestMethodHead)) {
+		OFHTTPServerCachedResponse *cachedResponse = [_server
+		    of_cachedResponseForIRIString: IRI.string
+				   acceptEncoding: [_headers objectForKey:
+						       @"Accept-Encoding"]];
+
+		if (cachedResponse != nil) {
+			[self sendCachedResponse: cachedResponse];
+			objc_autoreleasePoolPop(pool);
+			return;
+		}
+	}
+
 	request = [OFHTTPRequest requestWithIRI: IRI];
 	request.method = _method;
 	request.protocolVersion =
@@ -611,9 +954,8 @@ normalizedKey(OFString *key)
 		request.remoteAddress = ((OFTCPSocket *)_stream).remoteAddress;
 
 	response = [[[OFHTTPServerResponse alloc]
-	    initWithStream: _stream
-		    server: _server
-		   request: request] autorelease];
+	    initWithConnection: self
+		       request: request] autorelease];
 
 	[_server.delegate server: _server
 	       didReceiveRequest: request
@@ -622,6 +964,115 @@ normalizedKey(OFString *key)
 
 	objc_autoreleasePoolPop(pool);
 }
+
+- (void)sendCachedResponse: (OFHTTPServerCachedResponse *)cachedResponse
+{
+	OFString *date = [[OFDate date] dateStringWithFormat: dateFormat];
+	bool notModified = false, buffersWrites;
+
+	if (cachedResponse->_statusCode == 200) {
+		OFString *ifNoneMatch =
+		    [_headers objectForKey: @"If-None-Match"];
+		OFString *ifModifiedSince =
+		    [_headers objectForKey: @"If-Modified-Since"];
+
+		if (ifNoneMatch != nil)
+			notModified = ETagMatches(ifNoneMatch,
+			    cachedResponse->_ETag);
+		else if (ifModifiedSince != nil &&
+		    cachedResponse->_lastModified != nil) {
+			@try {
+				OFDate *since = [OFDate
+				    dateWithDateString: ifModifiedSince
+						format: dateFormat];
+
+				notModified = ([cachedResponse->_lastModified
+				    compare: since] != OFOrderedDescending);
+			} @catch (OFInvalidFormatException *e) {
+			}
+		}
+	}
+
+	/* Coalesce the head and the body into as few writes as possible. */
+	buffersWrites = _stream.buffersWrites;
+	_stream.buffersWrites = true;
+	@try {
+		[_stream writeString: (_HTTPMinorVersion == 0
+		    ? @"HTTP/1.0" : @"HTTP/1.1")];
+
+		if (notModified)
+			[_stream writeData: cachedResponse->_notModifiedHead];
+		else
+			[_stream writeData: cachedResponse->_head];
+
+		[_stream writeFormat: @"Date: %@\r\n", date];
+
+		if (!_keepAlive && _HTTPMinorVersion > 0)
+			[_stream writeString: @"Connection: close\r\n"];
+		else if (_keepAlive && _HTTPMinorVersion == 0)
+			[_stream writeString: @"Connection: keep-alive\r\n"];
+
+		[_stream writeString: @"\r\n"];
+
+		if (!notModified && _method != OFHTTPRequestMethodHead)
+			[_stream writeData: cachedResponse->_body];
+
+		[_stream flushWriteBuffer];
+	} @finally {
+		_stream.buffersWrites = buffersWrites;
+	}
+
+	if (_keepAlive)
+		[self awaitNextRequest];
+}
+
+- (void)awaitNextRequest
+{
+	[_host release];
+	_host = nil;
+	[_path release];
+	_path = nil;
+	[_headers release];
+	_headers = nil;
+	[_requestBody release];
+	_requestBody = nil;
+
+	_port = 0;
+	_contentLength = 0;
+	_keepAlive = false;
+	_state = stateAwaitingProlog;
+
+	[_timer invalidate];
+	[_timer release];
+	_timer = nil;
+	_timer = [[OFTimer
+	    scheduledTimerWithTimeInterval: 10
+				    target: _stream
+				  selector: @selector(cancelAsyncRequests)
+				   repeats: false] retain];
+
+	/*
+	 * Any pipelined request that was already received is still in the
+	 * stream's read buffer and will be processed right away.
+	 */
+	_stream.delegate = self;
+	[_stream asyncReadLine];
+}
+@end
+
+@implementation OFHTTPServerCachedResponse
+- (void)dealloc
+{
+	[_IRIString release];
+	[_contentEncoding release];
+	[_ETag release];
+	[_head release];
+	[_notModifiedHead release];
+	[_body release];
+	[_lastModified release];
+
+	[super dealloc];
+}
 @end
 
 @implementation OFHTTPServerRequestBodyStream
@@ -814,6 +1265,7 @@ normalizedKey(OFString *key)
 @implementation OFHTTPServer
 @synthesize delegate = _delegate, usesTLS = _usesTLS;
 @synthesize certificateChain = _certificateChain, name = _name;
+@synthesize responseCacheSize = _responseCacheSize;
 
 + (instancetype)server
 {
@@ -824,11 +1276,21 @@ normalizedKey(OFString *key)
 {
 	self = [super init];
 
-	_name = @"OFHTTPServer (ObjFW's HTTP server class "
-	    @"<https://objfw.nil.im/>)";
+	@try {
+		_name = @"OFHTTPServer (ObjFW's HTTP server class "
+		    @"<https://objfw.nil.im/>)";
 #ifdef OF_HAVE_THREADS
-	_numberOfThreads = 1;
+		_numberOfThreads = 1;
 #endif
+		_responseCache = [[OFMutableDictionary alloc] init];
+		_responseCacheList = [[OFList alloc] init];
+#ifdef OF_HAVE_THREADS
+		_responseCacheMutex = [[OFMutex alloc] init];
+#endif
+	} @catch (id e) {
+		[self release];
+		@throw e;
+	}
 
 	return self;
 }
@@ -840,6 +1302,11 @@ normalizedKey(OFString *key)
 	[_host release];
 	[_listeningSocket release];
 	[_name release];
+	[_responseCache release];
+	[_responseCacheList release];
+#ifdef OF_HAVE_THREADS
+	[_responseCacheMutex release];
+#endif
 
 	[super dealloc];
 }
@@ -949,6 +1416,254 @@ normalizedKey(OFString *key)
 #endif
 }
 
+- (void)setResponseCacheSize: (size_t)responseCacheSize
+{
+#ifdef OF_HAVE_THREADS
+	[_responseCacheMutex lock];
+	@try {
+#endif
+		_responseCacheSize = responseCacheSize;
+		evictCachedResponses(self);
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[_responseCacheMutex unlock];
+	}
+#endif
+}
+
+- (void)cacheResponseWithStatusCode: (short)statusCode
+			    headers: (OFDictionary *)headers
+			       body: (OFData *)body
+			     forIRI: (OFIRI *)IRI
+{
+	void *pool = objc_autoreleasePoolPush();
+	OFMutableDictionary *allHeaders;
+	OFString *ETag, *lastModified, *contentEncoding, *vary;
+	OFMutableString *head;
+	OFEnumerator *keyEnumerator, *valueEnumerator;
+	OFString *key, *value;
+	OFHTTPServerCachedResponse *cachedResponse;
+
+	if (body.itemSize != 1)
+		@throw [OFInvalidArgumentException exception];
+
+	if (headers != nil)
+		allHeaders = [[headers mutableCopy] autorelease];
+	else
+		allHeaders = [OFMutableDictionary dictionary];
+
+	/* These are added when the response is sent. */
+	[allHeaders removeObjectForKey: @"Date"];
+	[allHeaders removeObjectForKey: @"Connection"];
+	[allHeaders removeObjectForKey: @"Transfer-Encoding"];
+
+	[allHeaders setObject: [OFString stringWithFormat: @"%zu", body.count]
+		       forKey: @"Content-Length"];
+
+	if ((ETag = [allHeaders objectForKey: @"ETag"]) == nil) {
+		uint32_t CRC32 = ~_OFCRC32(~0, body.items, body.count);
+
+		ETag = [OFString stringWithFormat: @"\"%08" PRIX32 "-%zX\"",
+						   CRC32, body.count];
+		[allHeaders setObject: ETag forKey: @"ETag"];
+	}
+
+	if ((contentEncoding =
+	    [allHeaders objectForKey: @"Content-Encoding"]) != nil)
+		contentEncoding = contentEncoding
+		    .stringByDeletingEnclosingWhitespaces.lowercaseString;
+	else
+		contentEncoding = @"identity";
+
+	/*
+	 * Which variant is sent depends on Accept-Encoding, so this needs to
+	 * be in Vary for every variant, including the identity one.
+	 */
+	if ((vary = [allHeaders objectForKey: @"Vary"]) == nil)
+		[allHeaders setObject: @"Accept-Encoding" forKey: @"Vary"];
+	else if (!varyIncludesAcceptEncoding(vary))
+		[allHeaders setObject: [vary stringByAppendingString:
+					   @", Accept-Encoding"]
+			       forKey: @"Vary"];
+
+	if ([allHeaders objectForKey: @"Server"] == nil && _name != nil)
+		[allHeaders setObject: _name forKey: @"Server"];
+
+	head = [OFMutableString stringWithFormat: @" %hd %@\r\n",
+	    statusCode, OFHTTPStatusCodeString(statusCode)];
+
+	keyEnumerator = [allHeaders keyEnumerator];
+	valueEnumerator = [allHeaders objectEnumerator];
+	while ((key = [keyEnumerator nextObject]) != nil &&
+	    (value = [valueEnumerator nextObject]) != nil)
+		[head appendFormat: @"%@: %@\r\n", key, value];
+
+	cachedResponse = [[[OFHTTPServerCachedResponse alloc] init]
+	    autorelease];
+	cachedResponse->_IRIString = [IRI.string copy];
+	cachedResponse->_contentEncoding = [contentEncoding copy];
+	cachedResponse->_ETag = [ETag copy];
+	cachedResponse->_statusCode = statusCode;
+	cachedResponse->_head = [[OFData alloc]
+	    initWithItems: head.UTF8String
+		    count: head.UTF8StringLength];
+	cachedResponse->_body = [body copy];
+	cachedResponse->_size = cachedResponse->_head.count + body.count;
+
+	if (statusCode == 200) {
+		OFMutableString *notModifiedHead = [OFMutableString
+		    stringWithFormat: @" 304 %@\r\n",
+				      OFHTTPStatusCodeString(304)];
+
+		for (size_t i = 0; i < sizeof(notModifiedHeaders) /
+		    sizeof(*notModifiedHeaders); i++)
+			if ((value = [allHeaders objectForKey:
+			    notModifiedHeaders[i]]) != nil)
+				[notModifiedHead appendFormat: @"%@: %@\r\n",
+				    notModifiedHeaders[i], value];
+
+		cachedResponse->_notModifiedHead = [[OFData alloc]
+		    initWithItems: notModifiedHead.UTF8String
+			    count: notModifiedHead.UTF8StringLength];
+		cachedResponse->_size += cachedResponse->_notModifiedHead.count;
+	}
+
+	lastModified = [allHeaders objectForKey: @"Last-Modified"];
+	if (lastModified != nil) {
+		@try {
+			cachedResponse->_lastModified = [[OFDate alloc]
+			    initWithDateString: lastModified
+					format: dateFormat];
+		} @catch (OFInvalidFormatException *e) {
+		}
+	}
+
+#ifdef OF_HAVE_THREADS
+	[_responseCacheMutex lock];
+	@try {
+#endif
+		OFMutableDictionary *variants =
+		    [_responseCache objectForKey: cachedResponse->_IRIString];
+		OFHTTPServerCachedResponse *old =
+		    [variants objectForKey: contentEncoding];
+
+		if (old != nil)
+			removeCachedResponse(self, old);
+
+		if (cachedResponse->_size <= _responseCacheSize) {
+			if ((variants = [_responseCache objectForKey:
+			    cachedResponse->_IRIString]) == nil) {
+				variants = [OFMutableDictionary dictionary];
+				[_responseCache
+				    setObject: variants
+				       forKey: cachedResponse->_IRIString];
+			}
+
+			[variants setObject: cachedResponse
+				     forKey: contentEncoding];
+			cachedResponse->_listItem =
+			    [_responseCacheList prependObject: cachedResponse];
+			_responseCacheUsage += cachedResponse->_size;
+
+			evictCachedResponses(self);
+		}
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[_responseCacheMutex unlock];
+	}
+#endif
+
+	objc_autoreleasePoolPop(pool);
+}
+
+- (OFHTTPServerCachedResponse *)
+    of_cachedResponseForIRIString: (OFString *)IRIString
+		   acceptEncoding: (OFString *)acceptEncoding
+{
+	OFHTTPServerCachedResponse *cachedResponse = nil;
+
+#ifdef OF_HAVE_THREADS
+	[_responseCacheMutex lock];
+	@try {
+#endif
+		OFDictionary *variants;
+
+		if (_responseCacheSize == 0)
+			return nil;
+
+		variants = [_responseCache objectForKey: IRIString];
+		if (variants == nil)
+			return nil;
+
+		if (acceptEncoding != nil && (variants.count > 1 ||
+		    [variants objectForKey: @"identity"] == nil)) {
+			for (OFString *element in [acceptEncoding
+			    componentsSeparatedByString: @","]) {
+				OFString *encoding =
+				    acceptedEncoding(element);
+
+				if (encoding != nil && (cachedResponse =
+				    [variants objectForKey: encoding]) != nil)
+					break;
+			}
+		}
+
+		if (cachedResponse == nil)
+			cachedResponse = [variants objectForKey: @"identity"];
+
+		if (cachedResponse != nil) {
+			/* Most recently used responses are at the front. */
+			[[cachedResponse retain] autorelease];
+			[_responseCacheList
+			    removeListItem: cachedResponse->_listItem];
+			cachedResponse->_listItem =
+			    [_responseCacheList prependObject: cachedResponse];
+		}
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[_responseCacheMutex unlock];
+	}
+#endif
+
+	return cachedResponse;
+}
+
+- (void)removeCachedResponsesForIRI: (OFIRI *)IRI
+{
+	void *pool = objc_autoreleasePoolPush();
+
+#ifdef OF_HAVE_THREADS
+	[_responseCacheMutex lock];
+	@try {
+#endif
+		for (OFHTTPServerCachedResponse *cachedResponse in
+		    [[_responseCache objectForKey: IRI.string] allObjects])
+			removeCachedResponse(self, cachedResponse);
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[_responseCacheMutex unlock];
+	}
+#endif
+
+	objc_autoreleasePoolPop(pool);
+}
+
+- (void)removeAllCachedResponses
+{
+#ifdef OF_HAVE_THREADS
+	[_responseCacheMutex lock];
+	@try {
+#endif
+		[_responseCache removeAllObjects];
+		[_responseCacheList removeAllObjects];
+		_responseCacheUsage = 0;
+#ifdef OF_HAVE_THREADS
+	} @finally {
+		[_responseCacheMutex unlock];
+	}
+#endif
+}
+
 - (void)of_startTLSWithSocket: (OFStreamSocket *)sock
 {
 	OFTLSStream *TLSStream = [OFTLSStream streamWithStream: sock];
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#import "OFKernelEventObserver.h"
+
+OF_ASSUME_NONNULL_BEGIN
+
+struct _OFIOUringFDState;
+
+@interface OFIOUringKernelEventObserver: OFKernelEventObserver
+{
+	int _ringFD;
+	void *_ringMemory, *_SQEMemory;
+	size_t _ringMemorySize, _SQEMemorySize;
+	uint32_t *_SQHead, *_SQTail, *_SQArray;
+	uint32_t _SQMask, _SQEntries;
+	void *_SQEs;
+	uint32_t *_CQHead, *_CQTail;
+	uint32_t _CQMask;
+	void *_CQEs;
+	unsigned int _pendingSubmissions;
+	struct _OFIOUringFDState *_FDStates;
+	int _maxFD;
+}
+
+/**
+ * @brief Returns whether io_uring is supported by the running kernel.
+ *
+ * io_uring might be unavailable even if ObjFW was built with support for it,
+ * e.g. because the kernel is too old or io_uring has been disabled.
+ */
++ (bool)isSupported;
+@end
+
+OF_ASSUME_NONNULL_END
@@ -0,0 +1,523 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+
+#include "unistd_wrapper.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#import "OFIOUringKernelEventObserver.h"
+#import "OFAtomic.h"
+#import "OFOnce.h"
+
+#import "OFInitializationFailedException.h"
+#import "OFObserveKernelEventsFailedException.h"
+#import "OFOutOfRangeException.h"
+
+/*
+ * Instead of registering interest with one system call and waiting with
+ * another like epoll does, all changes are queued as (one-shot) poll requests
+ * in the submission ring. They are then submitted by the same io_uring_enter()
+ * that waits for completions. Adding an object, waiting for it and re-arming
+ * it after it became ready thus costs a single system call per run loop
+ * iteration, no matter how many objects changed.
+ *
+ * Only readiness is observed this way. Reading and writing are still done by
+ * the objects themselves once they have been reported as ready, so this is a
+ * drop-in replacement for epoll and does not use completion-based I/O.
+ *
+ * The user data of a poll request is the file descriptor in the lower 32 bits
+ * and a generation in the upper bits, so that completions of requests that
+ * have been removed or replaced in the meantime can be detected and ignored.
+ */
+
+#define ringSize 256
+#define eventListSize 64
+
+#define userDataInternal ((uint64_t)1 << 63)
+#define userDataCancel (userDataInternal | 0)
+#define userDataRemove (userDataInternal | 1)
+#define generationMask 0x7FFFFFFF
+
+struct _OFIOUringFDState {
+	id __unsafe_unretained object;
+	uint32_t generation;
+	short events, armedEvents;
+};
+
+static bool supported = false;
+
+static int
+ringSetup(unsigned int entries, struct io_uring_params *params)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int
+ringEnter(int ringFD, unsigned int toSubmit, unsigned int minComplete,
+    unsigned int flags, void *arg, size_t argSize)
+{
+	return (int)syscall(__NR_io_uring_enter, ringFD, toSubmit, minComplete,
+	    flags, arg, argSize);
+}
+
+static void
+checkSupport(void)
+{
+	struct io_uring_params params;
+	int ringFD;
+
+	memset(&params, 0, sizeof(params));
+
+	if ((ringFD = ringSetup(1, &params)) == -1)
+		return;
+
+	supported = ((params.features & IORING_FEAT_SINGLE_MMAP) &&
+	    (params.features & IORING_FEAT_NODROP) &&
+	    (params.features & IORING_FEAT_EXT_ARG));
+
+	close(ringFD);
+}
+
+static OF_INLINE uint64_t
+userDataForFD(int fd, uint32_t generation)
+{
+	return ((uint64_t)(generation & generationMask) << 32) | (uint32_t)fd;
+}
+
+static void
+submit(OFIOUringKernelEventObserver *self)
+{
+	while (self->_pendingSubmissions > 0) {
+		int ret = ringEnter(self->_ringFD, self->_pendingSubmissions,
+		    0, 0, NULL, 0);
+
+		if (ret < 0) {
+			if (errno == EINTR || errno == EAGAIN ||
+			    errno == EBUSY)
+				continue;
+
+			@throw [OFObserveKernelEventsFailedException
+			    exceptionWithObserver: self
+					    errNo: errno];
+		}
+
+		if (ret == 0)
+			break;
+
+		self->_pendingSubmissions -= ret;
+	}
+}
+
+static struct io_uring_sqe *
+nextSQE(OFIOUringKernelEventObserver *self)
+{
+	uint32_t tail = *self->_SQTail, head;
+	struct io_uring_sqe *SQE;
+
+	head = *(volatile uint32_t *)self->_SQHead;
+	OFAcquireMemoryBarrier();
+
+	if (tail - head >= self->_SQEntries) {
+		submit(self);
+
+		head = *(volatile uint32_t *)self->_SQHead;
+		OFAcquireMemoryBarrier();
+
+		if (tail - head >= self->_SQEntries)
+			@throw [OFObserveKernelEventsFailedException
+			    exceptionWithObserver: self
+					    errNo: EBUSY];
+	}
+
+	SQE = (struct io_uring_sqe *)self->_SQEs + (tail & self->_SQMask);
+	memset(SQE, 0, sizeof(*SQE));
+	self->_SQArray[tail & self->_SQMask] = tail & self->_SQMask;
+
+	return SQE;
+}
+
+static void
+commitSQE(OFIOUringKernelEventObserver *self)
+{
+	OFReleaseMemoryBarrier();
+	*(volatile uint32_t *)self->_SQTail = *self->_SQTail + 1;
+	self->_pendingSubmissions++;
+}
+
+static void
+queuePollAdd(OFIOUringKernelEventObserver *self, int fd, short events,
+    uint64_t userData)
+{
+	struct io_uring_sqe *SQE = nextSQE(self);
+
+	SQE->opcode = IORING_OP_POLL_ADD;
+	SQE->fd = fd;
+	SQE->poll32_events = (uint16_t)events;
+	SQE->user_data = userData;
+
+	commitSQE(self);
+}
+
+static void
+queuePollRemove(OFIOUringKernelEventObserver *self, uint64_t userData)
+{
+	struct io_uring_sqe *SQE = nextSQE(self);
+
+	SQE->opcode = IORING_OP_POLL_REMOVE;
+	SQE->fd = -1;
+	SQE->addr = userData;
+	SQE->user_data = userDataRemove;
+
+	commitSQE(self);
+}
+
+static void
+updateFD(OFIOUringKernelEventObserver *self, int fd)
+{
+	struct _OFIOUringFDState *state = &self->_FDStates[fd];
+
+	if (state->armedEvents == state->events)
+		return;
+
+	if (state->armedEvents != 0) {
+		queuePollRemove(self, userDataForFD(fd, state->generation));
+		state->generation++;
+		state->armedEvents = 0;
+	}
+
+	if (state->events != 0) {
+		queuePollAdd(self, fd, state->events,
+		    userDataForFD(fd, state->generation));
+		state->armedEvents = state->events;
+	}
+}
+
+static void
+addObject(OFIOUringKernelEventObserver *self, id object, int fd, short events)
+{
+	if (fd < 0)
+		@throw [OFObserveKernelEventsFailedException
+		    exceptionWithObserver: self
+				    errNo: EBADF];
+
+	if (fd > self->_maxFD) {
+		self->_FDStates = OFResizeMemory(self->_FDStates,
+		    (size_t)fd + 1, sizeof(struct _OFIOUringFDState));
+		memset(self->_FDStates + self->_maxFD + 1, 0,
+		    (size_t)(fd - self->_maxFD) *
+		    sizeof(struct _OFIOUringFDState));
+		self->_maxFD = fd;
+	}
+
+	self->_FDStates[fd].object = object;
+	self->_FDStates[fd].events |= events;
+
+	updateFD(self, fd);
+}
+
+static void
+removeObject(OFIOUringKernelEventObserver *self, int fd, short events)
+{
+	if (fd < 0)
+		@throw [OFObserveKernelEventsFailedException
+		    exceptionWithObserver: self
+				    errNo: EBADF];
+
+	if (fd > self->_maxFD)
+		return;
+
+	self->_FDStates[fd].events &= ~events;
+
+	updateFD(self, fd);
+}
+
+@implementation OFIOUringKernelEventObserver
++ (bool)isSupported
+{
+	static OFOnceControl onceControl = OFOnceControlInitValue;
+	OFOnce(&onceControl, checkSupport);
+
+	return supported;
+}
+
+- (instancetype)initWithRunLoopMode: (OFRunLoopMode)runLoopMode
+{
+	self = [super initWithRunLoopMode: runLoopMode];
+
+	_ringFD = -1;
+	_maxFD = -1;
+
+	@try {
+		struct io_uring_params params;
+		size_t SQRingSize, CQRingSize;
+		char *ring;
+
+		memset(&params, 0, sizeof(params));
+
+		if ((_ringFD = ringSetup(ringSize, &params)) == -1)
+			@throw [OFInitializationFailedException
+			    exceptionWithClass: self.class];
+
+		if (!(params.features & IORING_FEAT_SINGLE_MMAP) ||
+		    !(params.features & IORING_FEAT_NODROP) ||
+		    !(params.features & IORING_FEAT_EXT_ARG))
+			@throw [OFInitializationFailedException
+			    exceptionWithClass: self.class];
+
+		SQRingSize = params.sq_off.array +
+		    params.sq_entries * sizeof(uint32_t);
+		CQRingSize = params.cq_off.cqes +
+		    params.cq_entries * sizeof(struct io_uring_cqe);
+		_ringMemorySize = (SQRingSize > CQRingSize
+		    ? SQRingSize : CQRingSize);
+
+		_ringMemory = mmap(NULL, _ringMemorySize,
+		    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFD,
+		    IORING_OFF_SQ_RING);
+		if (_ringMemory == MAP_FAILED) {
+			_ringMemory = NULL;
+			@throw [OFInitializationFailedException
+			    exceptionWithClass: self.class];
+		}
+
+		_SQEMemorySize = params.sq_entries *
+		    sizeof(struct io_uring_sqe);
+		_SQEMemory = mmap(NULL, _SQEMemorySize,
+		    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFD,
+		    IORING_OFF_SQES);
+		if (_SQEMemory == MAP_FAILED) {
+			_SQEMemory = NULL;
+			@throw [OFInitializationFailedException
+			    exceptionWithClass: self.class];
+		}
+
+		ring = _ringMemory;
+		_SQHead = (uint32_t *)(void *)(ring + params.sq_off.head);
+		_SQTail = (uint32_t *)(void *)(ring + params.sq_off.tail);
+		_SQArray = (uint32_t *)(void *)(ring + params.sq_off.array);
+		_SQMask = *(uint32_t *)(void *)(ring + params.sq_off.ring_mask);
+		_SQEntries =
+		    *(uint32_t *)(void *)(ring + params.sq_off.ring_entries);
+		_SQEs = _SQEMemory;
+		_CQHead = (uint32_t *)(void *)(ring + params.cq_off.head);
+		_CQTail = (uint32_t *)(void *)(ring + params.cq_off.tail);
+		_CQMask = *(uint32_t *)(void *)(ring + params.cq_off.ring_mask);
+		_CQEs = ring + params.cq_off.cqes;
+
+		queuePollAdd(self, _cancelFD[0], POLLIN, userDataCancel);
+	} @catch (id e) {
+		[self release];
+		@throw e;
+	}
+
+	return self;
+}
+
+- (void)dealloc
+{
+	if (_SQEMemory != NULL)
+		munmap(_SQEMemory, _SQEMemorySize);
+	if (_ringMemory != NULL)
+		munmap(_ringMemory, _ringMemorySize);
+	if (_ringFD != -1)
+		close(_ringFD);
+
+	OFFreeMemory(_FDStates);
+
+	[super dealloc];
+}
+
+- (void)addObjectForReading: (id <OFReadyForReadingObserving>)object
+{
+	addObject(self, object, object.fileDescriptorForReading, POLLIN);
+
+	[super addObjectForReading: object];
+}
+
+- (void)addObjectForWriting: (id <OFReadyForWritingObserving>)object
+{
+	addObject(self, object, object.fileDescriptorForWriting, POLLOUT);
+
+	[super addObjectForWriting: object];
+}
+
+- (void)removeObjectForReading: (id <OFReadyForReadingObserving>)object
+{
+	removeObject(self, object.fileDescriptorForReading, POLLIN);
+
+	[super removeObjectForReading: object];
+}
+
+- (void)removeObjectForWriting: (id <OFReadyForWritingObserving>)object
+{
+	removeObject(self, object.fileDescriptorForWriting, POLLOUT);
+
+	[super removeObjectForWriting: object];
+}
+
+- (void)observeForTimeInterval: (OFTimeInterval)timeInterval
+{
+	struct io_uring_getevents_arg arg;
+	struct __kernel_timespec timeout;
+	struct io_uring_cqe eventList[eventListSize];
+	size_t events = 0;
+	uint32_t head, tail;
+	int ret;
+
+	if ([self processReadBuffers])
+		return;
+
+	memset(&arg, 0, sizeof(arg));
+	arg.sigmask_sz = _NSIG / 8;
+
+	if (timeInterval != -1) {
+		timeout.tv_sec = (long long)timeInterval;
+		timeout.tv_nsec = (long long)
+		    ((timeInterval - timeout.tv_sec) * 1000000000);
+		arg.ts = (uint64_t)(uintptr_t)&timeout;
+	}
+
+	ret = ringEnter(_ringFD, _pendingSubmissions, 1,
+	    IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+
+	if (ret >= 0)
+		_pendingSubmissions -= ret;
+	/* ETIME means the timeout expired, EBUSY that the CQ ring is full. */
+	else if (errno != ETIME && errno != EBUSY)
+		@throw [OFObserveKernelEventsFailedException
+		    exceptionWithObserver: self
+				    errNo: errno];
+
+	/*
+	 * Copy the completions and release the ring before calling into the
+	 * delegate, as the delegate might add and remove objects, which queues
+	 * new submissions.
+	 */
+	head = *_CQHead;
+	tail = *(volatile uint32_t *)_CQTail;
+	OFAcquireMemoryBarrier();
+
+	while (head != tail && events < eventListSize)
+		eventList[events++] =
+		    ((struct io_uring_cqe *)_CQEs)[head++ & _CQMask];
+
+	OFReleaseMemoryBarrier();
+	*(volatile uint32_t *)_CQHead = head;
+
+	for (size_t i = 0; i < events; i++) {
+		uint64_t userData = eventList[i].user_data;
+		int result = eventList[i].res;
+		struct _OFIOUringFDState *state;
+		int fd;
+
+		if (userData == userDataCancel) {
+			char buffer;
+
+			/*
+			 * If the request failed, it is only re-armed. If there
+			 * is something to read, it will complete right away.
+			 */
+			if (result >= 0)
+				OFEnsure(read(_cancelFD[0], &buffer, 1) == 1);
+
+			queuePollAdd(self, _cancelFD[0], POLLIN,
+			    userDataCancel);
+
+			continue;
+		}
+
+		if (userData & userDataInternal)
+			continue;
+
+		fd = (int)(uint32_t)userData;
+		if (fd > _maxFD)
+			continue;
+
+		state = &_FDStates[fd];
+		if (state->armedEvents == 0 ||
+		    (state->generation & generationMask) != (userData >> 32))
+			continue;
+
+		state->armedEvents = 0;
+
+		/*
+		 * Poll requests are one-shot, so re-arm it before calling the
+		 * delegate. It is only submitted with the next wait, at which
+		 * point it completes right away if the object is still ready,
+		 * giving the same level-triggered semantics as epoll.
+		 *
+		 * A request that was canceled or interrupted without the
+		 * object becoming ready (e.g. -ECANCELED when the kernel
+		 * cancels it) is only re-armed.
+		 *
+		 * If the request failed for any other reason (e.g. because the
+		 * file descriptor was closed before it got submitted), it is
+		 * not re-armed, but the object is reported as ready so that
+		 * the error is noticed when it is read from or written to.
+		 */
+		if (result == -ECANCELED || result == -EINTR ||
+		    result == -EAGAIN) {
+			updateFD(self, fd);
+			continue;
+		}
+
+		if (result < 0)
+			result = POLLIN | POLLOUT | POLLERR;
+		else
+			updateFD(self, fd);
+
+		/*
+		 * Always index _FDStates again, as the delegate might have
+		 * caused it to be resized.
+		 */
+		if ((result & (POLLIN | POLLERR | POLLHUP)) &&
+		    (_FDStates[fd].events & POLLIN)) {
+			void *pool = objc_autoreleasePoolPush();
+
+			if ([_delegate respondsToSelector:
+			    @selector(objectIsReadyForReading:)])
+				[_delegate objectIsReadyForReading:
+				    _FDStates[fd].object];
+
+			objc_autoreleasePoolPop(pool);
+		}
+
+		if ((result & (POLLOUT | POLLERR | POLLHUP)) &&
+		    (_FDStates[fd].events & POLLOUT)) {
+			void *pool = objc_autoreleasePoolPush();
+
+			if ([_delegate respondsToSelector:
+			    @selector(objectIsReadyForWriting:)])
+				[_delegate objectIsReadyForWriting:
+				    _FDStates[fd].object];
+
+			objc_autoreleasePoolPop(pool);
+		}
+	}
+}
+@end
@@ -145,5 +145,26 @@
 
 	[super sendBuffer: buffer length: length receiver: &fixedReceiver];
 }
+
+- (void)sendPackets: (const OFDatagramSocketPacket *)packets
+	      count: (size_t)count
+{
+	OFDatagramSocketPacket *fixedPackets =
+	    OFAllocMemory(count, sizeof(*fixedPackets));
+
+	@try {
+		memcpy(fixedPackets, packets, count * sizeof(*fixedPackets));
+
+		for (size_t i = 0; i < count; i++)
+			if (fixedPackets[i].address.family ==
+			    OFSocketAddressFamilyIPX)
+				fixedPackets[i].address.sockaddr.ipx.sipx_type =
+				    _packetType;
+
+		[super sendPackets: fixedPackets count: count];
+	} @finally {
+		OFFreeMemory(fixedPackets);
+	}
+}
 #endif
 @end
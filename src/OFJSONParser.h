@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#import "OFObject.h"
+#import "OFString.h"
+
+OF_ASSUME_NONNULL_BEGIN
+
+@class OFJSONParser;
+@class OFMutableData;
+@class OFStream;
+
+/**
+ * @protocol OFJSONParserDelegate OFJSONParser.h ObjFW/ObjFW.h
+ * @brief A protocol that needs to be implemented by delegates for
+ *	  OFJSONParser.
+ */
+@protocol OFJSONParserDelegate <OFObject>
+@optional
+/**
+ * @brief This callback is called when the JSON parser found the start of a
+ *	  dictionary.
+ * @param parser The parser which found the start of a dictionary
+ */
+- (void)parserDidStartDictionary: (OFJSONParser *)parser;
+
+/**
+ * @brief This callback is called when the JSON parser found the end of a
+ *	  dictionary.
+ * @param parser The parser which found the end of a dictionary
+ */
+- (void)parserDidEndDictionary: (OFJSONParser *)parser;
+
+/**
+ * @brief This callback is called when the JSON parser found the start of an
+ *	  array.
+ * @param parser The parser which found the start of an array
+ */
+- (void)parserDidStartArray: (OFJSONParser *)parser;
+
+/**
+ * @brief This callback is called when the JSON parser found the end of an
+ *	  array.
+ * @param parser The parser which found the end of an array
+ */
+- (void)parserDidEndArray: (OFJSONParser *)parser;
+
+/**
+ * @brief This callback is called when the JSON parser found a key in a
+ *	  dictionary.
+ * The value for the key is reported by the next callback.
+ * @param parser The parser which found a key
+ * @param key The key the JSON parser found
+ */
+- (void)parser: (OFJSONParser *)parser foundKey: (OFString *)key;
+
+/**
+ * @brief This callback is called when the JSON parser found a string, number,
+ *	  boolean or null.
+ * @param parser The parser which found a value
+ * @param value The value the JSON parser found. This is an OFString, an
+ *		OFNumber or OFNull.
+ */
+- (void)parser: (OFJSONParser *)parser foundValue: (id)value;
+
+/**
+ * @brief This callback is called when the JSON parser finished a top-level
+ *	  value.
+ * As multiple top-level values separated by whitespace are accepted, this is
+ * called once for every line of newline-delimited JSON.
+ * @param parser The parser which finished a top-level value
+ */
+- (void)parserDidEndDocument: (OFJSONParser *)parser;
+@end
+
+/**
+ * @class OFJSONParser OFJSONParser.h ObjFW/ObjFW.h
+ * @brief An event-based JSON parser.
+ * OFJSONParser is an event-based JSON parser which calls the delegate's
+ * callbacks as soon as it finds something. Input can be passed in chunks that
+ * are split at arbitrary positions, and memory usage only depends on the
+ * nesting depth and the length of the longest string, thus it is suitable for
+ * streams of arbitrary size.
+ *
+ * Unlike @ref OFString#objectByParsingJSON, this only accepts strict JSON and
+ * not JSON5.
+ */
+OF_SUBCLASSING_RESTRICTED
+@interface OFJSONParser: OFObject
+{
+	id <OFJSONParserDelegate> _Nullable _delegate;
+	uint_least8_t _state;
+	size_t _i, _length;
+	const char *_Nullable _data;
+	OFMutableData *_buffer, *_stack;
+	const char *_Nullable _literal;
+	size_t _literalIndex;
+	bool _parsingKey;
+	uint16_t _unicodeEscape, _highSurrogate;
+	uint_least8_t _unicodeEscapeLength;
+	size_t _lineNumber;
+	size_t _depthLimit;
+}
+
+/**
+ * @brief The delegate that is used by the JSON parser.
+ */
+@property OF_NULLABLE_PROPERTY (assign, nonatomic)
+    id <OFJSONParserDelegate> delegate;
+
+/**
+ * @brief The current line number.
+ */
+@property (readonly, nonatomic) size_t lineNumber;
+
+/**
+ * @brief The depth limit for the JSON parser.
+ * If the depth limit is exceeded, an OFInvalidJSONException is thrown.
+ * The default is 32. 0 means unlimited (insecure!).
+ */
+@property (nonatomic) size_t depthLimit;
+
+/**
+ * @brief Creates a new JSON parser.
+ * @return A new, autoreleased OFJSONParser
+ */
++ (instancetype)parser;
+
+/**
+ * @brief Parses the specified buffer with the specified size.
+ * If an exception is thrown, either by the parser or by the delegate, all
+ * buffered input is discarded and the next call starts with a new document.
+ * @param buffer The buffer to parse
+ * @param length The length of the buffer
+ * @throw OFInvalidJSONException The JSON was invalid
+ * @throw OFInvalidEncodingException A string was not valid UTF-8
+ */
+- (void)parseBuffer: (const char *)buffer length: (size_t)length;
+
+/**
+ * @brief Parses the specified string.
+ * @param string The string to parse
+ * @throw OFInvalidJSONException The JSON was invalid
+ */
+- (void)parseString: (OFString *)string;
+
+/**
+ * @brief Parses the specified stream until the end of the stream is reached
+ *	  and then calls @ref finishParsing.
+ * @param stream The stream to parse
+ * @throw OFInvalidJSONException The JSON was invalid
+ * @throw OFInvalidEncodingException A string was not valid UTF-8
+ */
+- (void)parseStream: (OFStream *)stream;
+
+/**
+ * @brief Tells the parser that there is no more input.
+ * This is necessary to finish a top-level number, as it cannot be known
+ * whether more digits follow before this is called.
+ * @throw OFInvalidJSONException The input ended in the middle of a value
+ */
+- (void)finishParsing;
+@end
+
+OF_ASSUME_NONNULL_END
@@ -0,0 +1,719 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#import "OFJSONParser.h"
+#import "OFData.h"
+#import "OFNull.h"
+#import "OFNumber.h"
+#import "OFStream.h"
+#import "OFString.h"
+#import "OFString+Private.h"
+#import "OFSystemInfo.h"
+
+#import "OFInvalidFormatException.h"
+#import "OFInvalidJSONException.h"
+#import "OFOutOfRangeException.h"
+
+enum {
+	stateValue,
+	stateValueOrArrayEnd,
+	stateKeyOrDictionaryEnd,
+	stateKey,
+	stateColon,
+	stateAfterValue,
+	stateAfterDocument,
+	stateString,
+	stateStringEscape,
+	stateStringUnicodeEscape,
+	stateStringSurrogateBackslash,
+	stateStringSurrogateU,
+	stateNumber,
+	stateLiteral
+};
+
+static void valueState(OFJSONParser *);
+static void valueOrArrayEndState(OFJSONParser *);
+static void keyOrDictionaryEndState(OFJSONParser *);
+static void keyState(OFJSONParser *);
+static void colonState(OFJSONParser *);
+static void afterValueState(OFJSONParser *);
+static void afterDocumentState(OFJSONParser *);
+static void stringState(OFJSONParser *);
+static void stringEscapeState(OFJSONParser *);
+static void stringUnicodeEscapeState(OFJSONParser *);
+static void stringSurrogateBackslashState(OFJSONParser *);
+static void stringSurrogateUState(OFJSONParser *);
+static void numberState(OFJSONParser *);
+static void literalState(OFJSONParser *);
+typedef void (*StateFunction)(OFJSONParser *);
+static StateFunction lookupTable[] = {
+	[stateValue] = valueState,
+	[stateValueOrArrayEnd] = valueOrArrayEndState,
+	[stateKeyOrDictionaryEnd] = keyOrDictionaryEndState,
+	[stateKey] = keyState,
+	[stateColon] = colonState,
+	[stateAfterValue] = afterValueState,
+	[stateAfterDocument] = afterDocumentState,
+	[stateString] = stringState,
+	[stateStringEscape] = stringEscapeState,
+	[stateStringUnicodeEscape] = stringUnicodeEscapeState,
+	[stateStringSurrogateBackslash] = stringSurrogateBackslashState,
+	[stateStringSurrogateU] = stringSurrogateUState,
+	[stateNumber] = numberState,
+	[stateLiteral] = literalState
+};
+
+static OFInvalidJSONException *
+invalidJSONException(OFJSONParser *self)
+{
+	return [OFInvalidJSONException exceptionWithString: nil
+						      line: self->_lineNumber];
+}
+
+static OF_INLINE bool
+skipWhitespace(OFJSONParser *self)
+{
+	switch (self->_data[self->_i]) {
+	case '\n':
+		self->_lineNumber++;
+		/* Fall through */
+	case ' ':
+	case '\t':
+	case '\r':
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void
+valueDidEnd(OFJSONParser *self)
+{
+	if (self->_stack.count > 0) {
+		self->_state = stateAfterValue;
+		return;
+	}
+
+	self->_state = stateAfterDocument;
+
+	if ([self->_delegate respondsToSelector:
+	    @selector(parserDidEndDocument:)])
+		[self->_delegate parserDidEndDocument: self];
+}
+
+static void
+foundValue(OFJSONParser *self, id value)
+{
+	if ([self->_delegate respondsToSelector: @selector(parser:foundValue:)])
+		[self->_delegate parser: self foundValue: value];
+
+	valueDidEnd(self);
+}
+
+static void
+startContainer(OFJSONParser *self, char type)
+{
+	if (self->_depthLimit > 0 &&
+	    self->_stack.count + 1 >= self->_depthLimit)
+		@throw invalidJSONException(self);
+
+	[self->_stack addItem: &type];
+
+	if (type == '{') {
+		self->_state = stateKeyOrDictionaryEnd;
+
+		if ([self->_delegate respondsToSelector:
+		    @selector(parserDidStartDictionary:)])
+			[self->_delegate parserDidStartDictionary: self];
+	} else {
+		self->_state = stateValueOrArrayEnd;
+
+		if ([self->_delegate respondsToSelector:
+		    @selector(parserDidStartArray:)])
+			[self->_delegate parserDidStartArray: self];
+	}
+}
+
+static void
+endContainer(OFJSONParser *self, char type)
+{
+	if (self->_stack.count == 0 ||
+	    *(const char *)self->_stack.lastItem != type)
+		@throw invalidJSONException(self);
+
+	[self->_stack removeLastItem];
+
+	if (type == '{') {
+		if ([self->_delegate respondsToSelector:
+		    @selector(parserDidEndDictionary:)])
+			[self->_delegate parserDidEndDictionary: self];
+	} else {
+		if ([self->_delegate respondsToSelector:
+		    @selector(parserDidEndArray:)])
+			[self->_delegate parserDidEndArray: self];
+	}
+
+	valueDidEnd(self);
+}
+
+static void
+startLiteral(OFJSONParser *self, const char *literal)
+{
+	self->_literal = literal;
+	self->_literalIndex = 1;
+	self->_state = stateLiteral;
+}
+
+static void
+valueState(OFJSONParser *self)
+{
+	char c = self->_data[self->_i];
+
+	if (skipWhitespace(self))
+		return;
+
+	switch (c) {
+	case '{':
+	case '[':
+		startContainer(self, c);
+		break;
+	case '"':
+		self->_parsingKey = false;
+		self->_state = stateString;
+		break;
+	case 't':
+		startLiteral(self, "true");
+		break;
+	case 'f':
+		startLiteral(self, "false");
+		break;
+	case 'n':
+		startLiteral(self, "null");
+		break;
+	case '-':
+	case '0':
+	case '1':
+	case '2':
+	case '3':
+	case '4':
+	case '5':
+	case '6':
+	case '7':
+	case '8':
+	case '9':
+		[self->_buffer addItem: &c];
+		self->_state = stateNumber;
+		break;
+	default:
+		@throw invalidJSONException(self);
+	}
+}
+
+static void
+valueOrArrayEndState(OFJSONParser *self)
+{
+	if (self->_data[self->_i] == ']')
+		endContainer(self, '[');
+	else
+		valueState(self);
+}
+
+static void
+keyOrDictionaryEndState(OFJSONParser *self)
+{
+	if (self->_data[self->_i] == '}')
+		endContainer(self, '{');
+	else
+		keyState(self);
+}
+
+static void
+keyState(OFJSONParser *self)
+{
+	if (skipWhitespace(self))
+		return;
+
+	if (self->_data[self->_i] != '"')
+		@throw invalidJSONException(self);
+
+	self->_parsingKey = true;
+	self->_state = stateString;
+}
+
+static void
+colonState(OFJSONParser *self)
+{
+	if (skipWhitespace(self))
+		return;
+
+	if (self->_data[self->_i] != ':')
+		@throw invalidJSONException(self);
+
+	self->_state = stateValue;
+}
+
+static void
+afterValueState(OFJSONParser *self)
+{
+	if (skipWhitespace(self))
+		return;
+
+	switch (self->_data[self->_i]) {
+	case ',':
+		if (*(const char *)self->_stack.lastItem == '{')
+			self->_state = stateKey;
+		else
+			self->_state = stateValue;
+		break;
+	case ']':
+		endContainer(self, '[');
+		break;
+	case '}':
+		endContainer(self, '{');
+		break;
+	default:
+		@throw invalidJSONException(self);
+	}
+}
+
+static void
+afterDocumentState(OFJSONParser *self)
+{
+	/* Top-level values need to be separated by whitespace. */
+	if (!skipWhitespace(self))
+		@throw invalidJSONException(self);
+
+	self->_state = stateValue;
+}
+
+static void
+finishString(OFJSONParser *self)
+{
+	void *pool = objc_autoreleasePoolPush();
+	OFString *string;
+
+	if (self->_buffer.count > 0)
+		string = [OFString stringWithUTF8String: self->_buffer.items
+						 length: self->_buffer.count];
+	else
+		string = @"";
+
+	[self->_buffer removeAllItems];
+
+	if (self->_parsingKey) {
+		self->_state = stateColon;
+
+		if ([self->_delegate respondsToSelector:
+		    @selector(parser:foundKey:)])
+			[self->_delegate parser: self foundKey: string];
+	} else
+		foundValue(self, string);
+
+	objc_autoreleasePoolPop(pool);
+}
+
+static void
+stringState(OFJSONParser *self)
+{
+	const char *data = self->_data;
+	size_t i, length = self->_length;
+
+	/* Append everything up to the next special character at once. */
+	for (i = self->_i; i < length; i++)
+		if (data[i] == '"' || data[i] == '\\' ||
+		    (unsigned char)data[i] < 0x20)
+			break;
+
+	if (i > self->_i)
+		[self->_buffer addItems: data + self->_i count: i - self->_i];
+
+	if (i == length) {
+		self->_i = length - 1;
+		return;
+	}
+
+	self->_i = i;
+
+	if (data[i] == '"')
+		finishString(self);
+	else if (data[i] == '\\')
+		self->_state = stateStringEscape;
+	else
+		/* Control characters need to be escaped. */
+		@throw invalidJSONException(self);
+}
+
+static void
+appendCharacter(OFJSONParser *self, OFUnichar character)
+{
+	char buffer[4];
+	size_t length = _OFUTF8StringEncode(character, buffer);
+
+	if (length == 0)
+		@throw invalidJSONException(self);
+
+	[self->_buffer addItems: buffer count: length];
+}
+
+static void
+stringEscapeState(OFJSONParser *self)
+{
+	char c = self->_data[self->_i];
+
+	switch (c) {
+	case '"':
+	case '\\':
+	case '/':
+		break;
+	case 'b':
+		c = '\b';
+		break;
+	case 'f':
+		c = '\f';
+		break;
+	case 'n':
+		c = '\n';
+		break;
+	case 'r':
+		c = '\r';
+		break;
+	case 't':
+		c = '\t';
+		break;
+	case 'u':
+		self->_unicodeEscape = 0;
+		self->_unicodeEscapeLength = 0;
+		self->_state = stateStringUnicodeEscape;
+		return;
+	default:
+		@throw invalidJSONException(self);
+	}
+
+	[self->_buffer addItem: &c];
+	self->_state = stateString;
+}
+
+static void
+stringUnicodeEscapeState(OFJSONParser *self)
+{
+	char c = self->_data[self->_i];
+	uint16_t character;
+
+	self->_unicodeEscape <<= 4;
+
+	if (c >= '0' && c <= '9')
+		self->_unicodeEscape |= c - '0';
+	else if (c >= 'a' && c <= 'f')
+		self->_unicodeEscape |= c + 10 - 'a';
+	else if (c >= 'A' && c <= 'F')
+		self->_unicodeEscape |= c + 10 - 'A';
+	else
+		@throw invalidJSONException(self);
+
+	if (++self->_unicodeEscapeLength < 4)
+		return;
+
+	character = self->_unicodeEscape;
+
+	if (self->_highSurrogate != 0) {
+		if ((character & 0xFC00) != 0xDC00)
+			@throw invalidJSONException(self);
+
+		appendCharacter(self, (((self->_highSurrogate & 0x3FF) << 10) |
+		    (character & 0x3FF)) + 0x10000);
+		self->_highSurrogate = 0;
+		self->_state = stateString;
+	} else if ((character & 0xFC00) == 0xD800) {
+		/*
+		 * We only got one UTF-16 surrogate and need to get the other
+		 * one in order to produce UTF-8 and not CESU-8.
+		 */
+		self->_highSurrogate = character;
+		self->_state = stateStringSurrogateBackslash;
+	} else if ((character & 0xFC00) == 0xDC00)
+		@throw invalidJSONException(self);
+	else {
+		appendCharacter(self, character);
+		self->_state = stateString;
+	}
+}
+
+static void
+stringSurrogateBackslashState(OFJSONParser *self)
+{
+	if (self->_data[self->_i] != '\\')
+		@throw invalidJSONException(self);
+
+	self->_state = stateStringSurrogateU;
+}
+
+static void
+stringSurrogateUState(OFJSONParser *self)
+{
+	if (self->_data[self->_i] != 'u')
+		@throw invalidJSONException(self);
+
+	self->_unicodeEscape = 0;
+	self->_unicodeEscapeLength = 0;
+	self->_state = stateStringUnicodeEscape;
+}
+
+static bool
+isValidNumber(const char *string, size_t length, bool *isInteger)
+{
+	size_t i = 0;
+
+	*isInteger = true;
+
+	if (i < length && string[i] == '-')
+		i++;
+
+	if (i >= length)
+		return false;
+
+	if (string[i] == '0')
+		i++;
+	else if (string[i] >= '1' && string[i] <= '9')
+		while (i < length && string[i] >= '0' && string[i] <= '9')
+			i++;
+	else
+		return false;
+
+	if (i < length && string[i] == '.') {
+		size_t start = ++i;
+
+		*isInteger = false;
+
+		while (i < length && string[i] >= '0' && string[i] <= '9')
+			i++;
+
+		if (i == start)
+			return false;
+	}
+
+	if (i < length && (string[i] == 'e' || string[i] == 'E')) {
+		size_t start;
+
+		*isInteger = false;
+
+		if (++i < length && (string[i] == '+' || string[i] == '-'))
+			i++;
+
+		start = i;
+		while (i < length && string[i] >= '0' && string[i] <= '9')
+			i++;
+
+		if (i == start)
+			return false;
+	}
+
+	return (i == length);
+}
+
+static void
+finishNumber(OFJSONParser *self)
+{
+	void *pool = objc_autoreleasePoolPush();
+	const char *items = self->_buffer.items;
+	size_t count = self->_buffer.count;
+	bool isInteger, isNegative;
+	OFString *string;
+	OFNumber *number;
+
+	if (!isValidNumber(items, count, &isInteger))
+		@throw invalidJSONException(self);
+
+	isNegative = (*items == '-');
+	string = [OFString stringWithUTF8String: items length: count];
+	[self->_buffer removeAllItems];
+
+	@try {
+		if (!isInteger)
+			number = [OFNumber numberWithDouble:
+			    string.doubleValue];
+		else if (isNegative)
+			number = [OFNumber numberWithLongLong:
+			    [string longLongValueWithBase: 10]];
+		else
+			number = [OFNumber numberWithUnsignedLongLong:
+			    [string unsignedLongLongValueWithBase: 10]];
+	} @catch (OFOutOfRangeException *e) {
+		number = [OFNumber numberWithDouble: string.doubleValue];
+	} @catch (OFInvalidFormatException *e) {
+		@throw invalidJSONException(self);
+	}
+
+	foundValue(self, number);
+
+	objc_autoreleasePoolPop(pool);
+}
+
+static void
+numberState(OFJSONParser *self)
+{
+	char c = self->_data[self->_i];
+
+	if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' ||
+	    c == '+' || c == '-') {
+		[self->_buffer addItem: &c];
+		return;
+	}
+
+	finishNumber(self);
+
+	/*
+	 * The character that ended the number belongs to the next token, so
+	 * pass it to the new state right away. This cannot recurse further,
+	 * as finishing the number left the number state.
+	 */
+	lookupTable[self->_state](self);
+}
+
+static void
+literalState(OFJSONParser *self)
+{
+	if (self->_data[self->_i] != self->_literal[self->_literalIndex])
+		@throw invalidJSONException(self);
+
+	if (self->_literal[++self->_literalIndex] != '\0')
+		return;
+
+	switch (*self->_literal) {
+	case 't':
+		foundValue(self, [OFNumber numberWithBool: true]);
+		break;
+	case 'f':
+		foundValue(self, [OFNumber numberWithBool: false]);
+		break;
+	default:
+		foundValue(self, [OFNull null]);
+		break;
+	}
+}
+
+/*
+ * There is no way to find the start of the next value after an error, so
+ * discard everything and start over with a new document.
+ */
+static void
+reset(OFJSONParser *self)
+{
+	self->_state = stateValue;
+	[self->_buffer removeAllItems];
+	[self->_stack removeAllItems];
+	self->_literal = NULL;
+	self->_literalIndex = 0;
+	self->_parsingKey = false;
+	self->_unicodeEscape = self->_highSurrogate = 0;
+	self->_unicodeEscapeLength = 0;
+}
+
+@implementation OFJSONParser
+@synthesize delegate = _delegate, lineNumber = _lineNumber;
+@synthesize depthLimit = _depthLimit;
+
++ (instancetype)parser
+{
+	return [[[self alloc] init] autorelease];
+}
+
+- (instancetype)init
+{
+	self = [super init];
+
+	@try {
+		_buffer = [[OFMutableData alloc] init];
+		_stack = [[OFMutableData alloc] init];
+		_lineNumber = 1;
+		_depthLimit = 32;
+	} @catch (id e) {
+		[self release];
+		@throw e;
+	}
+
+	return self;
+}
+
+- (void)dealloc
+{
+	[_buffer release];
+	[_stack release];
+
+	[super dealloc];
+}
+
+- (void)parseBuffer: (const char *)buffer length: (size_t)length
+{
+	_data = buffer;
+	_length = length;
+
+	@try {
+		for (_i = 0; _i < length; _i++)
+			lookupTable[_state](self);
+	} @catch (id e) {
+		reset(self);
+		@throw e;
+	} @finally {
+		_data = NULL;
+		_length = 0;
+	}
+}
+
+- (void)parseString: (OFString *)string
+{
+	[self parseBuffer: string.UTF8String length: string.UTF8StringLength];
+}
+
+- (void)parseStream: (OFStream *)stream
+{
+	size_t pageSize = [OFSystemInfo pageSize];
+	char *buffer = OFAllocMemory(1, pageSize);
+
+	@try {
+		while (!stream.atEndOfStream) {
+			size_t length = [stream readIntoBuffer: buffer
+							length: pageSize];
+			[self parseBuffer: buffer length: length];
+		}
+	} @finally {
+		OFFreeMemory(buffer);
+	}
+
+	[self finishParsing];
+}
+
+- (void)finishParsing
+{
+	@try {
+		if (_state == stateNumber)
+			finishNumber(self);
+
+		if ((_state != stateValue && _state != stateAfterDocument) ||
+		    _stack.count > 0)
+			@throw invalidJSONException(self);
+	} @catch (id e) {
+		reset(self);
+		@throw e;
+	}
+}
+@end
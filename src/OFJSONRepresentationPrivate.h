@@ -19,14 +19,15 @@
 
 #import "OFObject.h"
 
-@class OFString;
+@class OFMutableString;
 
 OF_ASSUME_NONNULL_BEGIN
 
 @protocol OFJSONRepresentationPrivate
-- (OFString *)
-    of_JSONRepresentationWithOptions: (OFJSONRepresentationOptions)options
-			       depth: (size_t)depth;
+- (void)
+    of_appendJSONRepresentationToString: (OFMutableString *)JSON
+				options: (OFJSONRepresentationOptions)options
+				  depth: (size_t)depth;
 @end
 
 OF_ASSUME_NONNULL_END
@@ -28,6 +28,9 @@
 #ifdef HAVE_EPOLL
 # import "OFEpollKernelEventObserver.h"
 #endif
+#ifdef HAVE_IO_URING
+# import "OFIOUringKernelEventObserver.h"
+#endif
 #ifdef HAVE_KQUEUE
 # import "OFKqueueKernelEventObserver.h"
 #endif
@@ -68,7 +71,13 @@
 
 + (instancetype)alloc
 {
-	if (self == [OFKernelEventObserver class])
+	if (self == [OFKernelEventObserver class]) {
+#ifdef HAVE_IO_URING
+		/* Only built with --enable-io-uring. */
+		if ([OFIOUringKernelEventObserver isSupported])
+			return [OFIOUringKernelEventObserver alloc];
+#endif
+
 #if defined(HAVE_KQUEUE)
 		return [OFKqueueKernelEventObserver alloc];
 #elif defined(HAVE_EPOLL)
@@ -80,6 +89,7 @@
 #else
 # error No kqueue / epoll / poll / select found!
 #endif
+	}
 
 	return [super alloc];
 }
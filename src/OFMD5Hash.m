@@ -22,6 +22,7 @@
 #include <string.h>
 
 #import "OFMD5Hash.h"
+#import "OFMultiBufferHash.h"
 #import "OFSecureData.h"
 
 #import "OFHashAlreadyCalculatedException.h"
@@ -36,6 +37,9 @@ OF_DIRECT_MEMBERS
 - (void)of_resetState;
 @end
 
+@interface OFMD5Hash () <OFMultiBufferHash>
+@end
+
 #define F(a, b, c) (((a) & (b)) | (~(a) & (c)))
 #define G(a, b, c) (((a) & (c)) | ((b) & ~(c)))
 #define H(a, b, c) ((a) ^ (b) ^ (c))
@@ -127,6 +131,53 @@ processBlock(uint32_t *state, uint32_t *buffer)
 	state[3] += new[3];
 }
 
+#ifdef OF_HAVE_MULTI_BUFFER_HASHING
+static void
+processBlocks(uint32_t *state, const unsigned char *const *blocks)
+{
+	OFMultiBufferHashVector old[4], new[4], words[16];
+	uint_fast8_t i;
+
+	memcpy(old, state, sizeof(old));
+	memcpy(new, state, sizeof(new));
+
+	for (i = 0; i < 16; i++)
+		words[i] = OFMultiBufferHashLoadWord(blocks, i, false);
+
+#define LOOP_BODY(f)						\
+	{							\
+		OFMultiBufferHashVector tmp = new[3];		\
+		new[0] += f(new[1], new[2], new[3]) +		\
+		    words[wordOrder[i]] + table[i];		\
+		new[3] = new[2];				\
+		new[2] = new[1];				\
+		new[1] += OFMultiBufferHashRotateLeft(new[0],	\
+		    rotateBits[(i % 4) + (i / 16) * 4]);	\
+		new[0] = tmp;					\
+	}
+
+	for (i = 0; i < 16; i++)
+		LOOP_BODY(F)
+	for (; i < 32; i++)
+		LOOP_BODY(G)
+	for (; i < 48; i++)
+		LOOP_BODY(H)
+	for (; i < 64; i++)
+		LOOP_BODY(I)
+
+#undef LOOP_BODY
+
+	for (i = 0; i < 4; i++)
+		new[i] += old[i];
+
+	memcpy(state, new, sizeof(new));
+}
+
+static const OFMultiBufferHashKernel multiBufferHashKernel = {
+	processBlocks, 4, false
+};
+#endif
+
 @implementation OFMD5Hash
 @synthesize calculated = _calculated;
 @synthesize allowsSwappableMemory = _allowsSwappableMemory;
@@ -136,6 +187,15 @@ processBlock(uint32_t *state, uint32_t *buffer)
 	return digestSize;
 }
 
++ (const OFMultiBufferHashKernel *)of_multiBufferHashKernel
+{
+#ifdef OF_HAVE_MULTI_BUFFER_HASHING
+	return &multiBufferHashKernel;
+#else
+	return NULL;
+#endif
+}
+
 + (size_t)blockSize
 {
 	return blockSize;
@@ -206,6 +266,11 @@ processBlock(uint32_t *state, uint32_t *buffer)
 	return copy;
 }
 
+- (void)of_getMultiBufferHashState: (uint32_t *)state
+{
+	memcpy(state, _iVars->state, sizeof(_iVars->state));
+}
+
 - (void)of_resetState
 {
 	_iVars->state[0] = 0x67452301;
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#import "OFObject.h"
+
+OF_ASSUME_NONNULL_BEGIN
+
+@class OFData;
+@class OFMessagePackParser;
+@class OFMutableData;
+@class OFStream;
+
+/**
+ * @protocol OFMessagePackParserDelegate OFMessagePackParser.h ObjFW/ObjFW.h
+ * @brief A protocol that needs to be implemented by delegates for
+ *	  OFMessagePackParser.
+ */
+@protocol OFMessagePackParserDelegate <OFObject>
+/**
+ * @brief This callback is called when the MessagePack parser parsed a complete
+ *	  top-level object.
+ *
+ * @param parser The parser which parsed an object
+ * @param object The object the MessagePack parser parsed
+ */
+- (void)parser: (OFMessagePackParser *)parser didParseObject: (id)object;
+@end
+
+/**
+ * @class OFMessagePackParser OFMessagePackParser.h ObjFW/ObjFW.h
+ * @brief An incremental MessagePack parser.
+ *
+ * OFMessagePackParser accepts a sequence of MessagePack objects in chunks that
+ * are split at arbitrary positions and calls the delegate for every top-level
+ * object as soon as it is complete. This makes it suitable for parsing
+ * MessagePack received from a socket, e.g. by calling
+ * @ref parseBuffer:length: from an asynchronous read handler.
+ *
+ * Incomplete input is only scanned once, no matter how many chunks it arrives
+ * in. Every complete object is copied out of the receive buffer exactly once
+ * and binary data and extensions in the result reference that copy.
+ */
+OF_SUBCLASSING_RESTRICTED
+@interface OFMessagePackParser: OFObject
+{
+	id <OFMessagePackParserDelegate> _Nullable _delegate;
+	OFMutableData *_buffer, *_stack;
+	size_t _scanned;
+	size_t _depthLimit;
+}
+
+/**
+ * @brief The delegate that is used by the MessagePack parser.
+ */
+@property OF_NULLABLE_PROPERTY (assign, nonatomic)
+    id <OFMessagePackParserDelegate> delegate;
+
+/**
+ * @brief The depth limit for the MessagePack parser.
+ *
+ * If the depth limit is exceeded, an OFOutOfRangeException is thrown.
+ * The default is 32. 0 means unlimited (insecure!).
+ */
+@property (nonatomic) size_t depthLimit;
+
+/**
+ * @brief Whether the parser has buffered the beginning of an incomplete
+ *	  object.
+ */
+@property (readonly, nonatomic) bool hasIncompleteObject;
+
+/**
+ * @brief Creates a new MessagePack parser.
+ *
+ * @return A new, autoreleased OFMessagePackParser
+ */
++ (instancetype)parser;
+
+/**
+ * @brief Parses the specified buffer with the specified length.
+ *
+ * If an exception is thrown, either by the parser or by the delegate, all
+ * buffered input is discarded and the next call starts with a new object.
+ *
+ * @param buffer The buffer to parse
+ * @param length The length of the buffer
+ * @throw OFInvalidFormatException The MessagePack representation contained an
+ *				   invalid format
+ * @throw OFOutOfRangeException The depth limit has been exceeded
+ */
+- (void)parseBuffer: (const void *)buffer length: (size_t)length;
+
+/**
+ * @brief Parses the specified data.
+ *
+ * @param data The data to parse
+ * @throw OFInvalidFormatException The MessagePack representation contained an
+ *				   invalid format
+ * @throw OFOutOfRangeException The depth limit has been exceeded
+ */
+- (void)parseData: (OFData *)data;
+
+/**
+ * @brief Parses the specified stream until the end of the stream is reached
+ *	  and then calls @ref finishParsing.
+ *
+ * @param stream The stream to parse
+ * @throw OFInvalidFormatException The MessagePack representation contained an
+ *				   invalid format
+ * @throw OFTruncatedDataException The stream ended in the middle of an object
+ * @throw OFOutOfRangeException The depth limit has been exceeded
+ */
+- (void)parseStream: (OFStream *)stream;
+
+/**
+ * @brief Tells the parser that there is no more input.
+ *
+ * @throw OFTruncatedDataException The input ended in the middle of an object
+ */
+- (void)finishParsing;
+@end
+
+OF_ASSUME_NONNULL_END
@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#import "OFMessagePackParser.h"
+#import "OFData.h"
+#import "OFData+MessagePackParsing.h"
+#import "OFStream.h"
+#import "OFSystemInfo.h"
+
+#import "OFInvalidArgumentException.h"
+#import "OFInvalidFormatException.h"
+#import "OFOutOfRangeException.h"
+#import "OFTruncatedDataException.h"
+
+static uint16_t
+readUInt16(const unsigned char *buffer)
+{
+	return ((uint16_t)buffer[0] << 8) | buffer[1];
+}
+
+static uint32_t
+readUInt32(const unsigned char *buffer)
+{
+	return ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16) |
+	    ((uint32_t)buffer[2] << 8) | buffer[3];
+}
+
+/*
+ * Determines the length of the element at the start of the buffer, without
+ * its children if it is an array or a map. Returns false if the buffer does
+ * not contain the complete element yet.
+ */
+static bool
+scanElement(const unsigned char *buffer, size_t length, size_t *elementLength,
+    size_t *childCount)
+{
+	size_t headerLength, payloadLength = 0;
+
+	*childCount = 0;
+
+	if (length < 1)
+		return false;
+
+	/* positive fixint, negative fixint */
+	if ((buffer[0] & 0x80) == 0 || (buffer[0] & 0xE0) == 0xE0) {
+		*elementLength = 1;
+		return true;
+	}
+
+	/* fixstr */
+	if ((buffer[0] & 0xE0) == 0xA0) {
+		payloadLength = buffer[0] & 0x1F;
+
+		if (length < payloadLength + 1)
+			return false;
+
+		*elementLength = payloadLength + 1;
+		return true;
+	}
+
+	/* fixarray */
+	if ((buffer[0] & 0xF0) == 0x90) {
+		*elementLength = 1;
+		*childCount = buffer[0] & 0xF;
+		return true;
+	}
+
+	/* fixmap */
+	if ((buffer[0] & 0xF0) == 0x80) {
+		*elementLength = 1;
+		*childCount = (buffer[0] & 0xF) * 2;
+		return true;
+	}
+
+	switch (buffer[0]) {
+	case 0xC0: /* nil */
+	case 0xC2: /* false */
+	case 0xC3: /* true */
+		headerLength = 1;
+		break;
+	case 0xCC: /* uint 8 */
+	case 0xD0: /* int 8 */
+	case 0xC4: /* bin 8 */
+	case 0xD9: /* str 8 */
+		headerLength = 2;
+		break;
+	case 0xCD: /* uint 16 */
+	case 0xD1: /* int 16 */
+	case 0xC5: /* bin 16 */
+	case 0xDA: /* str 16 */
+	case 0xC7: /* ext 8 */
+	case 0xD4: /* fixext 1 */
+	case 0xDC: /* array 16 */
+	case 0xDE: /* map 16 */
+		headerLength = 3;
+		break;
+	case 0xC8: /* ext 16 */
+	case 0xD5: /* fixext 2 */
+		headerLength = 4;
+		break;
+	case 0xCE: /* uint 32 */
+	case 0xD2: /* int 32 */
+	case 0xCA: /* float 32 */
+	case 0xC6: /* bin 32 */
+	case 0xDB: /* str 32 */
+	case 0xDD: /* array 32 */
+	case 0xDF: /* map 32 */
+		headerLength = 5;
+		break;
+	case 0xC9: /* ext 32 */
+	case 0xD6: /* fixext 4 */
+		headerLength = 6;
+		break;
+	case 0xCF: /* uint 64 */
+	case 0xD3: /* int 64 */
+	case 0xCB: /* float 64 */
+		headerLength = 9;
+		break;
+	case 0xD7: /* fixext 8 */
+		headerLength = 10;
+		break;
+	case 0xD8: /* fixext 16 */
+		headerLength = 18;
+		break;
+	default:
+		@throw [OFInvalidFormatException exception];
+	}
+
+	if (length < headerLength)
+		return false;
+
+	switch (buffer[0]) {
+	case 0xC4: /* bin 8 */
+	case 0xD9: /* str 8 */
+	case 0xC7: /* ext 8 */
+		payloadLength = buffer[1];
+		break;
+	case 0xC5: /* bin 16 */
+	case 0xDA: /* str 16 */
+	case 0xC8: /* ext 16 */
+		payloadLength = readUInt16(buffer + 1);
+		break;
+	case 0xC6: /* bin 32 */
+	case 0xDB: /* str 32 */
+	case 0xC9: /* ext 32 */
+		payloadLength = readUInt32(buffer + 1);
+		break;
+	case 0xDC: /* array 16 */
+		*childCount = readUInt16(buffer + 1);
+		break;
+	case 0xDD: /* array 32 */
+		*childCount = readUInt32(buffer + 1);
+		break;
+	case 0xDE: /* map 16 */
+		*childCount = (size_t)readUInt16(buffer + 1) * 2;
+		break;
+	case 0xDF: /* map 32 */
+		if (readUInt32(buffer + 1) > SIZE_MAX / 2)
+			@throw [OFOutOfRangeException exception];
+
+		*childCount = (size_t)readUInt32(buffer + 1) * 2;
+		break;
+	}
+
+	if (length - headerLength < payloadLength)
+		return false;
+
+	*elementLength = headerLength + payloadLength;
+	return true;
+}
+
+/*
+ * Continues scanning the buffered object where the last call stopped and
+ * returns whether the object is complete. If it is, self->_scanned is its
+ * length.
+ */
+static bool
+scanObject(OFMessagePackParser *self, const unsigned char *buffer,
+    size_t length)
+{
+	for (;;) {
+		size_t elementLength, childCount;
+
+		if (!scanElement(buffer + self->_scanned,
+		    length - self->_scanned, &elementLength, &childCount))
+			return false;
+
+		self->_scanned += elementLength;
+
+		if (childCount > 0) {
+			if (self->_depthLimit > 0 &&
+			    self->_stack.count + 1 >= self->_depthLimit)
+				@throw [OFOutOfRangeException exception];
+
+			[self->_stack addItem: &childCount];
+			continue;
+		}
+
+		/* The element is complete, which might complete its parents. */
+		for (;;) {
+			size_t *remaining;
+
+			if (self->_stack.count == 0)
+				return true;
+
+			remaining = self->_stack.mutableLastItem;
+			if (--*remaining > 0)
+				break;
+
+			[self->_stack removeLastItem];
+		}
+	}
+}
+
+@implementation OFMessagePackParser
+@synthesize delegate = _delegate, depthLimit = _depthLimit;
+
++ (instancetype)parser
+{
+	return [[[self alloc] init] autorelease];
+}
+
+- (instancetype)init
+{
+	self = [super init];
+
+	@try {
+		_buffer = [[OFMutableData alloc] init];
+		_stack = [[OFMutableData alloc]
+		    initWithItemSize: sizeof(size_t)];
+		_depthLimit = 32;
+	} @catch (id e) {
+		[self release];
+		@throw e;
+	}
+
+	return self;
+}
+
+- (void)dealloc
+{
+	[_buffer release];
+	[_stack release];
+
+	[super dealloc];
+}
+
+- (bool)hasIncompleteObject
+{
+	return (_buffer.count > 0);
+}
+
+- (void)parseBuffer: (const void *)buffer_ length: (size_t)length
+{
+	const unsigned char *buffer = buffer_;
+	bool buffered = (_buffer.count > 0);
+	size_t consumed = 0;
+
+	/*
+	 * If nothing is buffered, parse directly from the passed buffer and
+	 * only buffer what is left over at the end.
+	 */
+	if (buffered) {
+		[_buffer addItems: buffer count: length];
+		buffer = _buffer.items;
+		length = _buffer.count;
+	}
+
+	@try {
+		while (consumed < length &&
+		    scanObject(self, buffer + consumed, length - consumed)) {
+			void *pool = objc_autoreleasePoolPush();
+			OFData *data = [OFData dataWithItems: buffer + consumed
+						       count: _scanned];
+			id object;
+
+			consumed += _scanned;
+			_scanned = 0;
+
+			object = [data
+			    objectByParsingMessagePackWithDepthLimit:
+			    _depthLimit];
+			[_delegate parser: self didParseObject: object];
+
+			objc_autoreleasePoolPop(pool);
+		}
+	} @catch (id e) {
+		/*
+		 * There is no way to find the start of the next object after
+		 * an error, so discard all input and start over.
+		 */
+		_scanned = 0;
+		[_stack removeAllItems];
+		[_buffer removeAllItems];
+
+		@throw e;
+	}
+
+	if (buffered)
+		[_buffer removeItemsInRange: OFMakeRange(0, consumed)];
+	else
+		[_buffer addItems: buffer + consumed count: length - consumed];
+}
+
+- (void)parseData: (OFData *)data
+{
+	if (data.itemSize != 1)
+		@throw [OFInvalidArgumentException exception];
+
+	[self parseBuffer: data.items length: data.count];
+}
+
+- (void)parseStream: (OFStream *)stream
+{
+	size_t pageSize = [OFSystemInfo pageSize];
+	char *buffer = OFAllocMemory(1, pageSize);
+
+	@try {
+		while (!stream.atEndOfStream) {
+			size_t length = [stream readIntoBuffer: buffer
+							length: pageSize];
+			[self parseBuffer: buffer length: length];
+		}
+	} @finally {
+		OFFreeMemory(buffer);
+	}
+
+	[self finishParsing];
+}
+
+- (void)finishParsing
+{
+	if (_buffer.count > 0)
+		@throw [OFTruncatedDataException exception];
+}
+@end
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#import "OFObject.h"
+#import "OFData.h"
+
+OF_ASSUME_NONNULL_BEGIN
+
+@protocol OFMessagePackRepresentationPrivate
+- (void)of_appendMessagePackRepresentationToData: (OFMutableData *)data;
+@end
+
+/*
+ * Appends the MessagePack representation of the specified object to the
+ * specified data, without an intermediate OFData if the object supports it.
+ */
+static OF_INLINE void
+_OFAppendMessagePackRepresentation(OFMutableData *data, id object)
+{
+	OFData *representation;
+
+	if ([object respondsToSelector:
+	    @selector(of_appendMessagePackRepresentationToData:)]) {
+		[object of_appendMessagePackRepresentationToData: data];
+		return;
+	}
+
+	representation = [object messagePackRepresentation];
+	[data addItems: representation.items count: representation.count];
+}
+
+OF_ASSUME_NONNULL_END
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#import "OFCryptographicHash.h"
+
+OF_ASSUME_NONNULL_BEGIN
+
+/* The number of independent messages that are hashed at the same time. */
+#define OFMultiBufferHashLanes 4
+
+#if defined(__clang__) || OF_GCC_VERSION >= 409
+# define OF_HAVE_MULTI_BUFFER_HASHING
+/* One word of every lane, so that the compiler can use SIMD registers. */
+typedef uint32_t OFMultiBufferHashVector
+    __attribute__((__vector_size__(OFMultiBufferHashLanes * 4)));
+#endif
+
+typedef struct {
+	/*
+	 * Processes one 64 byte block for every lane. Each word of the state
+	 * is followed by the same word of the other lanes.
+	 */
+	void (*processBlocks)(uint32_t *state,
+	    const unsigned char *_Nonnull const *_Nonnull blocks);
+	uint_fast8_t stateWords;
+	bool bigEndian;
+} OFMultiBufferHashKernel;
+
+@protocol OFMultiBufferHash <OFCryptographicHash>
+/*
+ * Returns NULL if hashing the messages one after another is faster, e.g.
+ * because the CPU has instructions for the hash.
+ */
++ (nullable const OFMultiBufferHashKernel *)of_multiBufferHashKernel;
+
+/* The hash needs to be at a block boundary. */
+- (void)of_getMultiBufferHashState: (uint32_t *)state;
+@end
+
+#ifdef OF_HAVE_MULTI_BUFFER_HASHING
+static OF_INLINE OFMultiBufferHashVector
+OFMultiBufferHashRotateLeft(OFMultiBufferHashVector vector, uint_fast8_t bits)
+{
+	return (vector << bits) | (vector >> (32 - bits));
+}
+
+static OF_INLINE OFMultiBufferHashVector
+OFMultiBufferHashRotateRight(OFMultiBufferHashVector vector, uint_fast8_t bits)
+{
+	return (vector >> bits) | (vector << (32 - bits));
+}
+
+static OF_INLINE OFMultiBufferHashVector
+OFMultiBufferHashLoadWord(const unsigned char *_Nonnull const *_Nonnull blocks,
+    uint_fast8_t index, bool bigEndian)
+{
+	OFMultiBufferHashVector vector;
+
+	for (uint_fast8_t i = 0; i < OFMultiBufferHashLanes; i++) {
+		uint32_t word;
+
+		memcpy(&word, blocks[i] + index * 4, 4);
+		vector[i] = (bigEndian
+		    ? OFFromBigEndian32(word) : OFFromLittleEndian32(word));
+	}
+
+	return vector;
+}
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Hashes each buffer with the specified hash class and writes the digests one
+ * after another to digests. If prefix is not NULL, each message is prefixed
+ * with the block size bytes in prefix, which is how HMAC keys are applied.
+ */
+extern void _OFMultiBufferHash(Class <OFCryptographicHash> hashClass,
+    const unsigned char *_Nullable prefix,
+    const unsigned char *_Nonnull const *_Nonnull buffers,
+    const size_t *lengths, size_t count, unsigned char *digests,
+    bool allowsSwappableMemory) OF_VISIBILITY_HIDDEN;
+#ifdef __cplusplus
+}
+#endif
+
+OF_ASSUME_NONNULL_END
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#import "OFMultiBufferHash.h"
+
+#import "OFOutOfRangeException.h"
+
+struct Lane {
+	/* SIZE_MAX if the lane is idle. */
+	size_t message;
+	const unsigned char *data;
+	size_t blocks;
+	/* The remaining bytes of the message, the padding and the length. */
+	unsigned char tail[128];
+	uint_fast8_t tailBlocks, tailPosition;
+};
+
+struct Context {
+	const OFMultiBufferHashKernel *kernel;
+	const unsigned char *const *buffers;
+	const size_t *lengths;
+	size_t count, next;
+	uint64_t prefixBits;
+	uint32_t initialState[8];
+	uint32_t state[8 * OFMultiBufferHashLanes];
+	struct Lane lanes[OFMultiBufferHashLanes];
+};
+
+static const unsigned char idleBlock[64];
+
+static bool
+startLane(struct Context *context, uint_fast8_t index)
+{
+	struct Lane *lane = &context->lanes[index];
+	size_t length, rest;
+	uint64_t bits;
+
+	if (context->next >= context->count) {
+		lane->message = SIZE_MAX;
+		return false;
+	}
+
+	lane->message = context->next++;
+	length = context->lengths[lane->message];
+	lane->data = context->buffers[lane->message];
+	lane->blocks = length / 64;
+	rest = length % 64;
+
+	if (rest > 0)
+		memcpy(lane->tail, lane->data + lane->blocks * 64, rest);
+	lane->tail[rest] = 0x80;
+	OFZeroMemory(lane->tail + rest + 1, sizeof(lane->tail) - rest - 1);
+	lane->tailBlocks = (rest >= 56 ? 2 : 1);
+	lane->tailPosition = 0;
+
+	bits = context->prefixBits + (uint64_t)length * 8;
+	bits = (context->kernel->bigEndian
+	    ? OFToBigEndian64(bits) : OFToLittleEndian64(bits));
+	memcpy(lane->tail + lane->tailBlocks * 64 - 8, &bits, 8);
+
+	for (uint_fast8_t i = 0; i < context->kernel->stateWords; i++)
+		context->state[i * OFMultiBufferHashLanes + index] =
+		    context->initialState[i];
+
+	return true;
+}
+
+static void
+finishLane(struct Context *context, uint_fast8_t index,
+    unsigned char *digests, size_t digestSize)
+{
+	uint32_t digest[8];
+
+	for (uint_fast8_t i = 0; i < context->kernel->stateWords; i++) {
+		uint32_t word =
+		    context->state[i * OFMultiBufferHashLanes + index];
+
+		digest[i] = (context->kernel->bigEndian
+		    ? OFToBigEndian32(word) : OFToLittleEndian32(word));
+	}
+
+	memcpy(digests + context->lanes[index].message * digestSize, digest,
+	    digestSize);
+	OFZeroMemory(digest, sizeof(digest));
+}
+
+void
+_OFMultiBufferHash(Class <OFCryptographicHash> hashClass,
+    const unsigned char *prefix, const unsigned char *const *buffers,
+    const size_t *lengths, size_t count, unsigned char *digests,
+    bool allowsSwappableMemory)
+{
+	void *pool = objc_autoreleasePoolPush();
+	size_t digestSize = [hashClass digestSize];
+	id <OFCryptographicHash> hash =
+	    [hashClass hashWithAllowsSwappableMemory: allowsSwappableMemory];
+	const OFMultiBufferHashKernel *kernel = NULL;
+	struct Context context;
+	uint_fast8_t active = 0;
+
+	for (size_t i = 0; i < count; i++)
+		if (lengths[i] > SIZE_MAX / 8)
+			@throw [OFOutOfRangeException exception];
+
+	if (prefix != NULL)
+		[hash updateWithBuffer: prefix length: [hashClass blockSize]];
+
+	if (count > 1 &&
+	    [hashClass conformsToProtocol: @protocol(OFMultiBufferHash)])
+		kernel = [(Class <OFMultiBufferHash>)hashClass
+		    of_multiBufferHashKernel];
+
+	if (kernel == NULL) {
+		for (size_t i = 0; i < count; i++) {
+			id <OFCryptographicHash> copy = [hash copy];
+
+			@try {
+				[copy updateWithBuffer: buffers[i]
+						length: lengths[i]];
+				[copy calculate];
+				memcpy(digests + i * digestSize, copy.digest,
+				    digestSize);
+			} @finally {
+				[copy release];
+			}
+		}
+
+		objc_autoreleasePoolPop(pool);
+		return;
+	}
+
+	memset(&context, 0, sizeof(context));
+	context.kernel = kernel;
+	context.buffers = buffers;
+	context.lengths = lengths;
+	context.count = count;
+	context.prefixBits =
+	    (prefix != NULL ? (uint64_t)[hashClass blockSize] * 8 : 0);
+	[(id <OFMultiBufferHash>)hash
+	    of_getMultiBufferHashState: context.initialState];
+
+	for (uint_fast8_t i = 0; i < OFMultiBufferHashLanes; i++)
+		if (startLane(&context, i))
+			active++;
+
+	/*
+	 * Every lane works on its own message and takes the next message as
+	 * soon as it is done, so that messages of different lengths keep all
+	 * lanes busy.
+	 */
+	while (active > 0) {
+		const unsigned char *blocks[OFMultiBufferHashLanes];
+
+		for (uint_fast8_t i = 0; i < OFMultiBufferHashLanes; i++) {
+			struct Lane *lane = &context.lanes[i];
+
+			if (lane->message == SIZE_MAX)
+				blocks[i] = idleBlock;
+			else if (lane->blocks > 0)
+				blocks[i] = lane->data;
+			else
+				blocks[i] =
+				    lane->tail + lane->tailPosition * 64;
+		}
+
+		kernel->processBlocks(context.state, blocks);
+
+		for (uint_fast8_t i = 0; i < OFMultiBufferHashLanes; i++) {
+			struct Lane *lane = &context.lanes[i];
+
+			if (lane->message == SIZE_MAX)
+				continue;
+
+			if (lane->blocks > 0) {
+				lane->data += 64;
+				lane->blocks--;
+				continue;
+			}
+
+			if (++lane->tailPosition < lane->tailBlocks)
+				continue;
+
+			finishLane(&context, i, digests, digestSize);
+
+			if (!startLane(&context, i))
+				active--;
+		}
+	}
+
+	OFZeroMemory(&context, sizeof(context));
+
+	objc_autoreleasePoolPop(pool);
+}
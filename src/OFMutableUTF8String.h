@@ -26,6 +26,8 @@ OF_ASSUME_NONNULL_BEGIN
 {
 	struct OFUTF8StringIvars *restrict _s;
 	struct OFUTF8StringIvars _storage;
+	/* 0 if the C string is allocated with exactly its length + 1. */
+	size_t _capacity;
 }
 @end
 
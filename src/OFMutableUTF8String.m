@@ -45,6 +45,59 @@
 		[self inheritMethodsFromClass: [OFUTF8String class]];
 }
 
+/*
+ * Makes sure there is room for a C string of the specified length plus the
+ * terminating NUL. The buffer grows geometrically so that building a string
+ * by appending to it takes linear instead of quadratic time.
+ */
+static void
+reserveCString(OFMutableUTF8String *self, size_t cStringLength)
+{
+	struct OFUTF8StringIvars *s = self->_s;
+	size_t capacity = self->_capacity;
+
+	if (capacity == 0)
+		capacity = s->cStringLength + 1;
+
+	if (cStringLength < capacity)
+		return;
+
+	if (cStringLength == SIZE_MAX)
+		@throw [OFOutOfRangeException exception];
+
+	if (capacity <= SIZE_MAX / 2)
+		capacity *= 2;
+	if (capacity <= cStringLength)
+		capacity = cStringLength + 1;
+
+	s->cString = OFResizeMemory(s->cString, capacity, 1);
+	self->_capacity = capacity;
+}
+
+/*
+ * Gives memory back after the string got shorter, unless at least a quarter
+ * of the buffer is still in use.
+ */
+static void
+shrinkCString(OFMutableUTF8String *self)
+{
+	struct OFUTF8StringIvars *s = self->_s;
+
+	if (self->_capacity != 0 && s->cStringLength >= self->_capacity / 4)
+		return;
+
+	@try {
+		s->cString = OFResizeMemory(s->cString, s->cStringLength + 1,
+		    1);
+	} @catch (OFOutOfMemoryException *e) {
+		/* We don't really care, as we only made it smaller */
+		if (self->_capacity != 0)
+			return;
+	}
+
+	self->_capacity = s->cStringLength + 1;
+}
+
 - (instancetype)initWithUTF8StringNoCopy: (char *)UTF8String
 			    freeWhenDone: (bool)freeWhenDone
 {
@@ -86,7 +139,7 @@
 
 		OFAssert(startTableSize >= 1 && middleTableSize >= 1);
 
-		_s->hasHash = false;
+		_OFUTF8StringInvalidateCaches(_s);
 
 		for (i = 0; i < _s->cStringLength; i++) {
 			if (isStart)
@@ -183,9 +236,10 @@
 	OFFreeMemory(unicodeString);
 
 	OFFreeMemory(_s->cString);
-	_s->hasHash = false;
+	_OFUTF8StringInvalidateCaches(_s);
 	_s->cString = newCString;
 	_s->cStringLength = newCStringLength;
+	_capacity = newCStringLength + 1;
 
 	/*
 	 * Even though cStringLength can change, length cannot, therefore no
@@ -213,7 +267,7 @@
 
 	/* Shortcut if old and new character both are ASCII */
 	if (character < 0x80 && !(_s->cString[idx] & 0x80)) {
-		_s->hasHash = false;
+		_OFUTF8StringInvalidateCaches(_s);
 		_s->cString[idx] = character;
 		return;
 	}
@@ -225,13 +279,12 @@
 	    _s->cStringLength - idx, &c)) <= 0)
 		@throw [OFInvalidEncodingException exception];
 
-	_s->hasHash = false;
+	_OFUTF8StringInvalidateCaches(_s);
 
 	if (lenNew == (size_t)lenOld)
 		memcpy(_s->cString + idx, buffer, lenNew);
 	else if (lenNew > (size_t)lenOld) {
-		_s->cString = OFResizeMemory(_s->cString,
-		    _s->cStringLength - lenOld + lenNew + 1, 1);
+		reserveCString(self, _s->cStringLength - lenOld + lenNew);
 
 		memmove(_s->cString + idx + lenNew, _s->cString + idx + lenOld,
 		    _s->cStringLength - idx - lenOld);
@@ -255,12 +308,7 @@
 		if (character >= 0x80)
 			_s->isUTF8 = true;
 
-		@try {
-			_s->cString = OFResizeMemory(_s->cString,
-			    _s->cStringLength + 1, 1);
-		} @catch (OFOutOfMemoryException *e) {
-			/* We don't really care, as we only made it smaller */
-		}
+		shrinkCString(self);
 	}
 }
 
@@ -285,9 +333,8 @@
 		@throw [OFInvalidEncodingException exception];
 	}
 
-	_s->hasHash = false;
-	_s->cString = OFResizeMemory(_s->cString,
-	    _s->cStringLength + UTF8StringLength + 1, 1);
+	_OFUTF8StringInvalidateCaches(_s);
+	reserveCString(self, _s->cStringLength + UTF8StringLength);
 	memcpy(_s->cString + _s->cStringLength, UTF8String,
 	    UTF8StringLength + 1);
 
@@ -319,9 +366,8 @@
 		@throw [OFInvalidEncodingException exception];
 	}
 
-	_s->hasHash = false;
-	_s->cString = OFResizeMemory(_s->cString,
-	    _s->cStringLength + UTF8StringLength + 1, 1);
+	_OFUTF8StringInvalidateCaches(_s);
+	reserveCString(self, _s->cStringLength + UTF8StringLength);
 	memcpy(_s->cString + _s->cStringLength, UTF8String, UTF8StringLength);
 
 	_s->cStringLength += UTF8StringLength;
@@ -370,9 +416,8 @@
 	UTF8String = [string insecureCStringWithEncoding: OFStringEncodingUTF8];
 	UTF8StringLength = string.UTF8StringLength;
 
-	_s->hasHash = false;
-	_s->cString = OFResizeMemory(_s->cString,
-	    _s->cStringLength + UTF8StringLength + 1, 1);
+	_OFUTF8StringInvalidateCaches(_s);
+	reserveCString(self, _s->cStringLength + UTF8StringLength);
 	memcpy(_s->cString + _s->cStringLength, UTF8String, UTF8StringLength);
 
 	_s->cStringLength += UTF8StringLength;
@@ -430,9 +475,8 @@
 
 		tmp[j] = '\0';
 
-		_s->hasHash = false;
-		_s->cString = OFResizeMemory(_s->cString,
-		    _s->cStringLength + j + 1, 1);
+		_OFUTF8StringInvalidateCaches(_s);
+		reserveCString(self, _s->cStringLength + j);
 		memcpy(_s->cString + _s->cStringLength, tmp, j + 1);
 
 		_s->cStringLength += j;
@@ -483,8 +527,8 @@
 	UTF8StringLength = string.UTF8StringLength;
 
 	newCStringLength = _s->cStringLength + UTF8StringLength;
-	_s->hasHash = false;
-	_s->cString = OFResizeMemory(_s->cString, newCStringLength + 1, 1);
+	_OFUTF8StringInvalidateCaches(_s);
+	reserveCString(self, newCStringLength);
 
 	memmove(_s->cString + idx + UTF8StringLength, _s->cString + idx,
 	    _s->cStringLength - idx);
@@ -535,7 +579,7 @@
 
 	memmove(_s->cString + start, _s->cString + end,
 	    _s->cStringLength - end);
-	_s->hasHash = false;
+	_OFUTF8StringInvalidateCaches(_s);
 	_s->length -= range.length;
 	_s->cStringLength -= end - start;
 	_s->cString[_s->cStringLength] = 0;
@@ -548,12 +592,7 @@
 				_s->containsNull = true;
 	}
 
-	@try {
-		_s->cString = OFResizeMemory(_s->cString, _s->cStringLength + 1,
-		    1);
-	} @catch (OFOutOfMemoryException *e) {
-		/* We don't really care, as we only made it smaller */
-	}
+	shrinkCString(self);
 }
 
 - (void)replaceCharactersInRange: (OFRange)range
@@ -586,7 +625,7 @@
 
 	newCStringLength =
 	    _s->cStringLength - (end - start) + replacementLength;
-	_s->hasHash = false;
+	_OFUTF8StringInvalidateCaches(_s);
 
 	/*
 	 * If the new string is bigger, we need to resize it first so we can
@@ -597,8 +636,7 @@
 	 * lost due to the resize!
 	 */
 	if (newCStringLength > _s->cStringLength)
-		_s->cString = OFResizeMemory(_s->cString, newCStringLength + 1,
-		    1);
+		reserveCString(self, newCStringLength);
 
 	memmove(_s->cString + start + replacementLength, _s->cString + end,
 	    _s->cStringLength - end);
@@ -609,9 +647,10 @@
 	 * If the new string is smaller, we can safely resize it now as we're
 	 * done with memmove().
 	 */
-	if (newCStringLength < _s->cStringLength)
-		_s->cString = OFResizeMemory(_s->cString, newCStringLength + 1,
-		    1);
+	if (newCStringLength < _s->cStringLength) {
+		_s->cStringLength = newCStringLength;
+		shrinkCString(self);
+	}
 
 	_s->cStringLength = newCStringLength;
 	_s->length = newLength;
@@ -659,7 +698,7 @@
 	    [replacement insecureCStringWithEncoding: OFStringEncodingUTF8];
 	size_t searchLength = string.UTF8StringLength;
 	size_t replacementLength = replacement.UTF8StringLength;
-	size_t last, newCStringLength, newLength;
+	size_t end, count, last, newCStringLength, newLength;
 	char *newCString;
 
 	if (string == nil || replacement == nil)
@@ -677,54 +716,65 @@
 		    _s->cStringLength - range.location);
 	}
 
-	if (string.UTF8StringLength > range.length)
+	if (searchLength == 0 || searchLength > range.length)
 		return;
 
-	newCString = NULL;
-	newCStringLength = 0;
-	newLength = _s->length;
-	last = 0;
-
-	for (size_t i = range.location; i <= range.length - searchLength; i++) {
-		if (memcmp(_s->cString + i, searchString, searchLength) != 0)
-			continue;
+	end = range.location + range.length;
 
-		@try {
-			newCString = OFResizeMemory(newCString,
-			    newCStringLength + i - last + replacementLength + 1,
-			    1);
-		} @catch (id e) {
-			OFFreeMemory(newCString);
-			@throw e;
-		}
-		memcpy(newCString + newCStringLength, _s->cString + last,
-		    i - last);
-		memcpy(newCString + newCStringLength + i - last,
-		    replacementString, replacementLength);
+	/* Count the occurrences first so that the result is allocated once. */
+	count = 0;
+	for (size_t i = range.location;; i += searchLength) {
+		size_t found = _OFUTF8StringFind(_s->cString + i, end - i,
+		    searchString, searchLength);
 
-		newCStringLength += i - last + replacementLength;
-		newLength = newLength - string.length + replacement.length;
+		if (found == OFNotFound)
+			break;
 
-		i += searchLength - 1;
-		last = i + 1;
+		i += found;
+		count++;
 	}
 
-	@try {
-		newCString = OFResizeMemory(newCString,
-		    newCStringLength + _s->cStringLength - last + 1, 1);
-	} @catch (id e) {
-		OFFreeMemory(newCString);
-		@throw e;
+	if (count == 0)
+		return;
+
+	if (replacementLength > searchLength && count >
+	    (SIZE_MAX - 1 - _s->cStringLength) /
+	    (replacementLength - searchLength))
+		@throw [OFOutOfRangeException exception];
+
+	newCStringLength = _s->cStringLength - count * searchLength +
+	    count * replacementLength;
+	newLength = _s->length - count * string.length +
+	    count * replacement.length;
+	newCString = OFAllocMemory(newCStringLength + 1, 1);
+
+	last = 0;
+	newCStringLength = 0;
+	for (size_t i = 0, j = range.location; i < count; i++) {
+		j += _OFUTF8StringFind(_s->cString + j, end - j,
+		    searchString, searchLength);
+
+		memcpy(newCString + newCStringLength, _s->cString + last,
+		    j - last);
+		newCStringLength += j - last;
+		memcpy(newCString + newCStringLength, replacementString,
+		    replacementLength);
+		newCStringLength += replacementLength;
+
+		j += searchLength;
+		last = j;
 	}
+
 	memcpy(newCString + newCStringLength, _s->cString + last,
 	    _s->cStringLength - last);
 	newCStringLength += _s->cStringLength - last;
 	newCString[newCStringLength] = 0;
 
 	OFFreeMemory(_s->cString);
-	_s->hasHash = false;
+	_OFUTF8StringInvalidateCaches(_s);
 	_s->cString = newCString;
 	_s->cStringLength = newCStringLength;
+	_capacity = newCStringLength + 1;
 	_s->length = newLength;
 
 	if ([replacement isKindOfClass: [OFUTF8String class]] ||
@@ -767,19 +817,14 @@
 		if (!OFASCIIIsSpace(_s->cString[i]))
 			break;
 
-	_s->hasHash = false;
+	_OFUTF8StringInvalidateCaches(_s);
 	_s->cStringLength -= i;
 	_s->length -= i;
 
 	memmove(_s->cString, _s->cString + i, _s->cStringLength);
 	_s->cString[_s->cStringLength] = '\0';
 
-	@try {
-		_s->cString = OFResizeMemory(_s->cString, _s->cStringLength + 1,
-		    1);
-	} @catch (OFOutOfMemoryException *e) {
-		/* We don't really care, as we only made it smaller */
-	}
+	shrinkCString(self);
 }
 
 - (void)deleteTrailingWhitespaces
@@ -787,7 +832,7 @@
 	size_t d;
 	char *p;
 
-	_s->hasHash = false;
+	_OFUTF8StringInvalidateCaches(_s);
 
 	d = 0;
 	for (p = _s->cString + _s->cStringLength - 1; p >= _s->cString; p--) {
@@ -801,12 +846,7 @@
 	_s->cStringLength -= d;
 	_s->length -= d;
 
-	@try {
-		_s->cString = OFResizeMemory(_s->cString, _s->cStringLength + 1,
-		    1);
-	} @catch (OFOutOfMemoryException *e) {
-		/* We don't really care, as we only made it smaller */
-	}
+	shrinkCString(self);
 }
 
 - (void)deleteEnclosingWhitespaces
@@ -814,7 +854,7 @@
 	size_t d, i;
 	char *p;
 
-	_s->hasHash = false;
+	_OFUTF8StringInvalidateCaches(_s);
 
 	d = 0;
 	for (p = _s->cString + _s->cStringLength - 1; p >= _s->cString; p--) {
@@ -838,16 +878,20 @@
 	memmove(_s->cString, _s->cString + i, _s->cStringLength);
 	_s->cString[_s->cStringLength] = '\0';
 
-	@try {
-		_s->cString = OFResizeMemory(_s->cString, _s->cStringLength + 1,
-		    1);
-	} @catch (OFOutOfMemoryException *e) {
-		/* We don't really care, as we only made it smaller */
-	}
+	shrinkCString(self);
 }
 
 - (void)makeImmutable
 {
+	if (_capacity > _s->cStringLength + 1) {
+		@try {
+			_s->cString = OFResizeMemory(_s->cString,
+			    _s->cStringLength + 1, 1);
+		} @catch (OFOutOfMemoryException *e) {
+			/* We don't really care, as we only made it smaller */
+		}
+	}
+
 	object_setClass(self, [OFUTF8String class]);
 }
 @end
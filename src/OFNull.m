@@ -22,11 +22,13 @@
 #import "OFNull.h"
 #import "OFData.h"
 #import "OFJSONRepresentationPrivate.h"
+#import "OFMessagePackRepresentationPrivate.h"
 #import "OFString.h"
 
 #import "OFInvalidArgumentException.h"
 
-@interface OFNull () <OFJSONRepresentationPrivate>
+@interface OFNull () <OFJSONRepresentationPrivate,
+    OFMessagePackRepresentationPrivate>
 @end
 
 static OFNull *null = nil;
@@ -54,20 +56,21 @@ static OFNull *null = nil;
 
 - (OFString *)JSONRepresentation
 {
-	return [self of_JSONRepresentationWithOptions: 0 depth: 0];
+	return @"null";
 }
 
 - (OFString *)JSONRepresentationWithOptions:
     (OFJSONRepresentationOptions)options
 {
-	return [self of_JSONRepresentationWithOptions: options depth: 0];
+	return @"null";
 }
 
-- (OFString *)
-    of_JSONRepresentationWithOptions: (OFJSONRepresentationOptions)options
-					 depth: (size_t)depth
+- (void)
+    of_appendJSONRepresentationToString: (OFMutableString *)JSON
+				options: (OFJSONRepresentationOptions)options
+				  depth: (size_t)depth
 {
-	return @"null";
+	[JSON appendString: @"null"];
 }
 
 - (OFData *)messagePackRepresentation
@@ -76,5 +79,11 @@ static OFNull *null = nil;
 	return [OFData dataWithItems: &type count: 1];
 }
 
+- (void)of_appendMessagePackRepresentationToData: (OFMutableData *)data
+{
+	uint8_t type = 0xC0;
+	[data addItem: &type];
+}
+
 OF_SINGLETON_METHODS
 @end
@@ -20,11 +20,13 @@
 #include "config.h"
 
 #include <math.h>
+#include <string.h>
 
 #import "OFNumber.h"
 #import "OFConcreteNumber.h"
 #import "OFData.h"
 #import "OFJSONRepresentationPrivate.h"
+#import "OFMessagePackRepresentationPrivate.h"
 #import "OFString.h"
 #import "OFTaggedPointerNumber.h"
 
@@ -32,7 +34,8 @@
 #import "OFInvalidFormatException.h"
 #import "OFOutOfRangeException.h"
 
-@interface OFNumber () <OFJSONRepresentationPrivate>
+@interface OFNumber () <OFJSONRepresentationPrivate,
+    OFMessagePackRepresentationPrivate>
 @end
 
 @interface OFPlaceholderNumber: OFNumber
@@ -715,141 +718,147 @@ OF_SINGLETON_METHODS
 
 - (OFString *)JSONRepresentation
 {
-	return [self of_JSONRepresentationWithOptions: 0 depth: 0];
+	return [self JSONRepresentationWithOptions: 0];
 }
 
 - (OFString *)JSONRepresentationWithOptions:
     (OFJSONRepresentationOptions)options
 {
-	return [self of_JSONRepresentationWithOptions: options depth: 0];
+	OFMutableString *JSON = [OFMutableString string];
+
+	[self of_appendJSONRepresentationToString: JSON
+					  options: options
+					    depth: 0];
+	[JSON makeImmutable];
+
+	return JSON;
 }
 
-- (OFString *)
-    of_JSONRepresentationWithOptions: (OFJSONRepresentationOptions)options
-			       depth: (size_t)depth
+- (void)
+    of_appendJSONRepresentationToString: (OFMutableString *)JSON
+				options: (OFJSONRepresentationOptions)options
+				  depth: (size_t)depth
 {
 	double doubleValue;
 
-	if (self.objCType[0] == 'B' && self.objCType[1] == '\0')
-		return (self.boolValue ? @"true" : @"false");
+	if (self.objCType[0] == 'B' && self.objCType[1] == '\0') {
+		[JSON appendString: (self.boolValue ? @"true" : @"false")];
+		return;
+	}
 
 	doubleValue = self.doubleValue;
 	if (isinf(doubleValue)) {
 		if (options & OFJSONRepresentationOptionJSON5) {
 			if (doubleValue > 0)
-				return @"Infinity";
+				[JSON appendString: @"Infinity"];
 			else
-				return @"-Infinity";
+				[JSON appendString: @"-Infinity"];
+
+			return;
 		} else
 			@throw [OFInvalidArgumentException exception];
 	}
 
-	return self.description;
+	[JSON appendString: self.description];
 }
 
 - (OFData *)messagePackRepresentation
 {
-	OFMutableData *data;
+	OFMutableData *data = [OFMutableData dataWithCapacity: 9];
+
+	[self of_appendMessagePackRepresentationToData: data];
+	[data makeImmutable];
+
+	return data;
+}
+
+- (void)of_appendMessagePackRepresentationToData: (OFMutableData *)data
+{
 	const char *typeEncoding = self.objCType;
+	unsigned char buffer[9];
+	size_t length;
 
 	if (typeEncoding[0] == '\0' || typeEncoding[1] != '\0')
 		@throw [OFInvalidFormatException exception];
 
 	if (*typeEncoding == 'B') {
-		uint8_t type = (self.boolValue ? 0xC3 : 0xC2);
-		data = [OFMutableData dataWithItems: &type count: 1];
+		buffer[0] = (self.boolValue ? 0xC3 : 0xC2);
+		length = 1;
 	} else if (*typeEncoding == 'f') {
-		uint8_t type = 0xCA;
 		float tmp = OFToBigEndianFloat(self.floatValue);
 
-		data = [OFMutableData dataWithCapacity: 5];
-		[data addItem: &type];
-		[data addItems: &tmp count: sizeof(tmp)];
+		buffer[0] = 0xCA;
+		memcpy(buffer + 1, &tmp, sizeof(tmp));
+		length = 5;
 	} else if (*typeEncoding == 'd') {
-		uint8_t type = 0xCB;
 		double tmp = OFToBigEndianDouble(self.doubleValue);
 
-		data = [OFMutableData dataWithCapacity: 9];
-		[data addItem: &type];
-		[data addItems: &tmp count: sizeof(tmp)];
+		buffer[0] = 0xCB;
+		memcpy(buffer + 1, &tmp, sizeof(tmp));
+		length = 9;
 	} else if (isSigned(self)) {
 		long long value = self.longLongValue;
 
 		if (value >= -32 && value < 0) {
-			uint8_t tmp = 0xE0 | ((uint8_t)(value - 32) & 0x1F);
-
-			data = [OFMutableData dataWithItems: &tmp count: 1];
+			buffer[0] = 0xE0 | ((uint8_t)(value - 32) & 0x1F);
+			length = 1;
 		} else if (value >= INT8_MIN && value <= INT8_MAX) {
-			uint8_t type = 0xD0;
-			int8_t tmp = (int8_t)value;
-
-			data = [OFMutableData dataWithCapacity: 2];
-			[data addItem: &type];
-			[data addItem: &tmp];
+			buffer[0] = 0xD0;
+			buffer[1] = (uint8_t)(int8_t)value;
+			length = 2;
 		} else if (value >= INT16_MIN && value <= INT16_MAX) {
-			uint8_t type = 0xD1;
 			int16_t tmp = OFToBigEndian16((int16_t)value);
 
-			data = [OFMutableData dataWithCapacity: 3];
-			[data addItem: &type];
-			[data addItems: &tmp count: sizeof(tmp)];
+			buffer[0] = 0xD1;
+			memcpy(buffer + 1, &tmp, sizeof(tmp));
+			length = 3;
 		} else if (value >= INT32_MIN && value <= INT32_MAX) {
-			uint8_t type = 0xD2;
 			int32_t tmp = OFToBigEndian32((int32_t)value);
 
-			data = [OFMutableData dataWithCapacity: 5];
-			[data addItem: &type];
-			[data addItems: &tmp count: sizeof(tmp)];
+			buffer[0] = 0xD2;
+			memcpy(buffer + 1, &tmp, sizeof(tmp));
+			length = 5;
 		} else if (value >= INT64_MIN && value <= INT64_MAX) {
-			uint8_t type = 0xD3;
 			int64_t tmp = OFToBigEndian64((int64_t)value);
 
-			data = [OFMutableData dataWithCapacity: 9];
-			[data addItem: &type];
-			[data addItems: &tmp count: sizeof(tmp)];
+			buffer[0] = 0xD3;
+			memcpy(buffer + 1, &tmp, sizeof(tmp));
+			length = 9;
 		} else
 			@throw [OFOutOfRangeException exception];
 	} else if (isUnsigned(self)) {
 		unsigned long long value = self.unsignedLongLongValue;
 
 		if (value <= 127) {
-			uint8_t tmp = ((uint8_t)value & 0x7F);
-			data = [OFMutableData dataWithItems: &tmp count: 1];
+			buffer[0] = ((uint8_t)value & 0x7F);
+			length = 1;
 		} else if (value <= UINT8_MAX) {
-			uint8_t type = 0xCC;
-			uint8_t tmp = (uint8_t)value;
-
-			data = [OFMutableData dataWithCapacity: 2];
-			[data addItem: &type];
-			[data addItem: &tmp];
+			buffer[0] = 0xCC;
+			buffer[1] = (uint8_t)value;
+			length = 2;
 		} else if (value <= UINT16_MAX) {
-			uint8_t type = 0xCD;
 			uint16_t tmp = OFToBigEndian16((uint16_t)value);
 
-			data = [OFMutableData dataWithCapacity: 3];
-			[data addItem: &type];
-			[data addItems: &tmp count: sizeof(tmp)];
+			buffer[0] = 0xCD;
+			memcpy(buffer + 1, &tmp, sizeof(tmp));
+			length = 3;
 		} else if (value <= UINT32_MAX) {
-			uint8_t type = 0xCE;
 			uint32_t tmp = OFToBigEndian32((uint32_t)value);
 
-			data = [OFMutableData dataWithCapacity: 5];
-			[data addItem: &type];
-			[data addItems: &tmp count: sizeof(tmp)];
+			buffer[0] = 0xCE;
+			memcpy(buffer + 1, &tmp, sizeof(tmp));
+			length = 5;
 		} else if (value <= UINT64_MAX) {
-			uint8_t type = 0xCF;
 			uint64_t tmp = OFToBigEndian64((uint64_t)value);
 
-			data = [OFMutableData dataWithCapacity: 9];
-			[data addItem: &type];
-			[data addItems: &tmp count: sizeof(tmp)];
+			buffer[0] = 0xCF;
+			memcpy(buffer + 1, &tmp, sizeof(tmp));
+			length = 9;
 		} else
 			@throw [OFOutOfRangeException exception];
 	} else
 		@throw [OFInvalidFormatException exception];
 
-	[data makeImmutable];
-
-	return data;
+	[data addItems: buffer count: length];
 }
 @end
@@ -114,6 +114,14 @@ OF_DIRECT_MEMBERS
    handler: (nullable OFDatagramSocketPacketReceivedHandler)handler
 # endif
   delegate: (nullable id <OFDatagramSocketDelegate>)delegate;
++ (void)of_addAsyncReceiveForDatagramSocket: (OFDatagramSocket *)socket
+   packets: (OFDatagramSocketPacket *)packets
+     count: (size_t)count
+      mode: (OFRunLoopMode)mode
+# ifdef OF_HAVE_BLOCKS
+   handler: (nullable OFDatagramSocketPacketsReceivedHandler)handler
+# endif
+  delegate: (nullable id <OFDatagramSocketDelegate>)delegate;
 + (void)of_addAsyncSendForDatagramSocket: (OFDatagramSocket *)socket
       data: (OFData *)data
   receiver: (const OFSocketAddress *)receiver
@@ -122,6 +130,14 @@ OF_DIRECT_MEMBERS
    handler: (nullable OFDatagramSocketDataSentHandler)handler
 # endif
   delegate: (nullable id <OFDatagramSocketDelegate>)delegate;
++ (void)of_addAsyncSendForDatagramSocket: (OFDatagramSocket *)socket
+   packets: (const OFDatagramSocketPacket *)packets
+     count: (size_t)count
+      mode: (OFRunLoopMode)mode
+# ifdef OF_HAVE_BLOCKS
+   handler: (nullable OFDatagramSocketPacketsSentHandler)handler
+# endif
+  delegate: (nullable id <OFDatagramSocketDelegate>)delegate;
 + (void)of_addAsyncReceiveForSequencedPacketSocket:
 					       (OFSequencedPacketSocket *)socket
     buffer: (void *)buffer
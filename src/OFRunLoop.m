@@ -29,6 +29,7 @@
 #ifdef OF_HAVE_SOCKETS
 # import "OFKernelEventObserver.h"
 # import "OFDatagramSocket.h"
+# import "OFDatagramSocket+Private.h"
 # import "OFSequencedPacketSocket.h"
 # import "OFSequencedPacketSocket+Private.h"
 # import "OFStreamSocket.h"
@@ -185,6 +186,17 @@ static OFRunLoop *mainRunLoop = nil;
 }
 @end
 
+@interface OFRunLoopDatagramBatchReceiveQueueItem: OFRunLoopQueueItem
+{
+@public
+# ifdef OF_HAVE_BLOCKS
+	OFDatagramSocketPacketsReceivedHandler _handler;
+# endif
+	OFDatagramSocketPacket *_packets;
+	size_t _count, *_lengths;
+}
+@end
+
 @interface OFRunLoopDatagramSendQueueItem: OFRunLoopQueueItem
 {
 @public
@@ -196,6 +208,17 @@ static OFRunLoop *mainRunLoop = nil;
 }
 @end
 
+@interface OFRunLoopDatagramBatchSendQueueItem: OFRunLoopQueueItem
+{
+@public
+# ifdef OF_HAVE_BLOCKS
+	OFDatagramSocketPacketsSentHandler _handler;
+# endif
+	const OFDatagramSocketPacket *_packets;
+	size_t _count, _sentCount;
+}
+@end
+
 @interface OFRunLoopPacketReceiveQueueItem: OFRunLoopQueueItem
 {
 @public
@@ -940,6 +963,51 @@ static OFRunLoop *mainRunLoop = nil;
 # endif
 @end
 
+@implementation OFRunLoopDatagramBatchReceiveQueueItem
+- (bool)handleObject: (id)object
+{
+	size_t count;
+	id exception = nil;
+
+	for (size_t i = 0; i < _count; i++)
+		_packets[i].length = _lengths[i];
+
+	@try {
+		count = [object receivePackets: _packets count: _count];
+	} @catch (id e) {
+		count = 0;
+		exception = e;
+	}
+
+# ifdef OF_HAVE_BLOCKS
+	if (_handler != NULL)
+		return _handler(object, _packets, count, exception);
+	else {
+# endif
+		if (![_delegate respondsToSelector:
+		    @selector(socket:didReceivePackets:count:exception:)])
+			return false;
+
+		return [_delegate socket: object
+		       didReceivePackets: _packets
+				   count: count
+			       exception: exception];
+# ifdef OF_HAVE_BLOCKS
+	}
+# endif
+}
+
+- (void)dealloc
+{
+# ifdef OF_HAVE_BLOCKS
+	[_handler release];
+# endif
+	OFFreeMemory(_lengths);
+
+	[super dealloc];
+}
+@end
+
 @implementation OFRunLoopDatagramSendQueueItem
 - (bool)handleObject: (id)object
 {
@@ -1001,6 +1069,58 @@ static OFRunLoop *mainRunLoop = nil;
 }
 @end
 
+@implementation OFRunLoopDatagramBatchSendQueueItem
+- (bool)handleObject: (id)object
+{
+	id exception = nil;
+	bool repeat;
+
+	@try {
+		while (_sentCount < _count)
+			_sentCount += [object
+			    of_sendPackets: _packets + _sentCount
+				     count: _count - _sentCount];
+	} @catch (OFWriteFailedException *e) {
+		if (e.errNo != EWOULDBLOCK && e.errNo != EAGAIN)
+			exception = e;
+	} @catch (id e) {
+		exception = e;
+	}
+
+	if (_sentCount != _count && exception == nil)
+		return true;
+
+# ifdef OF_HAVE_BLOCKS
+	if (_handler != NULL)
+		repeat = _handler(object, _packets, _sentCount, exception);
+	else {
+# endif
+		if (![_delegate respondsToSelector:
+		    @selector(socket:didSendPackets:count:exception:)])
+			return false;
+
+		repeat = [_delegate socket: object
+			    didSendPackets: _packets
+				     count: _sentCount
+				 exception: exception];
+# ifdef OF_HAVE_BLOCKS
+	}
+# endif
+
+	_sentCount = 0;
+	return repeat;
+}
+
+# ifdef OF_HAVE_BLOCKS
+- (void)dealloc
+{
+	[_handler release];
+
+	[super dealloc];
+}
+# endif
+@end
+
 @implementation OFRunLoopPacketReceiveQueueItem
 - (bool)handleObject: (id)object
 {
@@ -1486,6 +1606,31 @@ stateForMode(OFRunLoop *self, OFRunLoopMode mode, bool create,
 	QUEUE_ITEM
 }
 
++ (void)of_addAsyncReceiveForDatagramSocket: (OFDatagramSocket *)sock
+   packets: (OFDatagramSocketPacket *)packets
+     count: (size_t)count
+      mode: (OFRunLoopMode)mode
+# ifdef OF_HAVE_BLOCKS
+   handler: (OFDatagramSocketPacketsReceivedHandler)handler
+# endif
+  delegate: (id <OFDatagramSocketDelegate>)delegate
+{
+	NEW_READ(OFRunLoopDatagramBatchReceiveQueueItem, sock, mode)
+
+	queueItem->_delegate = [delegate retain];
+# ifdef OF_HAVE_BLOCKS
+	queueItem->_handler = [handler copy];
+# endif
+	queueItem->_packets = packets;
+	queueItem->_count = count;
+	queueItem->_lengths = OFAllocMemory(count, sizeof(size_t));
+
+	for (size_t i = 0; i < count; i++)
+		queueItem->_lengths[i] = packets[i].length;
+
+	QUEUE_ITEM
+}
+
 + (void)of_addAsyncSendForDatagramSocket: (OFDatagramSocket *)sock
       data: (OFData *)data
   receiver: (const OFSocketAddress *)receiver
@@ -1507,6 +1652,27 @@ stateForMode(OFRunLoop *self, OFRunLoopMode mode, bool create,
 	QUEUE_ITEM
 }
 
++ (void)of_addAsyncSendForDatagramSocket: (OFDatagramSocket *)sock
+   packets: (const OFDatagramSocketPacket *)packets
+     count: (size_t)count
+      mode: (OFRunLoopMode)mode
+# ifdef OF_HAVE_BLOCKS
+   handler: (OFDatagramSocketPacketsSentHandler)handler
+# endif
+  delegate: (id <OFDatagramSocketDelegate>)delegate
+{
+	NEW_WRITE(OFRunLoopDatagramBatchSendQueueItem, sock, mode)
+
+	queueItem->_delegate = [delegate retain];
+# ifdef OF_HAVE_BLOCKS
+	queueItem->_handler = [handler copy];
+# endif
+	queueItem->_packets = packets;
+	queueItem->_count = count;
+
+	QUEUE_ITEM
+}
+
 + (void)of_addAsyncReceiveForSequencedPacketSocket: (OFSequencedPacketSocket *)
 							sock
     buffer: (void *)buffer
@@ -22,12 +22,20 @@
 #include <string.h>
 
 #import "OFSHA1Hash.h"
+#import "OFMultiBufferHash.h"
 #import "OFSecureData.h"
+#import "OFSystemInfo.h"
 
 #import "OFHashAlreadyCalculatedException.h"
 #import "OFHashNotCalculatedException.h"
 #import "OFOutOfRangeException.h"
 
+#if (defined(OF_AMD64) || defined(OF_X86)) && \
+    (defined(__clang__) || OF_GCC_VERSION >= 409)
+# define USE_SHA_NI
+# include <immintrin.h>
+#endif
+
 static const size_t digestSize = 20;
 static const size_t blockSize = 64;
 
@@ -36,6 +44,9 @@ OF_DIRECT_MEMBERS
 - (void)of_resetState;
 @end
 
+@interface OFSHA1Hash () <OFMultiBufferHash>
+@end
+
 #define F(a, b, c, d) ((d) ^ ((b) & ((c) ^ (d))))
 #define G(a, b, c, d) ((b) ^ (c) ^ (d))
 #define H(a, b, c, d) (((b) & (c)) | ((d) & ((b) | (c))))
@@ -100,15 +111,166 @@ processBlock(uint32_t *state, uint32_t *buffer)
 	state[4] += new[4];
 }
 
+#ifdef USE_SHA_NI
+__attribute__((__target__("sha,sse4.1")))
+static void
+processBlock_SHANI(uint32_t *state, uint32_t *buffer)
+{
+	const __m128i shuffleMask = _mm_set_epi64x(
+	    0x0001020304050607, 0x08090A0B0C0D0E0F);
+	__m128i abcd, e, previous, saved0, saved1;
+	__m128i message0, message1, message2, message3;
+	uint_fast8_t i;
+
+	abcd = _mm_shuffle_epi32(
+	    _mm_loadu_si128((const __m128i *)(void *)state), 0x1B);
+	e = _mm_set_epi32(state[4], 0, 0, 0);
+
+	saved0 = abcd;
+	saved1 = e;
+
+	message0 = _mm_shuffle_epi8(
+	    _mm_loadu_si128((const __m128i *)(void *)buffer), shuffleMask);
+	message1 = _mm_shuffle_epi8(
+	    _mm_loadu_si128((const __m128i *)(void *)(buffer + 4)),
+	    shuffleMask);
+	message2 = _mm_shuffle_epi8(
+	    _mm_loadu_si128((const __m128i *)(void *)(buffer + 8)),
+	    shuffleMask);
+	message3 = _mm_shuffle_epi8(
+	    _mm_loadu_si128((const __m128i *)(void *)(buffer + 12)),
+	    shuffleMask);
+
+	e = _mm_add_epi32(e, message0);
+
+#define LOOP_BODY(f)							\
+	{								\
+		previous = abcd;					\
+		abcd = _mm_sha1rnds4_epu32(abcd, e, f);			\
+									\
+		if (i < 16) {						\
+			__m128i tmp = _mm_sha1msg2_epu32(_mm_xor_si128(	\
+			    _mm_sha1msg1_epu32(message0, message1),	\
+			    message2), message3);			\
+			message0 = message1;				\
+			message1 = message2;				\
+			message2 = message3;				\
+			message3 = tmp;					\
+		} else {						\
+			message0 = message1;				\
+			message1 = message2;				\
+			message2 = message3;				\
+		}							\
+									\
+		if (i < 19)						\
+			e = _mm_sha1nexte_epu32(previous, message0);	\
+	}
+
+	for (i = 0; i < 5; i++)
+		LOOP_BODY(0)
+	for (; i < 10; i++)
+		LOOP_BODY(1)
+	for (; i < 15; i++)
+		LOOP_BODY(2)
+	for (; i < 20; i++)
+		LOOP_BODY(3)
+
+#undef LOOP_BODY
+
+	e = _mm_sha1nexte_epu32(previous, saved1);
+	abcd = _mm_shuffle_epi32(_mm_add_epi32(abcd, saved0), 0x1B);
+
+	_mm_storeu_si128((__m128i *)(void *)state, abcd);
+	state[4] = _mm_extract_epi32(e, 3);
+}
+#endif
+
+#ifdef OF_HAVE_MULTI_BUFFER_HASHING
+static void
+processBlocks(uint32_t *state, const unsigned char *const *blocks)
+{
+	OFMultiBufferHashVector old[5], new[5], words[80];
+	uint_fast8_t i;
+
+	memcpy(old, state, sizeof(old));
+	memcpy(new, state, sizeof(new));
+
+	for (i = 0; i < 16; i++)
+		words[i] = OFMultiBufferHashLoadWord(blocks, i, true);
+
+	for (i = 16; i < 80; i++)
+		words[i] = OFMultiBufferHashRotateLeft(words[i - 3] ^
+		    words[i - 8] ^ words[i - 14] ^ words[i - 16], 1);
+
+#define LOOP_BODY(f, k)							\
+	{								\
+		OFMultiBufferHashVector tmp =				\
+		    OFMultiBufferHashRotateLeft(new[0], 5) +		\
+		    f(new[0], new[1], new[2], new[3]) +			\
+		    new[4] + (uint32_t)k + words[i];			\
+		new[4] = new[3];					\
+		new[3] = new[2];					\
+		new[2] = OFMultiBufferHashRotateLeft(new[1], 30);	\
+		new[1] = new[0];					\
+		new[0] = tmp;						\
+	}
+
+	for (i = 0; i < 20; i++)
+		LOOP_BODY(F, 0x5A827999)
+	for (; i < 40; i++)
+		LOOP_BODY(G, 0x6ED9EBA1)
+	for (; i < 60; i++)
+		LOOP_BODY(H, 0x8F1BBCDC)
+	for (; i < 80; i++)
+		LOOP_BODY(I, 0xCA62C1D6)
+
+#undef LOOP_BODY
+
+	for (i = 0; i < 5; i++)
+		new[i] += old[i];
+
+	memcpy(state, new, sizeof(new));
+}
+
+static const OFMultiBufferHashKernel multiBufferHashKernel = {
+	processBlocks, 5, true
+};
+#endif
+
+static void (*processBlockImpl)(uint32_t *, uint32_t *) = processBlock;
+
 @implementation OFSHA1Hash
 @synthesize calculated = _calculated;
 @synthesize allowsSwappableMemory = _allowsSwappableMemory;
 
++ (void)initialize
+{
+	if (self != [OFSHA1Hash class])
+		return;
+
+#ifdef USE_SHA_NI
+	if ([OFSystemInfo supportsSHAExtensions] &&
+	    [OFSystemInfo supportsSSE41])
+		processBlockImpl = processBlock_SHANI;
+#endif
+}
+
 + (size_t)digestSize
 {
 	return digestSize;
 }
 
++ (const OFMultiBufferHashKernel *)of_multiBufferHashKernel
+{
+#ifdef OF_HAVE_MULTI_BUFFER_HASHING
+	/* With the SHA extensions, one message at a time is faster. */
+	if (processBlockImpl == processBlock)
+		return &multiBufferHashKernel;
+#endif
+
+	return NULL;
+}
+
 + (size_t)blockSize
 {
 	return blockSize;
@@ -179,6 +341,11 @@ processBlock(uint32_t *state, uint32_t *buffer)
 	return copy;
 }
 
+- (void)of_getMultiBufferHashState: (uint32_t *)state
+{
+	memcpy(state, _iVars->state, sizeof(_iVars->state));
+}
+
 - (void)of_resetState
 {
 	_iVars->state[0] = 0x67452301;
@@ -215,7 +382,7 @@ processBlock(uint32_t *state, uint32_t *buffer)
 		length -= min;
 
 		if (_iVars->bufferLength == 64) {
-			processBlock(_iVars->state, _iVars->buffer.words);
+			processBlockImpl(_iVars->state, _iVars->buffer.words);
 			_iVars->bufferLength = 0;
 		}
 	}
@@ -240,7 +407,7 @@ processBlock(uint32_t *state, uint32_t *buffer)
 	    64 - _iVars->bufferLength - 1);
 
 	if (_iVars->bufferLength >= 56) {
-		processBlock(_iVars->state, _iVars->buffer.words);
+		processBlockImpl(_iVars->state, _iVars->buffer.words);
 		OFZeroMemory(_iVars->buffer.bytes, 64);
 	}
 
@@ -249,7 +416,7 @@ processBlock(uint32_t *state, uint32_t *buffer)
 	_iVars->buffer.words[15] =
 	    OFToBigEndian32((uint32_t)(_iVars->bits & 0xFFFFFFFF));
 
-	processBlock(_iVars->state, _iVars->buffer.words);
+	processBlockImpl(_iVars->state, _iVars->buffer.words);
 	OFZeroMemory(&_iVars->buffer, sizeof(_iVars->buffer));
 	byteSwapVectorIfLE(_iVars->state, 5);
 	_calculated = true;
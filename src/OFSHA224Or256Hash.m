@@ -23,15 +23,23 @@
 #include <string.h>
 
 #import "OFSHA224Or256Hash.h"
+#import "OFMultiBufferHash.h"
 #import "OFSecureData.h"
+#import "OFSystemInfo.h"
 
 #import "OFHashAlreadyCalculatedException.h"
 #import "OFHashNotCalculatedException.h"
 #import "OFOutOfRangeException.h"
 
+#if (defined(OF_AMD64) || defined(OF_X86)) && \
+    (defined(__clang__) || OF_GCC_VERSION >= 409)
+# define USE_SHA_NI
+# include <immintrin.h>
+#endif
+
 static const size_t blockSize = 64;
 
-@interface OFSHA224Or256Hash ()
+@interface OFSHA224Or256Hash () <OFMultiBufferHash>
 - (void)of_resetState;
 @end
 
@@ -120,15 +128,160 @@ processBlock(uint32_t *state, uint32_t *buffer)
 	state[7] += new[7];
 }
 
+#ifdef USE_SHA_NI
+__attribute__((__target__("sha,sse4.1")))
+static void
+processBlock_SHANI(uint32_t *state, uint32_t *buffer)
+{
+	const __m128i shuffleMask = _mm_set_epi64x(
+	    0x0C0D0E0F08090A0B, 0x0405060700010203);
+	__m128i state0, state1, tmp, saved0, saved1;
+	__m128i message0, message1, message2, message3;
+
+	/* ABCD and EFGH need to be rearranged into ABEF and CDGH. */
+	tmp = _mm_shuffle_epi32(
+	    _mm_loadu_si128((const __m128i *)(void *)state), 0xB1);
+	state1 = _mm_shuffle_epi32(
+	    _mm_loadu_si128((const __m128i *)(void *)(state + 4)), 0x1B);
+	state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+	saved0 = state0;
+	saved1 = state1;
+
+	message0 = _mm_shuffle_epi8(
+	    _mm_loadu_si128((const __m128i *)(void *)buffer), shuffleMask);
+	message1 = _mm_shuffle_epi8(
+	    _mm_loadu_si128((const __m128i *)(void *)(buffer + 4)),
+	    shuffleMask);
+	message2 = _mm_shuffle_epi8(
+	    _mm_loadu_si128((const __m128i *)(void *)(buffer + 8)),
+	    shuffleMask);
+	message3 = _mm_shuffle_epi8(
+	    _mm_loadu_si128((const __m128i *)(void *)(buffer + 12)),
+	    shuffleMask);
+
+	for (uint_fast8_t i = 0; i < 16; i++) {
+		__m128i message = _mm_add_epi32(message0,
+		    _mm_loadu_si128((const __m128i *)(void *)(table + i * 4)));
+
+		state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+		state0 = _mm_sha256rnds2_epu32(state0, state1,
+		    _mm_shuffle_epi32(message, 0x0E));
+
+		if (i < 12)
+			tmp = _mm_sha256msg2_epu32(_mm_add_epi32(
+			    _mm_sha256msg1_epu32(message0, message1),
+			    _mm_alignr_epi8(message3, message2, 4)), message3);
+
+		message0 = message1;
+		message1 = message2;
+		message2 = message3;
+		message3 = tmp;
+	}
+
+	state0 = _mm_add_epi32(state0, saved0);
+	state1 = _mm_add_epi32(state1, saved1);
+
+	tmp = _mm_shuffle_epi32(state0, 0x1B);
+	state1 = _mm_shuffle_epi32(state1, 0xB1);
+	_mm_storeu_si128((__m128i *)(void *)state,
+	    _mm_blend_epi16(tmp, state1, 0xF0));
+	_mm_storeu_si128((__m128i *)(void *)(state + 4),
+	    _mm_alignr_epi8(state1, tmp, 8));
+}
+#endif
+
+#ifdef OF_HAVE_MULTI_BUFFER_HASHING
+# define ROTR OFMultiBufferHashRotateRight
+static void
+processBlocks(uint32_t *state, const unsigned char *const *blocks)
+{
+	OFMultiBufferHashVector old[8], new[8], words[64];
+	uint_fast8_t i;
+
+	memcpy(old, state, sizeof(old));
+	memcpy(new, state, sizeof(new));
+
+	for (i = 0; i < 16; i++)
+		words[i] = OFMultiBufferHashLoadWord(blocks, i, true);
+
+	for (i = 16; i < 64; i++) {
+		OFMultiBufferHashVector tmp;
+
+		tmp = words[i - 2];
+		words[i] = (ROTR(tmp, 17) ^ ROTR(tmp, 19) ^ (tmp >> 10)) +
+		    words[i - 7];
+		tmp = words[i - 15];
+		words[i] += (ROTR(tmp, 7) ^ ROTR(tmp, 18) ^ (tmp >> 3)) +
+		    words[i - 16];
+	}
+
+	for (i = 0; i < 64; i++) {
+		OFMultiBufferHashVector tmp1 = new[7] +
+		    (ROTR(new[4], 6) ^ ROTR(new[4], 11) ^ ROTR(new[4], 25)) +
+		    ((new[4] & (new[5] ^ new[6])) ^ new[6]) +
+		    table[i] + words[i];
+		OFMultiBufferHashVector tmp2 =
+		    (ROTR(new[0], 2) ^ ROTR(new[0], 13) ^ ROTR(new[0], 22)) +
+		    ((new[0] & (new[1] | new[2])) | (new[1] & new[2]));
+
+		new[7] = new[6];
+		new[6] = new[5];
+		new[5] = new[4];
+		new[4] = new[3] + tmp1;
+		new[3] = new[2];
+		new[2] = new[1];
+		new[1] = new[0];
+		new[0] = tmp1 + tmp2;
+	}
+
+	for (i = 0; i < 8; i++)
+		new[i] += old[i];
+
+	memcpy(state, new, sizeof(new));
+}
+# undef ROTR
+
+static const OFMultiBufferHashKernel multiBufferHashKernel = {
+	processBlocks, 8, true
+};
+#endif
+
+static void (*processBlockImpl)(uint32_t *, uint32_t *) = processBlock;
+
 @implementation OFSHA224Or256Hash
 @synthesize calculated = _calculated;
 @synthesize allowsSwappableMemory = _allowsSwappableMemory;
 
++ (void)initialize
+{
+	if (self != [OFSHA224Or256Hash class])
+		return;
+
+#ifdef USE_SHA_NI
+	if ([OFSystemInfo supportsSHAExtensions] &&
+	    [OFSystemInfo supportsSSE41])
+		processBlockImpl = processBlock_SHANI;
+#endif
+}
+
 + (size_t)digestSize
 {
 	OF_UNRECOGNIZED_SELECTOR
 }
 
++ (const OFMultiBufferHashKernel *)of_multiBufferHashKernel
+{
+#ifdef OF_HAVE_MULTI_BUFFER_HASHING
+	/* With the SHA extensions, one message at a time is faster. */
+	if (processBlockImpl == processBlock)
+		return &multiBufferHashKernel;
+#endif
+
+	return NULL;
+}
+
 + (size_t)blockSize
 {
 	return blockSize;
@@ -231,7 +384,7 @@ processBlock(uint32_t *state, uint32_t *buffer)
 		length -= min;
 
 		if (_iVars->bufferLength == 64) {
-			processBlock(_iVars->state, _iVars->buffer.words);
+			processBlockImpl(_iVars->state, _iVars->buffer.words);
 			_iVars->bufferLength = 0;
 		}
 	}
@@ -256,7 +409,7 @@ processBlock(uint32_t *state, uint32_t *buffer)
 	    64 - _iVars->bufferLength - 1);
 
 	if (_iVars->bufferLength >= 56) {
-		processBlock(_iVars->state, _iVars->buffer.words);
+		processBlockImpl(_iVars->state, _iVars->buffer.words);
 		OFZeroMemory(_iVars->buffer.bytes, 64);
 	}
 
@@ -265,7 +418,7 @@ processBlock(uint32_t *state, uint32_t *buffer)
 	_iVars->buffer.words[15] =
 	    OFToBigEndian32((uint32_t)(_iVars->bits & 0xFFFFFFFF));
 
-	processBlock(_iVars->state, _iVars->buffer.words);
+	processBlockImpl(_iVars->state, _iVars->buffer.words);
 	OFZeroMemory(&_iVars->buffer, sizeof(_iVars->buffer));
 	byteSwapVectorIfLE(_iVars->state, 8);
 	_calculated = true;
@@ -280,6 +433,11 @@ processBlock(uint32_t *state, uint32_t *buffer)
 	_calculated = false;
 }
 
+- (void)of_getMultiBufferHashState: (uint32_t *)state
+{
+	memcpy(state, _iVars->state, sizeof(_iVars->state));
+}
+
 - (void)of_resetState
 {
 	OF_UNRECOGNIZED_SELECTOR
@@ -60,6 +60,19 @@ typedef struct {
 	size_t keyLength;
 	/** @brief Whether data may be stored in swappable memory. */
 	bool allowsSwappableMemory;
+	/**
+	 * @brief The maximum number of threads to use for the parallelization.
+	 *
+	 * The independent parallelization lanes are distributed over up to
+	 * this many threads, including the calling thread. Each thread needs
+	 * its own scratch memory of the size required for a single lane.
+	 *
+	 * The number of threads is further limited to the number of CPUs and
+	 * to at most 64.
+	 *
+	 * 0 and 1 both mean that all lanes are computed in the calling thread.
+	 */
+	size_t numberOfThreads;
 } OFScryptParameters;
 
 #ifdef __cplusplus
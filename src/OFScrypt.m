@@ -29,6 +29,24 @@
 
 #import "OFScrypt.h"
 #import "OFPBKDF2.h"
+#ifdef OF_HAVE_THREADS
+# import "OFPlainThread.h"
+# import "OFSystemInfo.h"
+#endif
+
+#ifdef OF_HAVE_THREADS
+/*
+ * Upper bound for the number of threads, as the parallelization and thus the
+ * requested number of threads is not necessarily trusted.
+ */
+static const size_t maxNumberOfThreads = 64;
+
+struct ROMixThread {
+	uint32_t *buffer, *tmp;
+	size_t blockSize, costFactor, parallelization;
+	size_t firstLane, laneStep;
+};
+#endif
 
 void
 _OFSalsa20_8Core(uint32_t buffer[16])
@@ -141,11 +159,67 @@ _OFScryptROMix(uint32_t *buffer, size_t blockSize, size_t costFactor,
 	}
 }
 
+#ifdef OF_HAVE_THREADS
+static void
+ROMixLanes(struct ROMixThread *thread)
+{
+	for (size_t i = thread->firstLane; i < thread->parallelization;
+	    i += thread->laneStep)
+		_OFScryptROMix(thread->buffer + i * 32 * thread->blockSize,
+		    thread->blockSize, thread->costFactor, thread->tmp);
+}
+
+static void
+ROMixThreadMain(id object)
+{
+	ROMixLanes((struct ROMixThread *)(void *)object);
+}
+
+/*
+ * The lanes are independent, so lane i is computed by thread i % count. If a
+ * thread cannot be created, its lanes are computed by the calling thread.
+ */
+static void
+ROMixInThreads(uint32_t *buffer, size_t blockSize, size_t costFactor,
+    size_t parallelization, uint32_t *tmp, size_t count)
+{
+	struct ROMixThread threads[count];
+	OFPlainThread plainThreads[count];
+	bool started[count];
+	OFPlainThreadAttributes attr;
+	bool haveAttr = (OFPlainThreadAttributesInit(&attr) == 0);
+
+	for (size_t i = 0; i < count; i++) {
+		threads[i].buffer = buffer;
+		threads[i].tmp = tmp + i * (costFactor + 1) * 32 * blockSize;
+		threads[i].blockSize = blockSize;
+		threads[i].costFactor = costFactor;
+		threads[i].parallelization = parallelization;
+		threads[i].firstLane = i;
+		threads[i].laneStep = count;
+
+		started[i] = (i > 0 && haveAttr && OFPlainThreadNew(
+		    &plainThreads[i], "OFScrypt", ROMixThreadMain,
+		    (id)(void *)&threads[i], &attr) == 0);
+	}
+
+	ROMixLanes(&threads[0]);
+
+	for (size_t i = 1; i < count; i++) {
+		if (started[i])
+			OFPlainThreadJoin(plainThreads[i]);
+		else
+			ROMixLanes(&threads[i]);
+	}
+}
+#endif
+
 void
 OFScrypt(OFScryptParameters param)
 {
 	OFSecureData *tmp = nil, *buffer = nil;
 	OFHMAC *HMAC = nil;
+	size_t numberOfThreads = 1;
 
 	if (param.blockSize == 0 || param.costFactor <= 1 ||
 	    (param.costFactor & (param.costFactor - 1)) != 0 ||
@@ -167,8 +241,27 @@ OFScrypt(OFScryptParameters param)
 		    (param.costFactor + 1) > SIZE_MAX / 128)
 			@throw [OFOutOfRangeException exception];
 
+#ifdef OF_HAVE_THREADS
+		if (param.numberOfThreads > 1) {
+			size_t numberOfCPUs = [OFSystemInfo numberOfCPUs];
+
+			numberOfThreads = param.numberOfThreads;
+
+			if (numberOfThreads > param.parallelization)
+				numberOfThreads = param.parallelization;
+			if (numberOfCPUs > 0 && numberOfThreads > numberOfCPUs)
+				numberOfThreads = numberOfCPUs;
+			if (numberOfThreads > maxNumberOfThreads)
+				numberOfThreads = maxNumberOfThreads;
+		}
+
+		if ((param.costFactor + 1) * 128 > SIZE_MAX / numberOfThreads)
+			@throw [OFOutOfRangeException exception];
+#endif
+
 		tmp = [[OFSecureData alloc]
-			    initWithCount: (param.costFactor + 1) * 128
+			    initWithCount: (param.costFactor + 1) * 128 *
+					   numberOfThreads
 				 itemSize: param.blockSize
 		    allowsSwappableMemory: param.allowsSwappableMemory];
 		tmpItems = tmp.mutableItems;
@@ -199,9 +292,18 @@ OFScrypt(OFScryptParameters param)
 			.allowsSwappableMemory = param.allowsSwappableMemory
 		});
 
-		for (size_t i = 0; i < param.parallelization; i++)
-			_OFScryptROMix(bufferItems + i * 32 * param.blockSize,
-			    param.blockSize, param.costFactor, tmpItems);
+#ifdef OF_HAVE_THREADS
+		if (numberOfThreads > 1)
+			ROMixInThreads(bufferItems, param.blockSize,
+			    param.costFactor, param.parallelization, tmpItems,
+			    numberOfThreads);
+		else
+#endif
+			for (size_t i = 0; i < param.parallelization; i++)
+				_OFScryptROMix(
+				    bufferItems + i * 32 * param.blockSize,
+				    param.blockSize, param.costFactor,
+				    tmpItems);
 
 		OFPBKDF2((OFPBKDF2Parameters){
 			.HMAC                  = HMAC,
@@ -27,6 +27,7 @@
 #endif
 
 #import "OFSecureData.h"
+#import "OFMessagePackRepresentationPrivate.h"
 #import "OFString.h"
 #import "OFSystemInfo.h"
 #ifdef OF_HAVE_THREADS
@@ -667,4 +668,9 @@ freeMemory(struct Page *page, void *pointer, size_t bytes)
 {
 	OF_UNRECOGNIZED_SELECTOR
 }
+
+- (void)of_appendMessagePackRepresentationToData: (OFMutableData *)data
+{
+	OF_UNRECOGNIZED_SELECTOR
+}
 @end
@@ -39,8 +39,43 @@
 
 int _OFString_JSONParsing_reference;
 
+/*
+ * Dictionary keys tend to repeat a lot, e.g. in an array of objects. Recently
+ * seen keys are therefore kept in a small cache indexed by their hash, so that
+ * repeated keys don't need to be allocated again.
+ */
+#define keyCacheSize 64
+
+struct keyCache {
+	OFString *keys[keyCacheSize];
+};
+
 static id nextObject(const char **pointer, const char *stop, size_t *line,
-    size_t depthLimit);
+    size_t depthLimit, struct keyCache *keyCache);
+
+static OFString *
+cachedKey(struct keyCache *keyCache, const char *bytes, size_t length)
+{
+	unsigned long hash;
+	OFString **slot, *key;
+
+	OFHashInit(&hash);
+	for (size_t i = 0; i < length; i++)
+		OFHashAddByte(&hash, bytes[i]);
+	OFHashFinalize(&hash);
+
+	slot = &keyCache->keys[hash % keyCacheSize];
+
+	if (*slot != nil && (*slot).UTF8StringLength == length &&
+	    memcmp((*slot).UTF8String, bytes, length) == 0)
+		return [[*slot retain] autorelease];
+
+	key = [[OFString alloc] initWithUTF8String: bytes length: length];
+	[*slot release];
+	*slot = key;
+
+	return [[key retain] autorelease];
+}
 
 static void
 skipWhitespaces(const char **pointer, const char *stop, size_t *line)
@@ -169,8 +204,12 @@ parseHexEscape(const char *pointer, const char *stop)
 }
 
 static inline OFString *
-parseString(const char **pointer, const char *stop, size_t *line)
+parseString(const char **pointer, const char *stop, size_t *line,
+    struct keyCache *keyCache)
 {
+	const char *end;
+	bool hasEscapes = false;
+	size_t lines = 0;
 	char *buffer;
 	size_t i = 0;
 	char delimiter = **pointer;
@@ -178,7 +217,51 @@ parseString(const char **pointer, const char *stop, size_t *line)
 	if (++(*pointer) + 1 >= stop)
 		return nil;
 
-	buffer = OFAllocMemory(stop - *pointer, 1);
+	/*
+	 * Find the end of the string first. As escape sequences never expand,
+	 * this is also an upper bound for the decoded length.
+	 */
+	for (end = *pointer; end < stop && *end != delimiter; end++) {
+		if (*end == '\\') {
+			hasEscapes = true;
+
+			if (++end >= stop)
+				break;
+
+			if (*end == '\n')
+				lines++;
+			else if (*end == '\r' && end + 1 < stop &&
+			    end[1] == '\n') {
+				end++;
+				lines++;
+			}
+		/* Newlines in strings are disallowed */
+		} else if (*end == '\n' || *end == '\r') {
+			*line += lines + 1;
+			return nil;
+		}
+	}
+
+	if (end >= stop) {
+		*line += lines;
+		return nil;
+	}
+
+	if (!hasEscapes) {
+		OFString *ret;
+
+		if (keyCache != NULL)
+			ret = cachedKey(keyCache, *pointer, end - *pointer);
+		else
+			ret = [OFString stringWithUTF8String: *pointer
+						      length: end - *pointer];
+
+		*pointer = end + 1;
+
+		return ret;
+	}
+
+	buffer = OFAllocMemory(end - *pointer, 1);
 
 	while (*pointer < stop) {
 		/* Parse escape codes */
@@ -338,20 +421,61 @@ parseString(const char **pointer, const char *stop, size_t *line)
 	return nil;
 }
 
+static inline bool
+isIdentifierCharacter(char c)
+{
+	return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+	    (c >= '0' && c <= '9') || c == '_' || c == '$' || (c & 0x80));
+}
+
 static inline OFString *
-parseIdentifier(const char **pointer, const char *stop)
+parseIdentifier(const char **pointer, const char *stop,
+    struct keyCache *keyCache)
 {
+	const char *end;
+	bool hasEscapes = false;
 	char *buffer;
 	size_t i = 0;
 
-	buffer = OFAllocMemory(stop - *pointer, 1);
+	/*
+	 * Find the end of the identifier first. As escape sequences never
+	 * expand, this is also an upper bound for the decoded length.
+	 */
+	for (end = *pointer; end < stop; end++) {
+		if (*end == '\\') {
+			hasEscapes = true;
+
+			if (stop - end <= 6)
+				return nil;
+
+			end += 5;
+		} else if (!isIdentifierCharacter(*end))
+			break;
+	}
+
+	/*
+	 * It is never possible to end with an identifier, thus we should never
+	 * reach stop.
+	 */
+	if (end >= stop || end == *pointer)
+		return nil;
+
+	if (!hasEscapes) {
+		OFString *ret;
+
+		if (**pointer >= '0' && **pointer <= '9')
+			return nil;
+
+		ret = cachedKey(keyCache, *pointer, end - *pointer);
+		*pointer = end;
+
+		return ret;
+	}
+
+	buffer = OFAllocMemory(end - *pointer, 1);
 
 	while (*pointer < stop) {
-		if ((**pointer >= 'a' && **pointer <= 'z') ||
-		    (**pointer >= 'A' && **pointer <= 'Z') ||
-		    (**pointer >= '0' && **pointer <= '9') ||
-		    **pointer == '_' || **pointer == '$' ||
-		    (**pointer & 0x80)) {
+		if (isIdentifierCharacter(**pointer)) {
 			buffer[i++] = **pointer;
 			(*pointer)++;
 		} else if (**pointer == '\\') {
@@ -440,7 +564,7 @@ parseIdentifier(const char **pointer, const char *stop)
 
 static inline OFMutableArray *
 parseArray(const char **pointer, const char *stop, size_t *line,
-    size_t depthLimit)
+    size_t depthLimit, struct keyCache *keyCache)
 {
 	OFMutableArray *array = [OFMutableArray array];
 
@@ -470,7 +594,7 @@ parseArray(const char **pointer, const char *stop, size_t *line,
 			break;
 		}
 
-		object = nextObject(pointer, stop, line, depthLimit);
+		object = nextObject(pointer, stop, line, depthLimit, keyCache);
 		if (object == nil)
 			return nil;
 
@@ -497,7 +621,7 @@ parseArray(const char **pointer, const char *stop, size_t *line,
 
 static inline OFMutableDictionary *
 parseDictionary(const char **pointer, const char *stop, size_t *line,
-    size_t depthLimit)
+    size_t depthLimit, struct keyCache *keyCache)
 {
 	OFMutableDictionary *dictionary = [OFMutableDictionary dictionary];
 
@@ -535,9 +659,12 @@ parseDictionary(const char **pointer, const char *stop, size_t *line,
 		if ((**pointer >= 'a' && **pointer <= 'z') ||
 		    (**pointer >= 'A' && **pointer <= 'Z') ||
 		    **pointer == '_' || **pointer == '$' || **pointer == '\\')
-			key = parseIdentifier(pointer, stop);
+			key = parseIdentifier(pointer, stop, keyCache);
+		else if (**pointer == '"' || **pointer == '\'')
+			key = parseString(pointer, stop, line, keyCache);
 		else
-			key = nextObject(pointer, stop, line, depthLimit);
+			key = nextObject(pointer, stop, line, depthLimit,
+			    keyCache);
 
 		if (![key isKindOfClass: [OFString class]])
 			return nil;
@@ -548,7 +675,7 @@ parseDictionary(const char **pointer, const char *stop, size_t *line,
 
 		(*pointer)++;
 
-		object = nextObject(pointer, stop, line, depthLimit);
+		object = nextObject(pointer, stop, line, depthLimit, keyCache);
 		if (object == nil)
 			return nil;
 
@@ -597,6 +724,35 @@ parseNumber(const char **pointer, const char *stop, size_t *line)
 		}
 	}
 
+	/*
+	 * Plain decimal integers are by far the most common numbers, so parse
+	 * them without creating a string first.
+	 */
+	if (!hasDecimal && i > (size_t)isNegative && i - isNegative <= 18) {
+		const char *digits = *pointer + isNegative;
+		size_t numDigits = i - isNegative;
+		unsigned long long value = 0;
+		size_t j;
+
+		for (j = 0; j < numDigits; j++) {
+			if (digits[j] < '0' || digits[j] > '9')
+				break;
+
+			value = value * 10 + (digits[j] - '0');
+		}
+
+		/* A leading 0 means octal or hexadecimal. */
+		if (j == numDigits && (digits[0] != '0' || numDigits == 1)) {
+			*pointer += i;
+
+			if (isNegative)
+				return [OFNumber numberWithLongLong:
+				    -(long long)value];
+
+			return [OFNumber numberWithUnsignedLongLong: value];
+		}
+	}
+
 	string = [[OFString alloc] initWithUTF8String: *pointer length: i];
 	*pointer += i;
 
@@ -623,7 +779,7 @@ parseNumber(const char **pointer, const char *stop, size_t *line)
 
 static id
 nextObject(const char **pointer, const char *stop, size_t *line,
-    size_t depthLimit)
+    size_t depthLimit, struct keyCache *keyCache)
 {
 	skipWhitespacesAndComments(pointer, stop, line);
 
@@ -633,11 +789,12 @@ nextObject(const char **pointer, const char *stop, size_t *line,
 	switch (**pointer) {
 	case '"':
 	case '\'':
-		return parseString(pointer, stop, line);
+		return parseString(pointer, stop, line, NULL);
 	case '[':
-		return parseArray(pointer, stop, line, depthLimit);
+		return parseArray(pointer, stop, line, depthLimit, keyCache);
 	case '{':
-		return parseDictionary(pointer, stop, line, depthLimit);
+		return parseDictionary(pointer, stop, line, depthLimit,
+		    keyCache);
 	case 't':
 		if (*pointer + 3 >= stop)
 			return nil;
@@ -688,6 +845,33 @@ nextObject(const char **pointer, const char *stop, size_t *line,
 	}
 }
 
+id
+_OFJSONParse(const char *UTF8String, size_t length, size_t depthLimit,
+    size_t *line)
+{
+	const char *pointer = UTF8String;
+	const char *stop = pointer + length;
+	struct keyCache keyCache;
+	id object;
+
+	memset(&keyCache, 0, sizeof(keyCache));
+	*line = 1;
+
+	@try {
+		object = nextObject(&pointer, stop, line, depthLimit,
+		    &keyCache);
+		skipWhitespacesAndComments(&pointer, stop, line);
+	} @finally {
+		for (size_t i = 0; i < keyCacheSize; i++)
+			[keyCache.keys[i] release];
+	}
+
+	if (pointer < stop)
+		return nil;
+
+	return object;
+}
+
 @implementation OFString (JSONParsing)
 - (id)objectByParsingJSON
 {
@@ -697,15 +881,13 @@ nextObject(const char **pointer, const char *stop, size_t *line,
 - (id)objectByParsingJSONWithDepthLimit: (size_t)depthLimit
 {
 	void *pool = objc_autoreleasePoolPush();
-	const char *pointer = self.UTF8String;
-	const char *stop = pointer + self.UTF8StringLength;
 	id object;
-	size_t line = 1;
+	size_t line;
 
-	object = nextObject(&pointer, stop, &line, depthLimit);
-	skipWhitespacesAndComments(&pointer, stop, &line);
+	object = _OFJSONParse(self.UTF8String, self.UTF8StringLength,
+	    depthLimit, &line);
 
-	if (pointer < stop || object == nil)
+	if (object == nil)
 		@throw [OFInvalidJSONException exceptionWithString: self
 							      line: line];
 
@@ -28,6 +28,10 @@ extern char *_Nullable _OFStrDup(const char *_Nonnull) OF_VISIBILITY_HIDDEN;
 extern size_t _OFUTF8StringEncode(OFUnichar, char *) OF_VISIBILITY_HIDDEN;
 extern ssize_t _OFUTF8StringDecode(const char *, size_t, OFUnichar *)
     OF_VISIBILITY_HIDDEN;
+extern unsigned long _OFUTF8StringHash(const char *, size_t)
+    OF_VISIBILITY_HIDDEN;
+extern id _Nullable _OFJSONParse(const char *, size_t, size_t, size_t *)
+    OF_VISIBILITY_HIDDEN;
 #ifdef __cplusplus
 }
 #endif
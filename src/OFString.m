@@ -47,6 +47,7 @@
 #import "OFIRI.h"
 #import "OFIRIHandler.h"
 #import "OFJSONRepresentationPrivate.h"
+#import "OFMessagePackRepresentationPrivate.h"
 #import "OFLocale.h"
 #import "OFStream.h"
 #import "OFSystemInfo.h"
@@ -101,7 +102,8 @@ static locale_t cLocale;
 #endif
 
 OF_DIRECT_MEMBERS
-@interface OFString () <OFJSONRepresentationPrivate>
+@interface OFString () <OFJSONRepresentationPrivate,
+    OFMessagePackRepresentationPrivate>
 - (size_t)of_getCString: (char *)cString
 	      maxLength: (size_t)maxLength
 	       encoding: (OFStringEncoding)encoding
@@ -344,6 +346,48 @@ _OFUTF8StringDecode(const char *buffer_, size_t length, OFUnichar *ret)
 	return 0;
 }
 
+/*
+ * All strings hash their UTF-8 representation with this, so that equal strings
+ * have the same hash independent of their class. It processes 8 bytes at a
+ * time and is seeded with the same per-process seed as OFHashInit().
+ */
+unsigned long
+_OFUTF8StringHash(const char *UTF8String, size_t length)
+{
+	const uint64_t multiplier = UINT64_C(0x9E3779B97F4A7C15);
+	unsigned long seed;
+	uint64_t hash;
+
+	OFHashInit(&seed);
+	hash = (uint64_t)seed ^ ((uint64_t)length * multiplier);
+
+	for (; length >= 8; UTF8String += 8, length -= 8) {
+		uint64_t word;
+
+		memcpy(&word, UTF8String, 8);
+
+		hash = (hash ^ word) * multiplier;
+		hash ^= hash >> 29;
+	}
+
+	if (length > 0) {
+		uint64_t word = 0;
+
+		memcpy(&word, UTF8String, length);
+
+		hash = (hash ^ word) * multiplier;
+	}
+
+	/* Final avalanche, taken from MurmurHash3's fmix64. */
+	hash ^= hash >> 33;
+	hash *= UINT64_C(0xFF51AFD7ED558CCD);
+	hash ^= hash >> 33;
+	hash *= UINT64_C(0xC4CEB9FE1A85EC53);
+	hash ^= hash >> 33;
+
+	return (unsigned long)(hash ^ (hash >> 32));
+}
+
 size_t
 OFUTF16StringLength(const OFChar16 *string)
 {
@@ -394,6 +438,32 @@ isASCIIWithoutNull(const char *string, size_t length)
 }
 #endif
 
+static bool
+isJSON5Identifier(const char *string, size_t length)
+{
+	if (length == 0 || (!OFASCIIIsAlpha(string[0]) &&
+	    string[0] != '_' && string[0] != '$'))
+		return false;
+
+	for (size_t i = 0; i < length; i++) {
+		switch (string[i]) {
+		case ' ':
+		case '\n':
+		case '\r':
+		case '\t':
+		case '\b':
+		case '\f':
+		case '\\':
+		case '"':
+		case '\'':
+		case '\0':
+			return false;
+		}
+	}
+
+	return true;
+}
+
 @implementation OFPlaceholderString
 #ifdef __clang__
 /* We intentionally don't call into super, so silence the warning. */
@@ -1790,21 +1860,11 @@ OF_SINGLETON_METHODS
 
 - (unsigned long)hash
 {
-	const OFUnichar *characters = self.characters;
-	size_t length = self.length;
-	unsigned long hash;
-
-	OFHashInit(&hash);
-
-	for (size_t i = 0; i < length; i++) {
-		const OFUnichar c = characters[i];
-
-		OFHashAddByte(&hash, (c & 0xFF0000) >> 16);
-		OFHashAddByte(&hash, (c & 0x00FF00) >> 8);
-		OFHashAddByte(&hash, c & 0x0000FF);
-	}
+	void *pool = objc_autoreleasePoolPush();
+	unsigned long hash = _OFUTF8StringHash(self.UTF8String,
+	    self.UTF8StringLength);
 
-	OFHashFinalize(&hash);
+	objc_autoreleasePoolPop(pool);
 
 	return hash;
 }
@@ -1816,99 +1876,133 @@ OF_SINGLETON_METHODS
 
 - (OFString *)JSONRepresentation
 {
-	return [self of_JSONRepresentationWithOptions: 0 depth: 0];
+	return [self JSONRepresentationWithOptions: 0];
 }
 
 - (OFString *)JSONRepresentationWithOptions:
     (OFJSONRepresentationOptions)options
 {
-	return [self of_JSONRepresentationWithOptions: options depth: 0];
+	OFMutableString *JSON = [OFMutableString string];
+
+	[self of_appendJSONRepresentationToString: JSON
+					  options: options
+					    depth: 0];
+	[JSON makeImmutable];
+
+	return JSON;
 }
 
-- (OFString *)
-    of_JSONRepresentationWithOptions: (OFJSONRepresentationOptions)options
-			       depth: (size_t)depth
+- (void)
+    of_appendJSONRepresentationToString: (OFMutableString *)JSON
+				options: (OFJSONRepresentationOptions)options
+				  depth: (size_t)depth
 {
-	OFMutableString *JSON = [[self mutableCopy] autorelease];
+	void *pool = objc_autoreleasePoolPush();
+	const char *UTF8String = self.UTF8String;
+	size_t length = self.UTF8StringLength, last = 0;
+	bool JSON5 = (options & OFJSONRepresentationOptionJSON5);
 
-	/* FIXME: This is slow! Write it in pure C! */
-	[JSON replaceOccurrencesOfString: @"\\" withString: @"\\\\"];
-	[JSON replaceOccurrencesOfString: @"\"" withString: @"\\\""];
-	[JSON replaceOccurrencesOfString: @"\b" withString: @"\\b"];
-	[JSON replaceOccurrencesOfString: @"\f" withString: @"\\f"];
-	[JSON replaceOccurrencesOfString: @"\r" withString: @"\\r"];
-	[JSON replaceOccurrencesOfString: @"\t" withString: @"\\t"];
+	if (JSON5 && options & OFJSONRepresentationOptionIsIdentifier &&
+	    isJSON5Identifier(UTF8String, length)) {
+		[JSON appendUTF8String: UTF8String length: length];
+		objc_autoreleasePoolPop(pool);
+		return;
+	}
 
-	if (options & OFJSONRepresentationOptionJSON5) {
-		[JSON replaceOccurrencesOfString: @"\n" withString: @"\\\n"];
-		[JSON replaceOccurrencesOfString: @"\0" withString: @"\\0"];
+	[JSON appendString: @"\""];
 
-		if (options & OFJSONRepresentationOptionIsIdentifier) {
-			const char *cString = JSON.UTF8String;
+	/* Copy runs that need no escaping in one go. */
+	for (size_t i = 0; i < length; i++) {
+		const char *escape;
 
-			if ((!OFASCIIIsAlpha(cString[0]) &&
-			    cString[0] != '_' && cString[0] != '$') ||
-			    strpbrk(cString, " \n\r\t\b\f\\\"'") != NULL) {
-				[JSON insertString: @"\"" atIndex: 0];
-				[JSON appendString: @"\""];
-			}
-		} else {
-			[JSON insertString: @"\"" atIndex: 0];
-			[JSON appendString: @"\""];
+		switch (UTF8String[i]) {
+		case '\\':
+			escape = "\\\\";
+			break;
+		case '"':
+			escape = "\\\"";
+			break;
+		case '\b':
+			escape = "\\b";
+			break;
+		case '\f':
+			escape = "\\f";
+			break;
+		case '\r':
+			escape = "\\r";
+			break;
+		case '\t':
+			escape = "\\t";
+			break;
+		case '\n':
+			escape = (JSON5 ? "\\\n" : "\\n");
+			break;
+		case '\0':
+			escape = (JSON5 ? "\\0" : "\\u0000");
+			break;
+		default:
+			continue;
 		}
-	} else {
-		[JSON replaceOccurrencesOfString: @"\n" withString: @"\\n"];
-		[JSON replaceOccurrencesOfString: @"\0" withString: @"\\u0000"];
 
-		[JSON insertString: @"\"" atIndex: 0];
-		[JSON appendString: @"\""];
+		if (i > last)
+			[JSON appendUTF8String: UTF8String + last
+					length: i - last];
+
+		[JSON appendUTF8String: escape];
+		last = i + 1;
 	}
 
-	[JSON makeImmutable];
+	if (length > last)
+		[JSON appendUTF8String: UTF8String + last
+				length: length - last];
 
-	return JSON;
+	[JSON appendString: @"\""];
+
+	objc_autoreleasePoolPop(pool);
 }
 
 - (OFData *)messagePackRepresentation
 {
-	OFMutableData *data;
-	size_t length;
+	OFMutableData *data =
+	    [OFMutableData dataWithCapacity: self.UTF8StringLength + 5];
 
-	length = self.UTF8StringLength;
+	[self of_appendMessagePackRepresentationToData: data];
+	[data makeImmutable];
 
-	if (length <= 31) {
-		uint8_t tmp = 0xA0 | ((uint8_t)length & 0x1F);
+	return data;
+}
 
-		data = [OFMutableData dataWithCapacity: length + 1];
-		[data addItem: &tmp];
-	} else if (length <= UINT8_MAX) {
-		uint8_t type = 0xD9;
-		uint8_t tmp = (uint8_t)length;
+- (void)of_appendMessagePackRepresentationToData: (OFMutableData *)data
+{
+	size_t length = self.UTF8StringLength;
+	unsigned char buffer[5];
+	size_t bufferLength;
 
-		data = [OFMutableData dataWithCapacity: length + 2];
-		[data addItem: &type];
-		[data addItem: &tmp];
+	if (length <= 31) {
+		buffer[0] = 0xA0 | ((uint8_t)length & 0x1F);
+		bufferLength = 1;
+	} else if (length <= UINT8_MAX) {
+		buffer[0] = 0xD9;
+		buffer[1] = (uint8_t)length;
+		bufferLength = 2;
 	} else if (length <= UINT16_MAX) {
-		uint8_t type = 0xDA;
 		uint16_t tmp = OFToBigEndian16((uint16_t)length);
 
-		data = [OFMutableData dataWithCapacity: length + 3];
-		[data addItem: &type];
-		[data addItems: &tmp count: sizeof(tmp)];
+		buffer[0] = 0xDA;
+		memcpy(buffer + 1, &tmp, sizeof(tmp));
+		bufferLength = 3;
 	} else if (length <= UINT32_MAX) {
-		uint8_t type = 0xDB;
 		uint32_t tmp = OFToBigEndian32((uint32_t)length);
 
-		data = [OFMutableData dataWithCapacity: length + 5];
-		[data addItem: &type];
-		[data addItems: &tmp count: sizeof(tmp)];
+		buffer[0] = 0xDB;
+		memcpy(buffer + 1, &tmp, sizeof(tmp));
+		bufferLength = 5;
 	} else
 		@throw [OFOutOfRangeException exception];
 
+	[data addItems: buffer count: bufferLength];
 	[data addItems: [self insecureCStringWithEncoding: OFStringEncodingUTF8]
 		 count: length];
-
-	return data;
 }
 
 - (OFRange)rangeOfString: (OFString *)string
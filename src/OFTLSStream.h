@@ -106,6 +106,14 @@ typedef enum {
 	OF_RESERVE_IVARS(OFTLSStream, 3)
 }
 
+#ifdef OF_HAVE_CLASS_PROPERTIES
+@property (class, nonatomic) size_t sessionCacheSize;
+@property (class, readonly, nonatomic)
+    unsigned long long numberOfResumedHandshakes;
+@property (class, readonly, nonatomic)
+    unsigned long long numberOfFullHandshakes;
+#endif
+
 /**
  * @brief The underlying stream.
  */
@@ -134,6 +142,50 @@ typedef enum {
 
 - (instancetype)init OF_UNAVAILABLE;
 
+/**
+ * @brief Returns the maximum number of TLS sessions that are cached for
+ *	  resumption.
+ *
+ * @return The maximum number of TLS sessions that are cached for resumption
+ */
++ (size_t)sessionCacheSize;
+
+/**
+ * @brief Sets the maximum number of TLS sessions that are cached for
+ *	  resumption.
+ *
+ * Clients cache the last session for each host, so that the next handshake
+ * with the same host can resume it instead of performing a full handshake.
+ * Only sessions of connections that verified the certificate and did not use
+ * a client certificate are cached, and they are only resumed by connections
+ * that verify certificates and do not use a client certificate either.
+ * Servers cache sessions so that clients can resume them. The caches are
+ * shared by all threads. A size of 0 disables caching.
+ *
+ * @note Backends that do not support session resumption ignore this.
+ *
+ * @param sessionCacheSize The maximum number of TLS sessions to cache
+ */
++ (void)setSessionCacheSize: (size_t)sessionCacheSize;
+
+/**
+ * @brief Returns the number of handshakes that resumed a previous session.
+ *
+ * Together with @ref numberOfFullHandshakes, this can be used to calculate the
+ * rate of resumed sessions.
+ *
+ * @return The number of handshakes that resumed a previous session
+ */
++ (unsigned long long)numberOfResumedHandshakes;
+
+/**
+ * @brief Returns the number of full handshakes, i.e. handshakes that did not
+ *	  resume a previous session.
+ *
+ * @return The number of full handshakes
+ */
++ (unsigned long long)numberOfFullHandshakes;
+
 /**
  * @brief Creates a new TLS stream with the specified stream as its underlying
  *	  stream.
@@ -111,6 +111,37 @@ OFTLSStreamErrorCodeDescription(OFTLSStreamErrorCode errorCode)
 	return [super alloc];
 }
 
++ (size_t)sessionCacheSize
+{
+	if (self == [OFTLSStream class] && OFTLSStreamImplementation != Nil)
+		return [OFTLSStreamImplementation sessionCacheSize];
+
+	return 0;
+}
+
++ (void)setSessionCacheSize: (size_t)sessionCacheSize
+{
+	if (self == [OFTLSStream class] && OFTLSStreamImplementation != Nil)
+		[OFTLSStreamImplementation setSessionCacheSize:
+		    sessionCacheSize];
+}
+
++ (unsigned long long)numberOfResumedHandshakes
+{
+	if (self == [OFTLSStream class] && OFTLSStreamImplementation != Nil)
+		return [OFTLSStreamImplementation numberOfResumedHandshakes];
+
+	return 0;
+}
+
++ (unsigned long long)numberOfFullHandshakes
+{
+	if (self == [OFTLSStream class] && OFTLSStreamImplementation != Nil)
+		return [OFTLSStreamImplementation numberOfFullHandshakes];
+
+	return 0;
+}
+
 + (instancetype)streamWithStream: (OFStream <OFReadyForReadingObserving,
 				       OFReadyForWritingObserving> *)stream
 {
@@ -20,6 +20,7 @@
 #include "config.h"
 
 #import "OFTaggedPointerString.h"
+#import "OFString+Private.h"
 
 #import "OFOutOfRangeException.h"
 
@@ -86,20 +87,15 @@ lengthForValue(uintptr_t value)
 - (unsigned long)hash
 {
 	uintptr_t value = object_getTaggedPointerValue(self);
-	unsigned long hash;
-
-	OFHashInit(&hash);
+	char buffer[sizeof(uintptr_t)];
+	size_t length = 0;
 
 	while (value > 0) {
-		OFHashAddByte(&hash, 0);
-		OFHashAddByte(&hash, 0);
-		OFHashAddByte(&hash, value & 0x7F);
+		buffer[length++] = value & 0x7F;
 		value >>= 7;
 	}
 
-	OFHashFinalize(&hash);
-
-	return hash;
+	return _OFUTF8StringHash(buffer, length);
 }
 
 - (size_t)UTF8StringLength
@@ -23,7 +23,10 @@
 
 OF_ASSUME_NONNULL_BEGIN
 
+@class OFData;
 @class OFIRI;
+@class OFDictionary OF_GENERIC(KeyType, ObjectType);
+@class OFNumber;
 @class OFStream;
 
 /**
@@ -38,6 +41,8 @@ OF_SUBCLASSING_RESTRICTED
 	uint_least8_t _mode;
 	OFStringEncoding _encoding;
 	OFTarArchiveEntry *_Nullable _currentEntry;
+	int64_t _startOffset;
+	OFDictionary OF_GENERIC(OFString *, OFNumber *) *_Nullable _index;
 #ifdef OF_TAR_ARCHIVE_M
 @public
 #endif
@@ -153,6 +158,64 @@ OF_SUBCLASSING_RESTRICTED
  */
 - (OFStream *)streamForReadingCurrentEntry;
 
+/**
+ * @brief Returns a stream for reading the specified file from the archive.
+ *
+ * This seeks directly to the header of the file using the index of the
+ * archive, which is built on first use by reading only the headers and seeking
+ * over the data of the entries. After this, @ref nextEntry continues with the
+ * entry following the specified file.
+ *
+ * If the archive contains several entries with the same path, the last one is
+ * returned.
+ *
+ * @note This is only available in read mode and requires the underlying
+ *	 stream to be an OFSeekableStream.
+ *
+ * @warning Calling @ref streamForReadingFile: will invalidate all streams
+ *	    returned by @ref streamForReadingCurrentEntry or
+ *	    @ref streamForReadingFile:!
+ *
+ * @param path The path of the file inside the archive
+ * @return A stream for reading the specified file
+ * @throw OFInvalidArgumentException The archive is not in read mode or the
+ *				     underlying stream is not seekable
+ * @throw OFOpenItemFailedException The file does not exist in the archive
+ * @throw OFInvalidFormatException The archive has an invalid format or the
+ *				   index does not match the archive
+ */
+- (OFStream *)streamForReadingFile: (OFString *)path;
+
+/**
+ * @brief Returns the index of the archive used by @ref streamForReadingFile:,
+ *	  building it first if necessary.
+ *
+ * The returned data can be persisted, e.g. in a file next to the archive, and
+ * be passed to @ref loadIndex: for the same archive later to avoid reading all
+ * headers again.
+ *
+ * @note This is only available in read mode and requires the underlying
+ *	 stream to be an OFSeekableStream.
+ *
+ * @return The index of the archive
+ * @throw OFInvalidArgumentException The archive is not in read mode or the
+ *				     underlying stream is not seekable
+ * @throw OFInvalidFormatException The archive has an invalid format
+ */
+- (OFData *)index;
+
+/**
+ * @brief Loads an index previously returned by @ref index.
+ *
+ * @note The index is only checked for whether it matches the archive when a
+ *	 file is accessed via @ref streamForReadingFile:.
+ *
+ * @param index The index to load
+ * @throw OFInvalidArgumentException The archive is not in read mode
+ * @throw OFInvalidFormatException The index is not valid
+ */
+- (void)loadIndex: (OFData *)index;
+
 /**
  * @brief Returns a stream for writing the specified entry.
  *
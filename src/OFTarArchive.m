@@ -27,17 +27,23 @@
 #import "OFTarArchiveEntry.h"
 #import "OFTarArchiveEntry+Private.h"
 #import "OFArchiveIRIHandler.h"
+#import "OFData.h"
+#import "OFData+MessagePackParsing.h"
 #import "OFDate.h"
+#import "OFDictionary.h"
 #import "OFIRI.h"
 #import "OFIRIHandler.h"
 #import "OFKernelEventObserver.h"
+#import "OFNumber.h"
 #import "OFSeekableStream.h"
 #import "OFStream.h"
 
 #import "OFInvalidArgumentException.h"
 #import "OFInvalidFormatException.h"
 #import "OFNotOpenException.h"
+#import "OFOpenItemFailedException.h"
 #import "OFOutOfRangeException.h"
+#import "OFSeekFailedException.h"
 #import "OFTruncatedDataException.h"
 #import "OFWriteFailedException.h"
 
@@ -138,6 +144,23 @@ OF_DIRECT_MEMBERS
 							  whence: OFSeekEnd];
 		}
 
+		/*
+		 * Remember where the archive starts for random access. Not
+		 * all seekable streams can actually seek, e.g. files for
+		 * pipes, so only fail once random access is attempted.
+		 */
+		_startOffset = -1;
+		if (_mode == modeRead &&
+		    [_stream isKindOfClass: [OFSeekableStream class]]) {
+			@try {
+				_startOffset = [(OFSeekableStream *)_stream
+				    seekToOffset: 0
+					  whence: OFSeekCurrent];
+			} @catch (OFSeekFailedException *e) {
+				/* Random access is not possible then. */
+			}
+		}
+
 		_encoding = OFStringEncodingUTF8;
 	} @catch (id e) {
 		[self release];
@@ -174,10 +197,84 @@ OF_DIRECT_MEMBERS
 	[self close];
 
 	[_currentEntry release];
+	[_index release];
 
 	[super dealloc];
 }
 
+static OFTarArchiveEntry *
+readEntryAtOffset(OFTarArchive *self, int64_t offset)
+{
+	uint32_t buffer[512 / sizeof(uint32_t)];
+	bool empty = true;
+
+	if (offset > INT64_MAX - self->_startOffset ||
+	    (OFStreamOffset)(self->_startOffset + offset) !=
+	    self->_startOffset + offset)
+		@throw [OFOutOfRangeException exception];
+
+	[(OFSeekableStream *)self->_stream
+	    seekToOffset: (OFStreamOffset)(self->_startOffset + offset)
+		  whence: OFSeekSet];
+
+	if (self->_stream.atEndOfStream)
+		return nil;
+
+	[self->_stream readIntoBuffer: buffer exactLength: 512];
+
+	for (size_t i = 0; i < 512 / sizeof(uint32_t); i++)
+		if (buffer[i] != 0)
+			empty = false;
+
+	if (empty)
+		return nil;
+
+	return [[[OFTarArchiveEntry alloc]
+	    of_initWithHeader: (unsigned char *)buffer
+		     encoding: self->_encoding] autorelease];
+}
+
+/*
+ * Builds the index by only reading the headers and seeking over the data. The
+ * position of the underlying stream is restored afterwards so that
+ * -[nextEntry] and streams returned before are not affected.
+ */
+static void
+buildIndex(OFTarArchive *self)
+{
+	void *pool = objc_autoreleasePoolPush();
+	OFMutableDictionary *index = [OFMutableDictionary dictionary];
+	OFSeekableStream *stream = (OFSeekableStream *)self->_stream;
+	OFStreamOffset position =
+	    [stream seekToOffset: 0 whence: OFSeekCurrent];
+	int64_t offset = 0;
+	OFTarArchiveEntry *entry;
+
+	while ((entry = readEntryAtOffset(self, offset)) != nil) {
+		unsigned long long size = entry.uncompressedSize;
+
+		[index setObject: [OFNumber numberWithLongLong: offset]
+			  forKey: entry.fileName];
+
+		if (size > INT64_MAX - 511)
+			@throw [OFOutOfRangeException exception];
+
+		size = (size + 511) & ~(unsigned long long)511;
+
+		if (size > (unsigned long long)(INT64_MAX - 512 - offset))
+			@throw [OFOutOfRangeException exception];
+
+		offset += 512 + (int64_t)size;
+	}
+
+	[stream seekToOffset: position whence: OFSeekSet];
+
+	[index makeImmutable];
+	self->_index = [index copy];
+
+	objc_autoreleasePoolPop(pool);
+}
+
 - (OFTarArchiveEntry *)nextEntry
 {
 	uint32_t buffer[512 / sizeof(uint32_t)];
@@ -254,6 +351,84 @@ OF_DIRECT_MEMBERS
 	return _lastReturnedStream;
 }
 
+- (OFStream *)streamForReadingFile: (OFString *)path
+{
+	void *pool;
+	OFNumber *offset;
+	OFTarArchiveEntry *entry;
+
+	if (_mode != modeRead || _startOffset < 0)
+		@throw [OFInvalidArgumentException exception];
+
+	if (_index == nil)
+		buildIndex(self);
+
+	if ((offset = [_index objectForKey: path]) == nil)
+		@throw [OFOpenItemFailedException exceptionWithPath: path
+							       mode: @"r"
+							      errNo: ENOENT];
+
+	@try {
+		[_lastReturnedStream close];
+	} @catch (OFNotOpenException *e) {
+		/* Might have already been closed by the user - that's fine. */
+	}
+	_lastReturnedStream = nil;
+
+	[_currentEntry release];
+	_currentEntry = nil;
+
+	pool = objc_autoreleasePoolPush();
+
+	entry = readEntryAtOffset(self, offset.longLongValue);
+	if (entry == nil || ![entry.fileName isEqual: path])
+		@throw [OFInvalidFormatException exception];
+
+	_currentEntry = [entry retain];
+
+	objc_autoreleasePoolPop(pool);
+
+	return [self streamForReadingCurrentEntry];
+}
+
+- (OFData *)index
+{
+	if (_mode != modeRead || _startOffset < 0)
+		@throw [OFInvalidArgumentException exception];
+
+	if (_index == nil)
+		buildIndex(self);
+
+	return _index.messagePackRepresentation;
+}
+
+- (void)loadIndex: (OFData *)index
+{
+	void *pool = objc_autoreleasePoolPush();
+	OFDictionary *dictionary;
+
+	if (_mode != modeRead)
+		@throw [OFInvalidArgumentException exception];
+
+	dictionary = index.objectByParsingMessagePack;
+	if (![dictionary isKindOfClass: [OFDictionary class]])
+		@throw [OFInvalidFormatException exception];
+
+	for (OFString *path in dictionary) {
+		OFNumber *offset = [dictionary objectForKey: path];
+
+		if (![path isKindOfClass: [OFString class]] ||
+		    ![offset isKindOfClass: [OFNumber class]] ||
+		    offset.longLongValue < 0)
+			@throw [OFInvalidFormatException exception];
+	}
+
+	[_index release];
+	_index = [dictionary copy];
+
+	objc_autoreleasePoolPop(pool);
+}
+
 - (OFStream *)streamForWritingEntry: (OFTarArchiveEntry *)entry
 {
 	if (_mode != modeWrite && _mode != modeAppend)
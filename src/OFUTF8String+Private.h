@@ -26,6 +26,7 @@ OF_DIRECT_MEMBERS
 - (instancetype)of_initWithUTF8String: (const char *)UTF8String
 			       length: (size_t)UTF8StringLength
 			      storage: (char *)storage OF_METHOD_FAMILY(init);
+- (size_t)of_positionOfIndex: (size_t)idx;
 @end
 
 #ifdef __cplusplus
@@ -35,8 +36,20 @@ extern int _OFUTF8StringCheck(const char *, size_t, size_t *_Nullable, bool *)
     OF_VISIBILITY_HIDDEN;
 extern size_t _OFUTF8StringIndexToPosition(const char *, size_t, size_t)
     OF_VISIBILITY_HIDDEN;
+extern size_t _OFUTF8StringFind(const char *, size_t, const char *, size_t)
+    OF_VISIBILITY_HIDDEN;
 #ifdef __cplusplus
 }
 #endif
 
+/* Needs to be called whenever the contents of the string change. */
+static OF_INLINE void
+_OFUTF8StringInvalidateCaches(struct OFUTF8StringIvars *ivars)
+{
+	ivars->hasHash = false;
+
+	OFFreeMemory(ivars->breadcrumbs);
+	ivars->breadcrumbs = NULL;
+}
+
 OF_ASSUME_NONNULL_END
@@ -37,6 +37,11 @@ OF_ASSUME_NONNULL_BEGIN
 		unsigned long hash;
 		unsigned      isUTF8: 1, containsNull: 1, hasHash: 1;
 		unsigned      freeWhenDone: 1;
+		/*
+		 * The byte position of every 64th character, built lazily on
+		 * the first access by index.
+		 */
+		size_t        *_Nullable breadcrumbs;
 	} *restrict _s;
 	struct OFUTF8StringIvars _storage;
 }
@@ -35,6 +35,9 @@
 #import "OFMutableUTF8String.h"
 #import "OFString.h"
 #import "OFString+Private.h"
+#ifdef OF_HAVE_ATOMIC_OPS
+# import "OFAtomic.h"
+#endif
 
 #import "OFInitializationFailedException.h"
 #import "OFInvalidArgumentException.h"
@@ -45,6 +48,8 @@
 
 #import "unicode.h"
 
+#define BREADCRUMB_INTERVAL 64
+
 extern const OFChar16 _OFISO8859_2Table[];
 extern const size_t _OFISO8859_2TableOffset;
 extern const OFChar16 _OFISO8859_3Table[];
@@ -100,6 +105,29 @@ _OFUTF8StringCheck(const char *UTF8String, size_t UTF8Length, size_t *length,
 	bool tmpContainsNull = false;
 
 	for (size_t i = 0; i < UTF8Length; i++) {
+		/*
+		 * Skip over ASCII 8 bytes at a time. This is portable and
+		 * already covers the common case of mostly ASCII input.
+		 */
+		while (UTF8Length - i >= 8) {
+			uint64_t word;
+
+			memcpy(&word, UTF8String + i, 8);
+
+			if (word & UINT64_C(0x8080808080808080))
+				break;
+
+			/* Only true if at least one of the bytes is zero. */
+			if ((word - UINT64_C(0x0101010101010101)) & ~word &
+			    UINT64_C(0x8080808080808080))
+				tmpContainsNull = true;
+
+			i += 8;
+		}
+
+		if (i == UTF8Length)
+			break;
+
 		if OF_UNLIKELY (UTF8String[i] == '\0')
 			tmpContainsNull = true;
 
@@ -189,6 +217,49 @@ _OFUTF8StringIndexToPosition(const char *string, size_t idx, size_t length)
 	return idx;
 }
 
+/*
+ * Returns the byte position of the first occurrence of needle in string or
+ * OFNotFound. memmem() usually uses Two-Way and vectorized filtering, without
+ * it, memchr() is used to quickly skip to candidates for the first byte.
+ */
+size_t
+_OFUTF8StringFind(const char *string, size_t length, const char *needle,
+    size_t needleLength)
+{
+#ifdef HAVE_MEMMEM
+	const char *found;
+
+	if (needleLength == 0)
+		return 0;
+
+	if ((found = memmem(string, length, needle, needleLength)) == NULL)
+		return OFNotFound;
+
+	return found - string;
+#else
+	const char *last, *found;
+
+	if (needleLength == 0)
+		return 0;
+
+	if (needleLength > length)
+		return OFNotFound;
+
+	last = string + length - needleLength;
+
+	for (const char *iter = string; iter <= last; iter = found + 1) {
+		if ((found = memchr(iter, needle[0], last - iter + 1)) == NULL)
+			return OFNotFound;
+
+		if (found[needleLength - 1] == needle[needleLength - 1] &&
+		    memcmp(found, needle, needleLength) == 0)
+			return found - string;
+	}
+
+	return OFNotFound;
+#endif
+}
+
 @implementation OFUTF8String
 - (instancetype)init
 {
@@ -774,12 +845,72 @@ _OFUTF8StringIndexToPosition(const char *string, size_t idx, size_t length)
 
 - (void)dealloc
 {
-	if (_s != NULL && _s->freeWhenDone)
-		OFFreeMemory(_s->cString);
+	if (_s != NULL) {
+		if (_s->freeWhenDone)
+			OFFreeMemory(_s->cString);
+
+		OFFreeMemory(_s->breadcrumbs);
+	}
 
 	[super dealloc];
 }
 
+- (size_t)of_positionOfIndex: (size_t)idx
+{
+	size_t *breadcrumbs, i, position;
+
+	if (!_s->isUTF8)
+		return idx;
+
+	if (_s->length <= BREADCRUMB_INTERVAL)
+		return _OFUTF8StringIndexToPosition(_s->cString, idx,
+		    _s->cStringLength);
+
+	if ((breadcrumbs = _s->breadcrumbs) == NULL) {
+#if defined(OF_HAVE_THREADS) && !defined(OF_HAVE_ATOMIC_OPS)
+		/* Can't publish the breadcrumbs safely. */
+		return _OFUTF8StringIndexToPosition(_s->cString, idx,
+		    _s->cStringLength);
+#else
+		size_t count = _s->length / BREADCRUMB_INTERVAL + 1;
+
+		breadcrumbs = OFAllocMemory(count, sizeof(size_t));
+
+		for (i = position = 0; position < _s->cStringLength;
+		    position++) {
+			if ((_s->cString[position] & 0xC0) == 0x80)
+				continue;
+
+			if (i % BREADCRUMB_INTERVAL == 0)
+				breadcrumbs[i / BREADCRUMB_INTERVAL] = position;
+
+			i++;
+		}
+
+		if (i % BREADCRUMB_INTERVAL == 0)
+			breadcrumbs[i / BREADCRUMB_INTERVAL] = position;
+
+# ifdef OF_HAVE_ATOMIC_OPS
+		/* Immutable strings can be accessed by multiple threads. */
+		if (!OFAtomicPointerCompareAndSwap(
+		    (void **)&_s->breadcrumbs, NULL, breadcrumbs)) {
+			OFFreeMemory(breadcrumbs);
+			breadcrumbs = _s->breadcrumbs;
+		}
+# else
+		_s->breadcrumbs = breadcrumbs;
+# endif
+#endif
+	}
+
+	position = breadcrumbs[idx / BREADCRUMB_INTERVAL];
+
+	for (i = idx % BREADCRUMB_INTERVAL; i > 0; i--)
+		while ((_s->cString[++position] & 0xC0) == 0x80);
+
+	return position;
+}
+
 - (size_t)getCString: (char *)cString
 	   maxLength: (size_t)maxLength
 	    encoding: (OFStringEncoding)encoding
@@ -1014,34 +1145,13 @@ _OFUTF8StringIndexToPosition(const char *string, size_t idx, size_t length)
 
 - (unsigned long)hash
 {
-	unsigned long hash;
-
 	if (_s->hasHash)
 		return _s->hash;
 
-	OFHashInit(&hash);
-
-	for (size_t i = 0; i < _s->cStringLength; i++) {
-		OFUnichar c;
-		ssize_t length;
-
-		if ((length = _OFUTF8StringDecode(_s->cString + i,
-		    _s->cStringLength - i, &c)) <= 0)
-			@throw [OFInvalidEncodingException exception];
-
-		OFHashAddByte(&hash, (c & 0xFF0000) >> 16);
-		OFHashAddByte(&hash, (c & 0x00FF00) >> 8);
-		OFHashAddByte(&hash, c & 0x0000FF);
-
-		i += length - 1;
-	}
-
-	OFHashFinalize(&hash);
-
-	_s->hash = hash;
+	_s->hash = _OFUTF8StringHash(_s->cString, _s->cStringLength);
 	_s->hasHash = true;
 
-	return hash;
+	return _s->hash;
 }
 
 - (OFUnichar)characterAtIndex: (size_t)idx
@@ -1054,7 +1164,7 @@ _OFUTF8StringIndexToPosition(const char *string, size_t idx, size_t length)
 	if (!_s->isUTF8)
 		return _s->cString[idx];
 
-	idx = _OFUTF8StringIndexToPosition(_s->cString, idx, _s->cStringLength);
+	idx = [self of_positionOfIndex: idx];
 
 	if (_OFUTF8StringDecode(_s->cString + idx, _s->cStringLength - idx,
 	    &character) <= 0)
@@ -1065,18 +1175,30 @@ _OFUTF8StringIndexToPosition(const char *string, size_t idx, size_t length)
 
 - (void)getCharacters: (OFUnichar *)buffer inRange: (OFRange)range
 {
-	/* TODO: Could be slightly optimized */
-	void *pool = objc_autoreleasePoolPush();
-	const OFUnichar *characters = self.characters;
+	size_t position;
 
 	if (range.length > SIZE_MAX - range.location ||
 	    range.location + range.length > _s->length)
 		@throw [OFOutOfRangeException exception];
 
-	memcpy(buffer, characters + range.location,
-	    range.length * sizeof(OFUnichar));
+	if (!_s->isUTF8) {
+		for (size_t i = 0; i < range.length; i++)
+			buffer[i] = _s->cString[range.location + i];
 
-	objc_autoreleasePoolPop(pool);
+		return;
+	}
+
+	position = [self of_positionOfIndex: range.location];
+
+	for (size_t i = 0; i < range.length; i++) {
+		ssize_t length = _OFUTF8StringDecode(_s->cString + position,
+		    _s->cStringLength - position, buffer + i);
+
+		if (length <= 0)
+			@throw [OFInvalidEncodingException exception];
+
+		position += length;
+	}
 }
 
 - (OFRange)rangeOfString: (OFString *)string
@@ -1092,16 +1214,9 @@ _OFUTF8StringIndexToPosition(const char *string, size_t idx, size_t length)
 	    range.location + range.length > _s->length)
 		@throw [OFOutOfRangeException exception];
 
-	if (_s->isUTF8) {
-		rangeLocation = _OFUTF8StringIndexToPosition(
-		    _s->cString, range.location, _s->cStringLength);
-		rangeLength = _OFUTF8StringIndexToPosition(
-		    _s->cString + rangeLocation, range.length,
-		    _s->cStringLength - rangeLocation);
-	} else {
-		rangeLocation = range.location;
-		rangeLength = range.length;
-	}
+	rangeLocation = [self of_positionOfIndex: range.location];
+	rangeLength = [self of_positionOfIndex:
+	    range.location + range.length] - rangeLocation;
 
 	if (cStringLength == 0)
 		return OFMakeRange(0, 0);
@@ -1125,15 +1240,15 @@ _OFUTF8StringIndexToPosition(const char *string, size_t idx, size_t length)
 				return OFMakeRange(OFNotFound, 0);
 		}
 	} else {
-		for (size_t i = 0; i <= rangeLength - cStringLength; i++) {
-			if (memcmp(_s->cString + rangeLocation + i, cString,
-			    cStringLength) == 0) {
-				range.location += positionToIndex(
-				    _s->cString + rangeLocation, i);
-				range.length = string.length;
+		size_t i = _OFUTF8StringFind(_s->cString + rangeLocation,
+		    rangeLength, cString, cStringLength);
 
-				return range;
-			}
+		if (i != OFNotFound) {
+			range.location += positionToIndex(
+			    _s->cString + rangeLocation, i);
+			range.length = string.length;
+
+			return range;
 		}
 	}
 
@@ -1146,17 +1261,8 @@ _OFUTF8StringIndexToPosition(const char *string, size_t idx, size_t length)
 	    [string insecureCStringWithEncoding: OFStringEncodingUTF8];
 	size_t cStringLength = string.UTF8StringLength;
 
-	if (cStringLength == 0)
-		return true;
-
-	if (cStringLength > _s->cStringLength)
-		return false;
-
-	for (size_t i = 0; i <= _s->cStringLength - cStringLength; i++)
-		if (memcmp(_s->cString + i, cString, cStringLength) == 0)
-			return true;
-
-	return false;
+	return (_OFUTF8StringFind(_s->cString, _s->cStringLength, cString,
+	    cStringLength) != OFNotFound);
 }
 
 - (OFString *)substringWithRange: (OFRange)range
@@ -1167,12 +1273,8 @@ _OFUTF8StringIndexToPosition(const char *string, size_t idx, size_t length)
 	if (range.length > SIZE_MAX - range.location || end > _s->length)
 		@throw [OFOutOfRangeException exception];
 
-	if (_s->isUTF8) {
-		start = _OFUTF8StringIndexToPosition(_s->cString, start,
-		    _s->cStringLength);
-		end = _OFUTF8StringIndexToPosition(_s->cString, end,
-		    _s->cStringLength);
-	}
+	start = [self of_positionOfIndex: start];
+	end = [self of_positionOfIndex: end];
 
 	return [OFString stringWithUTF8String: _s->cString + start
 				       length: end - start];
@@ -1232,17 +1334,19 @@ _OFUTF8StringIndexToPosition(const char *string, size_t idx, size_t length)
 	}
 
 	last = 0;
-	for (size_t i = 0; i <= _s->cStringLength - cStringLength; i++) {
-		if (memcmp(_s->cString + i, cString, cStringLength) != 0)
-			continue;
+	for (;;) {
+		size_t i = _OFUTF8StringFind(_s->cString + last,
+		    _s->cStringLength - last, cString, cStringLength);
+
+		if (i == OFNotFound)
+			break;
 
 		component = [OFString stringWithUTF8String: _s->cString + last
-						    length: i - last];
+						    length: i];
 		if (!skipEmpty || component.length > 0)
 			[array addObject: component];
 
-		i += cStringLength - 1;
-		last = i + 1;
+		last += i + cStringLength;
 	}
 	component = [OFString stringWithUTF8String: _s->cString + last];
 	if (!skipEmpty || component.length > 0)
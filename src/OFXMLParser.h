@@ -24,9 +24,9 @@
 OF_ASSUME_NONNULL_BEGIN
 
 @class OFArray OF_GENERIC(ObjectType);
+@class OFDictionary OF_GENERIC(KeyType, ObjectType);
 @class OFMutableData;
 @class OFMutableArray OF_GENERIC(ObjectType);
-@class OFMutableDictionary OF_GENERIC(KeyType, ObjectType);
 @class OFStream;
 @class OFXMLParser;
 
@@ -140,7 +140,7 @@ OF_SUBCLASSING_RESTRICTED
 	OFMutableData *_buffer;
 	OFString *_Nullable _name, *_Nullable _prefix;
 	OFMutableArray
-	    OF_GENERIC(OFMutableDictionary OF_GENERIC(OFString *, OFString *) *)
+	    OF_GENERIC(OFDictionary OF_GENERIC(OFString *, OFString *) *)
 	    *_namespaces;
 	OFMutableArray OF_GENERIC(OFXMLAttribute *) *_attributes;
 	OFString *_Nullable _attributeName, *_Nullable _attributePrefix;
@@ -152,6 +152,7 @@ OF_SUBCLASSING_RESTRICTED
 	bool _lastCarriageReturn, _finishedParsing;
 	OFStringEncoding _encoding;
 	size_t _depthLimit;
+	struct _OFXMLParserInternedName *_internedNames;
 }
 
 /**
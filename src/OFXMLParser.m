@@ -33,6 +33,7 @@
 #endif
 #import "OFStream.h"
 #import "OFString.h"
+#import "OFString+Private.h"
 #import "OFSystemInfo.h"
 #import "OFXMLAttribute.h"
 
@@ -67,6 +68,14 @@ enum {
 	stateInDOCTYPE
 };
 
+#define NUM_INTERNED_NAMES 64
+
+struct _OFXMLParserInternedName {
+	OFString *string;
+	char *UTF8String;
+	size_t length;
+};
+
 @interface OFXMLParser () <OFStringXMLUnescapingDelegate>
 @end
 
@@ -130,43 +139,112 @@ appendToBuffer(OFMutableData *buffer, const char *string,
 	}
 }
 
+/*
+ * Returns the bytes between _last and _i. If nothing was buffered from a
+ * previous call to -[parseBuffer:length:] and no conversion is needed, they
+ * are returned directly from the data that is being parsed without copying.
+ */
+static const char *
+pendingBytes(OFXMLParser *self, size_t *length)
+{
+	if (self->_buffer.count == 0 &&
+	    self->_encoding == OFStringEncodingUTF8) {
+		*length = self->_i - self->_last;
+		return self->_data + self->_last;
+	}
+
+	if (self->_i > self->_last)
+		appendToBuffer(self->_buffer, self->_data + self->_last,
+		    self->_encoding, self->_i - self->_last);
+
+	*length = self->_buffer.count;
+	return self->_buffer.items;
+}
+
 static OFString *
-transformString(OFXMLParser *parser, OFMutableData *buffer, size_t cut,
-    bool unescape)
+transformString(OFXMLParser *self, size_t cut, bool unescape)
 {
-	char *items = buffer.mutableItems;
-	size_t length = buffer.count - cut;
-	bool hasEntities = false;
+	size_t length;
+	const char *items = pendingBytes(self, &length);
 	OFString *ret;
 
-	for (size_t i = 0; i < length; i++) {
-		if (items[i] == '\r') {
-			if (i + 1 < length && items[i + 1] == '\n') {
-				[buffer removeItemAtIndex: i];
-				items = buffer.mutableItems;
+	length -= cut;
+
+	if (memchr(items, '\r', length) != NULL) {
+		char *mutableItems;
+
+		if (self->_buffer.count == 0)
+			[self->_buffer addItems: items count: length];
+
+		mutableItems = self->_buffer.mutableItems;
+
+		for (size_t i = 0; i < length; i++) {
+			if (mutableItems[i] != '\r')
+				continue;
+
+			if (i + 1 < length && mutableItems[i + 1] == '\n') {
+				[self->_buffer removeItemAtIndex: i];
+				mutableItems = self->_buffer.mutableItems;
 
 				i--;
 				length--;
 			} else
-				items[i] = '\n';
-		} else if (items[i] == '&')
-			hasEntities = true;
+				mutableItems[i] = '\n';
+		}
+
+		items = mutableItems;
 	}
 
 	ret = [OFString stringWithUTF8String: items length: length];
 
-	if (unescape && hasEntities) {
+	if (unescape && memchr(items, '&', length) != NULL) {
 		@try {
-			return [ret stringByXMLUnescapingWithDelegate: parser];
+			return [ret stringByXMLUnescapingWithDelegate: self];
 		} @catch (OFInvalidFormatException *e) {
 			@throw [OFMalformedXMLException
-			    exceptionWithParser: parser];
+			    exceptionWithParser: self];
 		}
 	}
 
 	return ret;
 }
 
+/*
+ * Element and attribute names repeat a lot, so they are looked up in a small
+ * direct-mapped cache instead of creating a new string for every occurrence.
+ * The returned string is owned by the cache and needs to be retained.
+ */
+static OFString *
+internName(OFXMLParser *self, const char *UTF8String, size_t length)
+{
+	struct _OFXMLParserInternedName *name = &self->_internedNames[
+	    _OFUTF8StringHash(UTF8String, length) % NUM_INTERNED_NAMES];
+	OFString *string;
+	char *copy;
+
+	if (name->string != nil && name->length == length &&
+	    memcmp(name->UTF8String, UTF8String, length) == 0)
+		return name->string;
+
+	string = [[OFString alloc] initWithUTF8String: UTF8String
+					       length: length];
+	@try {
+		copy = OFAllocMemory(length, 1);
+	} @catch (id e) {
+		[string release];
+		@throw e;
+	}
+	memcpy(copy, UTF8String, length);
+
+	[name->string release];
+	OFFreeMemory(name->UTF8String);
+	name->string = string;
+	name->UTF8String = copy;
+	name->length = length;
+
+	return string;
+}
+
 static OFString *
 namespaceForPrefix(OFString *prefix, OFArray *namespaces)
 {
@@ -186,6 +264,20 @@ namespaceForPrefix(OFString *prefix, OFArray *namespaces)
 	return nil;
 }
 
+static OFMutableDictionary *
+currentNamespaces(OFXMLParser *self)
+{
+	OFDictionary *namespaces = self->_namespaces.lastObject;
+
+	if (![namespaces isKindOfClass: [OFMutableDictionary class]]) {
+		namespaces = [OFMutableDictionary dictionary];
+		[self->_namespaces replaceObjectAtIndex:
+		    self->_namespaces.count - 1 withObject: namespaces];
+	}
+
+	return (OFMutableDictionary *)namespaces;
+}
+
 static OF_INLINE void
 resolveAttributeNamespace(OFXMLAttribute *attribute, OFArray *namespaces,
     OFXMLParser *self)
@@ -227,6 +319,8 @@ resolveAttributeNamespace(OFXMLAttribute *attribute, OFArray *namespaces,
 		_previous = [[OFMutableArray alloc] init];
 		_namespaces = [[OFMutableArray alloc] init];
 		_attributes = [[OFMutableArray alloc] init];
+		_internedNames = OFAllocZeroedMemory(NUM_INTERNED_NAMES,
+		    sizeof(*_internedNames));
 
 		pool = objc_autoreleasePoolPush();
 		dict = [OFMutableDictionary dictionaryWithKeysAndObjects:
@@ -259,6 +353,15 @@ resolveAttributeNamespace(OFXMLAttribute *attribute, OFArray *namespaces,
 	[_attributePrefix release];
 	[_previous release];
 
+	if (_internedNames != NULL) {
+		for (size_t i = 0; i < NUM_INTERNED_NAMES; i++) {
+			[_internedNames[i].string release];
+			OFFreeMemory(_internedNames[i].UTF8String);
+		}
+
+		OFFreeMemory(_internedNames);
+	}
+
 	[super dealloc];
 }
 
@@ -332,8 +435,6 @@ inByteOrderMarkState(OFXMLParser *self)
 static void
 outsideTagState(OFXMLParser *self)
 {
-	size_t length;
-
 	if ((self->_finishedParsing || self->_previous.count < 1) &&
 	    self->_data[self->_i] != ' '  && self->_data[self->_i] != '\t' &&
 	    self->_data[self->_i] != '\n' && self->_data[self->_i] != '\r' &&
@@ -343,14 +444,9 @@ outsideTagState(OFXMLParser *self)
 	if (self->_data[self->_i] != '<')
 		return;
 
-	if ((length = self->_i - self->_last) > 0)
-		appendToBuffer(self->_buffer, self->_data + self->_last,
-		    self->_encoding, length);
-
-	if (self->_buffer.count > 0) {
+	if (self->_i > self->_last || self->_buffer.count > 0) {
 		void *pool = objc_autoreleasePoolPush();
-		OFString *characters = transformString(self, self->_buffer, 0,
-		    true);
+		OFString *characters = transformString(self, 0, true);
 
 		if ([self->_delegate respondsToSelector:
 		    @selector(parser:foundCharacters:)])
@@ -507,9 +603,7 @@ inProcessingInstructionState(OFXMLParser *self)
 		OFCharacterSet *whitespaceCS;
 		size_t pos;
 
-		appendToBuffer(self->_buffer, self->_data + self->_last,
-		    self->_encoding, self->_i - self->_last);
-		PI = transformString(self, self->_buffer, 1, false);
+		PI = transformString(self, 1, false);
 
 		whitespaceCS = [OFCharacterSet
 		    characterSetWithCharactersInString: @" \r\n\r"];
@@ -550,36 +644,26 @@ static void
 inTagNameState(OFXMLParser *self)
 {
 	void *pool;
-	const char *bufferCString, *tmp;
-	size_t length, bufferLength;
-	OFString *bufferString;
+	const char *bytes, *tmp;
+	size_t length;
+	OFString *qualifiedName;
 
 	if (self->_data[self->_i] != ' '  && self->_data[self->_i] != '\t' &&
 	    self->_data[self->_i] != '\n' && self->_data[self->_i] != '\r' &&
 	    self->_data[self->_i] != '>'  && self->_data[self->_i] != '/')
 		return;
 
-	if ((length = self->_i - self->_last) > 0)
-		appendToBuffer(self->_buffer, self->_data + self->_last,
-		    self->_encoding, length);
-
 	pool = objc_autoreleasePoolPush();
 
-	bufferCString = self->_buffer.items;
-	bufferLength = self->_buffer.count;
-	bufferString = [OFString stringWithUTF8String: bufferCString
-					       length: bufferLength];
-
-	if ((tmp = memchr(bufferCString, ':', bufferLength)) != NULL) {
-		self->_name = [[OFString alloc]
-		    initWithUTF8String: tmp + 1
-				length: bufferLength -
-					(tmp - bufferCString) - 1];
-		self->_prefix = [[OFString alloc]
-		    initWithUTF8String: bufferCString
-				length: tmp - bufferCString];
+	bytes = pendingBytes(self, &length);
+	qualifiedName = [[internName(self, bytes, length) retain] autorelease];
+
+	if ((tmp = memchr(bytes, ':', length)) != NULL) {
+		self->_name = [internName(self, tmp + 1,
+		    length - (tmp - bytes) - 1) retain];
+		self->_prefix = [internName(self, bytes, tmp - bytes) retain];
 	} else {
-		self->_name = [bufferString copy];
+		self->_name = [qualifiedName retain];
 		self->_prefix = nil;
 	}
 
@@ -611,7 +695,7 @@ inTagNameState(OFXMLParser *self)
 			if (self->_previous.count == 0)
 				self->_finishedParsing = true;
 		} else
-			[self->_previous addObject: bufferString];
+			[self->_previous addObject: qualifiedName];
 
 		[self->_name release];
 		[self->_prefix release];
@@ -619,11 +703,21 @@ inTagNameState(OFXMLParser *self)
 
 		self->_state = (self->_data[self->_i] == '/'
 		    ? stateExpectTagClose : stateOutsideTag);
-	} else
+	} else {
+		/*
+		 * Whether the element is closed right away is only known after
+		 * the attributes, so inTagState() removes it again if needed.
+		 */
+		[self->_previous addObject: qualifiedName];
 		self->_state = stateInTag;
+	}
 
+	/*
+	 * Most elements don't declare namespaces, so the shared empty
+	 * dictionary is used until inAttributeValueState() finds one.
+	 */
 	if (self->_data[self->_i] != '/')
-		[self->_namespaces addObject: [OFMutableDictionary dictionary]];
+		[self->_namespaces addObject: [OFDictionary dictionary]];
 
 	objc_autoreleasePoolPop(pool);
 
@@ -636,42 +730,33 @@ static void
 inCloseTagNameState(OFXMLParser *self)
 {
 	void *pool;
-	const char *bufferCString, *tmp;
-	size_t length, bufferLength;
-	OFString *bufferString, *namespace;
+	const char *bytes, *tmp;
+	size_t length;
+	OFString *previous, *namespace;
 
 	if (self->_data[self->_i] != ' '  && self->_data[self->_i] != '\t' &&
 	    self->_data[self->_i] != '\n' && self->_data[self->_i] != '\r' &&
 	    self->_data[self->_i] != '>')
 		return;
 
-	if ((length = self->_i - self->_last) > 0)
-		appendToBuffer(self->_buffer, self->_data + self->_last,
-		    self->_encoding, length);
-
 	pool = objc_autoreleasePoolPush();
 
-	bufferCString = self->_buffer.items;
-	bufferLength = self->_buffer.count;
-	bufferString = [OFString stringWithUTF8String: bufferCString
-					       length: bufferLength];
-
-	if ((tmp = memchr(bufferCString, ':', bufferLength)) != NULL) {
-		self->_name = [[OFString alloc]
-		    initWithUTF8String: tmp + 1
-				length: bufferLength -
-					(tmp - bufferCString) - 1];
-		self->_prefix = [[OFString alloc]
-		    initWithUTF8String: bufferCString
-				length: tmp - bufferCString];
+	bytes = pendingBytes(self, &length);
+	previous = self->_previous.lastObject;
+
+	if (previous == nil || previous.UTF8StringLength != length ||
+	    memcmp(previous.UTF8String, bytes, length) != 0)
+		@throw [OFMalformedXMLException exceptionWithParser: self];
+
+	if ((tmp = memchr(bytes, ':', length)) != NULL) {
+		self->_name = [internName(self, tmp + 1,
+		    length - (tmp - bytes) - 1) retain];
+		self->_prefix = [internName(self, bytes, tmp - bytes) retain];
 	} else {
-		self->_name = [bufferString copy];
+		self->_name = [previous retain];
 		self->_prefix = nil;
 	}
 
-	if (![self->_previous.lastObject isEqual: bufferString])
-		@throw [OFMalformedXMLException exceptionWithParser: self];
-
 	[self->_previous removeLastObject];
 
 	[self->_buffer removeAllItems];
@@ -758,16 +843,13 @@ inTagState(OFXMLParser *self)
 					 prefix: self->_prefix
 				      namespace: namespace];
 
+		[self->_previous removeLastObject];
+
 		if (self->_previous.count == 0)
 			self->_finishedParsing = true;
 
 		[self->_namespaces removeLastObject];
-	} else if (self->_prefix != nil) {
-		OFString *str = [OFString stringWithFormat:
-		    @"%@:%@", self->_prefix, self->_name];
-		[self->_previous addObject: str];
-	} else
-		[self->_previous addObject: self->_name];
+	}
 
 	objc_autoreleasePoolPop(pool);
 
@@ -785,43 +867,26 @@ inTagState(OFXMLParser *self)
 static void
 inAttributeNameState(OFXMLParser *self)
 {
-	void *pool;
-	OFString *bufferString;
-	const char *bufferCString, *tmp;
-	size_t length, bufferLength;
+	const char *bytes, *tmp;
+	size_t length;
 
 	if (self->_data[self->_i] != '='  && self->_data[self->_i] != ' '  &&
 	    self->_data[self->_i] != '\t' && self->_data[self->_i] != '\n' &&
 	    self->_data[self->_i] != '\r')
 		return;
 
-	if ((length = self->_i - self->_last) > 0)
-		appendToBuffer(self->_buffer, self->_data + self->_last,
-		    self->_encoding, length);
+	bytes = pendingBytes(self, &length);
 
-	pool = objc_autoreleasePoolPush();
-
-	bufferString = [OFString stringWithUTF8String: self->_buffer.items
-					       length: self->_buffer.count];
-
-	bufferCString = bufferString.UTF8String;
-	bufferLength = bufferString.UTF8StringLength;
-
-	if ((tmp = memchr(bufferCString, ':', bufferLength)) != NULL) {
-		self->_attributeName = [[OFString alloc]
-		    initWithUTF8String: tmp + 1
-				length: bufferLength -
-					(tmp - bufferCString) - 1];
-		self->_attributePrefix = [[OFString alloc]
-		    initWithUTF8String: bufferCString
-				length: tmp - bufferCString];
+	if ((tmp = memchr(bytes, ':', length)) != NULL) {
+		self->_attributeName = [internName(self, tmp + 1,
+		    length - (tmp - bytes) - 1) retain];
+		self->_attributePrefix = [internName(self, bytes,
+		    tmp - bytes) retain];
 	} else {
-		self->_attributeName = [bufferString copy];
+		self->_attributeName = [internName(self, bytes, length) retain];
 		self->_attributePrefix = nil;
 	}
 
-	objc_autoreleasePoolPop(pool);
-
 	[self->_buffer removeAllItems];
 
 	self->_last = self->_i + 1;
@@ -867,26 +932,21 @@ inAttributeValueState(OFXMLParser *self)
 {
 	void *pool;
 	OFString *attributeValue;
-	size_t length;
 	OFXMLAttribute *attribute;
 
 	if (self->_data[self->_i] != self->_delimiter)
 		return;
 
-	if ((length = self->_i - self->_last) > 0)
-		appendToBuffer(self->_buffer, self->_data + self->_last,
-		    self->_encoding, length);
-
 	pool = objc_autoreleasePoolPush();
-	attributeValue = transformString(self, self->_buffer, 0, true);
+	attributeValue = transformString(self, 0, true);
 
 	if (self->_attributePrefix == nil &&
 	    [self->_attributeName isEqual: @"xmlns"])
-		[self->_namespaces.lastObject setObject: attributeValue
-						 forKey: @""];
+		[currentNamespaces(self) setObject: attributeValue
+					    forKey: @""];
 	if ([self->_attributePrefix isEqual: @"xmlns"])
-		[self->_namespaces.lastObject setObject: attributeValue
-						 forKey: self->_attributeName];
+		[currentNamespaces(self) setObject: attributeValue
+					    forKey: self->_attributeName];
 
 	attribute = [OFXMLAttribute attributeWithName: self->_attributeName
 					    namespace: self->_attributePrefix
@@ -974,9 +1034,7 @@ inCDATAState(OFXMLParser *self)
 		void *pool = objc_autoreleasePoolPush();
 		OFString *CDATA;
 
-		appendToBuffer(self->_buffer, self->_data + self->_last,
-		    self->_encoding, self->_i - self->_last);
-		CDATA = transformString(self, self->_buffer, 2, false);
+		CDATA = transformString(self, 2, false);
 
 		if ([self->_delegate respondsToSelector:
 		    @selector(parser:foundCDATA:)])
@@ -1027,9 +1085,7 @@ inCommentState2(OFXMLParser *self)
 
 	pool = objc_autoreleasePoolPush();
 
-	appendToBuffer(self->_buffer, self->_data + self->_last,
-	    self->_encoding, self->_i - self->_last);
-	comment = transformString(self, self->_buffer, 2, false);
+	comment = transformString(self, 2, false);
 
 	if ([self->_delegate respondsToSelector:
 	    @selector(parser:foundComment:)])
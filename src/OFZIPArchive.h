@@ -24,6 +24,7 @@
 OF_ASSUME_NONNULL_BEGIN
 
 @class OFArray OF_GENERIC(ObjectType);
+@class OFData;
 @class OFMutableArray OF_GENERIC(ObjectType);
 @class OFMutableDictionary OF_GENERIC(KeyType, ObjectType);
 @class OFSeekableStream;
@@ -80,6 +81,11 @@ OF_SUBCLASSING_RESTRICTED
 	OFMutableDictionary OF_GENERIC(OFString *, OFZIPArchiveEntry *)
 	    *_pathToEntryMap;
 	OFStream *_Nullable _lastReturnedStream;
+	OFStream *_Nullable _streamPositionOwner;
+	OFData *_Nullable _centralDirectory;
+	struct _OFZIPArchiveIndexEntry *_Nullable _index;
+	size_t *_Nullable _indexBuckets;
+	size_t _indexCount, _indexBucketsMask;
 }
 
 /**
@@ -178,11 +184,16 @@ OF_SUBCLASSING_RESTRICTED
  * @note The returned stream conforms to @ref OFReadyForReadingObserving if the
  *	 underlying stream does so, too.
  *
- * @warning Calling @ref streamForReadingFile: will invalidate all streams
- *	    previously returned by @ref streamForReadingFile: or
- *	    @ref streamForWritingEntry:! Reading from or writing to an
- *	    invalidated stream will throw an @ref OFReadFailedException or
- *	    @ref OFWriteFailedException!
+ * If the archive consists of a single part, the returned streams are
+ * independent of each other: Each of them keeps its own position in the
+ * archive, so that several files can be read interleaved. They still share
+ * the underlying stream, so they must not be read from different threads at
+ * the same time.
+ *
+ * @warning For archives split into multiple parts, calling
+ *	    @ref streamForReadingFile: will invalidate all streams previously
+ *	    returned by @ref streamForReadingFile:! Reading from an invalidated
+ *	    stream will throw an @ref OFReadFailedException!
  *
  * @param path The path to the file inside the archive
  * @return A stream for reading the specified file form the archive
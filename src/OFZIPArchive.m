@@ -34,10 +34,12 @@
 #import "OFDictionary.h"
 #import "OFIRI.h"
 #import "OFIRIHandler.h"
+#import "OFMemoryStream.h"
 #import "OFInflate64Stream.h"
 #import "OFInflateStream.h"
 #import "OFSeekableStream.h"
 #import "OFStream.h"
+#import "OFString+Private.h"
 
 #import "OFChecksumMismatchException.h"
 #import "OFInvalidArgumentException.h"
@@ -62,6 +64,18 @@ enum {
 	modeAppend
 };
 
+/*
+ * Entry in the index of the central directory that is built instead of
+ * creating all OFZIPArchiveEntry objects upfront when reading an archive that
+ * consists of a single part. The entry object is only created once needed.
+ */
+struct _OFZIPArchiveIndexEntry {
+	size_t offset, length;
+	unsigned long hash;
+	bool fileNameIsUTF8;
+	OFZIPArchiveEntry *entry;
+};
+
 OF_DIRECT_MEMBERS
 @interface OFZIPArchive ()
 - (void)of_readZIPInfo;
@@ -102,6 +116,20 @@ OF_DIRECT_MEMBERS
 			     entry: (OFZIPArchiveEntry *)entry;
 @end
 
+OF_DIRECT_MEMBERS
+@interface OFZIPArchiveEntryDataStream: OFStream <OFReadyForReadingObserving>
+{
+	OFZIPArchive *_archive;
+	OFStreamOffset _offset;
+	unsigned long long _toRead;
+	bool _atEndOfStream;
+}
+
+- (instancetype)of_initWithArchive: (OFZIPArchive *)archive
+			    offset: (OFStreamOffset)offset
+			    length: (unsigned long long)length;
+@end
+
 OF_DIRECT_MEMBERS
 @interface OFZIPArchiveFileWriteStream: OFStream
 {
@@ -162,6 +190,8 @@ static void
 seekOrThrowInvalidFormat(OFZIPArchive *archive, const uint32_t *diskNumber,
     OFStreamOffset offset, OFSeekWhence whence)
 {
+	archive->_streamPositionOwner = nil;
+
 	if (diskNumber != NULL && *diskNumber != archive->_diskNumber) {
 		OFStream *oldStream = archive->_stream;
 		OFSeekableStream *stream;
@@ -192,6 +222,172 @@ seekOrThrowInvalidFormat(OFZIPArchive *archive, const uint32_t *diskNumber,
 	}
 }
 
+static uint16_t
+readIndexField16(const unsigned char *bytes)
+{
+	return (uint16_t)bytes[0] | (uint16_t)bytes[1] << 8;
+}
+
+static bool
+isASCII(const unsigned char *bytes, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+		if (bytes[i] & 0x80)
+			return false;
+
+	return true;
+}
+
+static void
+indexCentralDirectory(OFZIPArchive *self)
+{
+	const unsigned char *bytes;
+	size_t size, offset = 0, bucketsCount = 1;
+
+	/* Every entry in the central directory is at least 46 bytes. */
+	if (self->_centralDirectorySize > SIZE_MAX ||
+	    self->_centralDirectoryEntries > self->_centralDirectorySize / 46)
+		@throw [OFInvalidFormatException exception];
+
+	size = (size_t)self->_centralDirectorySize;
+	self->_centralDirectory =
+	    [[self->_stream readDataWithCount: size] retain];
+	bytes = self->_centralDirectory.items;
+
+	self->_indexCount = (size_t)self->_centralDirectoryEntries;
+	self->_index = OFAllocZeroedMemory(self->_indexCount,
+	    sizeof(*self->_index));
+
+	while (bucketsCount < self->_indexCount * 2)
+		bucketsCount <<= 1;
+
+	self->_indexBuckets = OFAllocZeroedMemory(bucketsCount,
+	    sizeof(*self->_indexBuckets));
+	self->_indexBucketsMask = bucketsCount - 1;
+
+	for (size_t i = 0; i < self->_indexCount; i++) {
+		struct _OFZIPArchiveIndexEntry *indexEntry = &self->_index[i];
+		const unsigned char *record = bytes + offset;
+		const unsigned char *fileName = record + 46;
+		uint16_t fileNameLength;
+		size_t length;
+
+		if (size - offset < 46 || record[0] != 0x50 ||
+		    record[1] != 0x4B || record[2] != 0x01 || record[3] != 0x02)
+			@throw [OFInvalidFormatException exception];
+
+		fileNameLength = readIndexField16(record + 28);
+		length = 46 + fileNameLength + readIndexField16(record + 30) +
+		    readIndexField16(record + 32);
+
+		if (length > size - offset)
+			@throw [OFInvalidFormatException exception];
+
+		indexEntry->offset = offset;
+		indexEntry->length = length;
+		indexEntry->fileNameIsUTF8 =
+		    ((readIndexField16(record + 8) & (1u << 11)) ||
+		    isASCII(fileName, fileNameLength));
+
+		if (indexEntry->fileNameIsUTF8)
+			indexEntry->hash = _OFUTF8StringHash(
+			    (const char *)fileName, fileNameLength);
+		else {
+			void *pool = objc_autoreleasePoolPush();
+			OFString *string = [OFString
+			    stringWithCString: (const char *)fileName
+				     encoding: OFStringEncodingCodepage437
+				       length: fileNameLength];
+
+			indexEntry->hash = _OFUTF8StringHash(string.UTF8String,
+			    string.UTF8StringLength);
+
+			objc_autoreleasePoolPop(pool);
+		}
+
+		for (size_t j = indexEntry->hash & self->_indexBucketsMask;;
+		    j = (j + 1) & self->_indexBucketsMask) {
+			const struct _OFZIPArchiveIndexEntry *other;
+
+			if (self->_indexBuckets[j] == 0) {
+				self->_indexBuckets[j] = i + 1;
+				break;
+			}
+
+			other = &self->_index[self->_indexBuckets[j] - 1];
+			if (other->hash == indexEntry->hash &&
+			    readIndexField16(bytes + other->offset + 28) ==
+			    fileNameLength && memcmp(bytes + other->offset + 46,
+			    fileName, fileNameLength) == 0)
+				@throw [OFInvalidFormatException exception];
+		}
+
+		offset += length;
+	}
+}
+
+static OFZIPArchiveEntry *
+indexedEntry(OFZIPArchive *self, struct _OFZIPArchiveIndexEntry *indexEntry)
+{
+	if (indexEntry->entry == nil) {
+		void *pool = objc_autoreleasePoolPush();
+		OFMemoryStream *stream = [OFMemoryStream
+		    streamWithMemoryAddress: (unsigned char *)
+						 self->_centralDirectory.items +
+						 indexEntry->offset
+				       size: indexEntry->length
+				   writable: false];
+
+		indexEntry->entry =
+		    [[OFZIPArchiveEntry alloc] of_initWithStream: stream];
+
+		objc_autoreleasePoolPop(pool);
+	}
+
+	return indexEntry->entry;
+}
+
+static OFZIPArchiveEntry *
+entryForPath(OFZIPArchive *self, OFString *path)
+{
+	const unsigned char *bytes;
+	const char *UTF8String;
+	size_t UTF8StringLength;
+	unsigned long hash;
+
+	if (self->_index == NULL)
+		return [self->_pathToEntryMap objectForKey: path];
+
+	bytes = self->_centralDirectory.items;
+	UTF8String = path.UTF8String;
+	UTF8StringLength = path.UTF8StringLength;
+	hash = _OFUTF8StringHash(UTF8String, UTF8StringLength);
+
+	for (size_t i = hash & self->_indexBucketsMask;
+	    self->_indexBuckets[i] != 0;
+	    i = (i + 1) & self->_indexBucketsMask) {
+		struct _OFZIPArchiveIndexEntry *indexEntry =
+		    &self->_index[self->_indexBuckets[i] - 1];
+
+		if (indexEntry->hash != hash)
+			continue;
+
+		if (indexEntry->fileNameIsUTF8) {
+			const unsigned char *record =
+			    bytes + indexEntry->offset;
+
+			if (readIndexField16(record + 28) == UTF8StringLength &&
+			    memcmp(record + 46, UTF8String,
+			    UTF8StringLength) == 0)
+				return indexedEntry(self, indexEntry);
+		} else if ([indexedEntry(self, indexEntry).fileName
+		    isEqual: path])
+			return indexEntry->entry;
+	}
+
+	return nil;
+}
+
 + (instancetype)archiveWithStream: (OFStream *)stream mode: (OFString *)mode
 {
 	return [[[self alloc] initWithStream: stream mode: mode] autorelease];
@@ -291,6 +487,14 @@ seekOrThrowInvalidFormat(OFZIPArchive *archive, const uint32_t *diskNumber,
 	[_entries release];
 	[_pathToEntryMap release];
 
+	if (_index != NULL)
+		for (size_t i = 0; i < _indexCount; i++)
+			[_index[i].entry release];
+
+	OFFreeMemory(_index);
+	OFFreeMemory(_indexBuckets);
+	[_centralDirectory release];
+
 	[super dealloc];
 }
 
@@ -399,6 +603,18 @@ seekOrThrowInvalidFormat(OFZIPArchive *archive, const uint32_t *diskNumber,
 	seekOrThrowInvalidFormat(self, &_centralDirectoryDisk,
 	    (OFStreamOffset)_centralDirectoryOffset, OFSeekSet);
 
+	/*
+	 * Archives that are only read and consist of a single part only get
+	 * an index of the central directory, so that opening archives with
+	 * lots of entries does not need to create an object for each entry.
+	 */
+	if (_mode == modeRead && _lastDiskNumber == 0 &&
+	    _centralDirectoryEntries > 0) {
+		indexCentralDirectory(self);
+		objc_autoreleasePoolPop(pool);
+		return;
+	}
+
 	for (size_t i = 0; i < _centralDirectoryEntries; i++) {
 		OFZIPArchiveEntry *entry;
 		char buffer;
@@ -448,6 +664,15 @@ seekOrThrowInvalidFormat(OFZIPArchive *archive, const uint32_t *diskNumber,
 
 - (OFArray *)entries
 {
+	if (_index != NULL && _entries.count == 0) {
+		void *pool = objc_autoreleasePoolPush();
+
+		for (size_t i = 0; i < _indexCount; i++)
+			[_entries addObject: indexedEntry(self, &_index[i])];
+
+		objc_autoreleasePoolPop(pool);
+	}
+
 	return [[_entries copy] autorelease];
 }
 
@@ -474,6 +699,7 @@ seekOrThrowInvalidFormat(OFZIPArchive *archive, const uint32_t *diskNumber,
 - (OFStream *)streamForReadingFile: (OFString *)path
 {
 	void *pool = objc_autoreleasePoolPush();
+	OFStream *stream;
 	OFZIPArchiveEntry *entry;
 	OFZIPArchiveLocalFileHeader *localFileHeader;
 	uint32_t startDiskNumber;
@@ -485,17 +711,27 @@ seekOrThrowInvalidFormat(OFZIPArchive *archive, const uint32_t *diskNumber,
 	if (_mode != modeRead)
 		@throw [OFInvalidArgumentException exception];
 
-	if ((entry = [_pathToEntryMap objectForKey: path]) == nil)
+	if ((entry = entryForPath(self, path)) == nil)
 		@throw [OFOpenItemFailedException exceptionWithPath: path
 							       mode: @"r"
 							      errNo: ENOENT];
 
-	@try {
-		[_lastReturnedStream close];
-	} @catch (OFNotOpenException *e) {
-		/* Might have already been closed by the user - that's fine. */
+	/*
+	 * Streams for archives with a single part read via an
+	 * OFZIPArchiveEntryDataStream, which remembers its own position, so
+	 * only streams for multi-part archives need to be invalidated.
+	 */
+	if (_lastDiskNumber > 0) {
+		@try {
+			[_lastReturnedStream close];
+		} @catch (OFNotOpenException *e) {
+			/*
+			 * Might have already been closed by the user - that's
+			 * fine.
+			 */
+		}
+		_lastReturnedStream = nil;
 	}
-	_lastReturnedStream = nil;
 
 	startDiskNumber = entry.of_startDiskNumber;
 	offset64 = entry.of_localFileHeaderOffset;
@@ -519,6 +755,26 @@ seekOrThrowInvalidFormat(OFZIPArchive *archive, const uint32_t *diskNumber,
 		    exceptionWithVersion: version];
 	}
 
+	if (_lastDiskNumber == 0) {
+		OFStreamOffset dataOffset =
+		    [_stream seekToOffset: 0 whence: OFSeekCurrent];
+
+		stream = [[[OFZIPArchiveEntryDataStream alloc]
+		    of_initWithArchive: self
+				offset: dataOffset
+				length: entry.compressedSize] autorelease];
+		/* The underlying stream is already at the right position. */
+		_streamPositionOwner = stream;
+		stream = [[OFZIPArchiveFileReadStream alloc]
+		    of_initWithArchive: self
+				stream: stream
+				 entry: entry];
+
+		objc_autoreleasePoolPop(pool);
+
+		return [stream autorelease];
+	}
+
 	objc_autoreleasePoolPop(pool);
 
 	_lastReturnedStream = [[[OFZIPArchiveFileReadStream alloc]
@@ -816,15 +1072,15 @@ seekOrThrowInvalidFormat(OFZIPArchive *archive, const uint32_t *diskNumber,
 
 		switch (_compressionMethod) {
 		case OFZIPArchiveEntryCompressionMethodNone:
-			_decompressedStream = [_archive->_stream retain];
+			_decompressedStream = [stream retain];
 			break;
 		case OFZIPArchiveEntryCompressionMethodDeflate:
 			_decompressedStream = [[OFInflateStream alloc]
-			    initWithStream: _archive->_stream];
+			    initWithStream: stream];
 			break;
 		case OFZIPArchiveEntryCompressionMethodDeflate64:
 			_decompressedStream = [[OFInflate64Stream alloc]
-			    initWithStream: _archive->_stream];
+			    initWithStream: stream];
 			break;
 		default:
 			@throw [OFNotImplementedException
@@ -876,7 +1132,8 @@ seekOrThrowInvalidFormat(OFZIPArchive *archive, const uint32_t *diskNumber,
 	if (_atEndOfStream)
 		return 0;
 
-	if ([_archive->_stream isAtEndOfStream] &&
+	if (_archive->_lastDiskNumber > 0 &&
+	    [_archive->_stream isAtEndOfStream] &&
 	    ![_decompressedStream hasDataInReadBuffer]) {
 		OFStream *oldStream = _archive->_stream, *oldDecompressedStream;
 		OFSeekableStream *stream;
@@ -968,6 +1225,97 @@ seekOrThrowInvalidFormat(OFZIPArchive *archive, const uint32_t *diskNumber,
 }
 @end
 
+@implementation OFZIPArchiveEntryDataStream
+- (instancetype)of_initWithArchive: (OFZIPArchive *)archive
+			    offset: (OFStreamOffset)offset
+			    length: (unsigned long long)length
+{
+	self = [super init];
+
+	_archive = [archive retain];
+	_offset = offset;
+	_toRead = length;
+	_atEndOfStream = (length == 0);
+
+	return self;
+}
+
+- (void)dealloc
+{
+	if (_archive->_streamPositionOwner == self)
+		_archive->_streamPositionOwner = nil;
+
+	[_archive release];
+
+	[super dealloc];
+}
+
+- (bool)lowlevelIsAtEndOfStream
+{
+	if (_archive->_stream == nil)
+		@throw [OFNotOpenException exceptionWithObject: self];
+
+	return _atEndOfStream;
+}
+
+- (size_t)lowlevelReadIntoBuffer: (void *)buffer length: (size_t)length
+{
+	size_t ret;
+
+	if (_archive->_stream == nil)
+		@throw [OFNotOpenException exceptionWithObject: self];
+
+	if (_atEndOfStream)
+		return 0;
+
+	/*
+	 * Only seek if another stream moved the underlying stream since our
+	 * last read, so that reading a single file at a time does not seek
+	 * (and thus discard the read buffer of the underlying stream) on
+	 * every read.
+	 */
+	if (_archive->_streamPositionOwner != self) {
+		seekOrThrowInvalidFormat(_archive, NULL, _offset, OFSeekSet);
+		_archive->_streamPositionOwner = self;
+	}
+
+#if SIZE_MAX >= UINT64_MAX
+	if (length > UINT64_MAX)
+		@throw [OFOutOfRangeException exception];
+#endif
+
+	if (length > _toRead)
+		length = (size_t)_toRead;
+
+	ret = [_archive->_stream readIntoBuffer: buffer length: length];
+
+	if (ret == 0 && [_archive->_stream isAtEndOfStream])
+		@throw [OFTruncatedDataException exception];
+
+	_offset += ret;
+	_toRead -= ret;
+
+	if (_toRead == 0)
+		_atEndOfStream = true;
+
+	return ret;
+}
+
+- (bool)lowlevelHasDataInReadBuffer
+{
+	if (_archive->_streamPositionOwner != self)
+		return false;
+
+	return ((OFStream *)_archive->_stream).hasDataInReadBuffer;
+}
+
+- (int)fileDescriptorForReading
+{
+	return ((id <OFReadyForReadingObserving>)_archive->_stream)
+	    .fileDescriptorForReading;
+}
+@end
+
 @implementation OFZIPArchiveFileWriteStream
 - (instancetype)of_initWithArchive: (OFZIPArchive *)archive
 			    stream: (OFStream *)stream
@@ -142,7 +142,10 @@
 #import "OFXMLParser.h"
 #import "OFXMLElementBuilder.h"
 
+#import "OFJSONParser.h"
+
 #import "OFMessagePackExtension.h"
+#import "OFMessagePackParser.h"
 
 #import "OFApplication.h"
 #import "OFSystemInfo.h"
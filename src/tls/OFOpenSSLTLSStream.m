@@ -24,7 +24,11 @@
 #import "OFOpenSSLTLSStream.h"
 #import "OFArray.h"
 #import "OFData.h"
+#import "OFDictionary.h"
 #import "OFOpenSSLX509Certificate.h"
+#ifdef OF_HAVE_THREADS
+# import "OFPlainMutex.h"
+#endif
 
 #include <openssl/err.h>
 
@@ -37,8 +41,134 @@
 
 #define bufferSize OFOpenSSLTLSStreamBufferSize
 
+OF_DIRECT_MEMBERS
+@interface OFOpenSSLTLSSession: OFObject
+{
+@public
+	SSL_SESSION *_session;
+}
+
+- (instancetype)initWithSession: (SSL_SESSION *)session;
+@end
+
 int _ObjFWTLS_reference;
 static SSL_CTX *clientContext, *serverContext;
+/* Only the client sessions are cached here, the server uses OpenSSL's cache. */
+static OFMutableDictionary OF_GENERIC(OFString *, OFOpenSSLTLSSession *)
+    *sessionCache;
+static size_t sessionCacheSize = SSL_SESSION_CACHE_MAX_SIZE_DEFAULT;
+static unsigned long long numberOfResumedHandshakes, numberOfFullHandshakes;
+#ifdef OF_HAVE_THREADS
+static OFPlainMutex sessionCacheMutex;
+#endif
+
+static void
+lockSessionCache(void)
+{
+#ifdef OF_HAVE_THREADS
+	OFEnsure(OFPlainMutexLock(&sessionCacheMutex) == 0);
+#endif
+}
+
+static void
+unlockSessionCache(void)
+{
+#ifdef OF_HAVE_THREADS
+	OFEnsure(OFPlainMutexUnlock(&sessionCacheMutex) == 0);
+#endif
+}
+
+/*
+ * Called by OpenSSL whenever the client received a new session. With TLS 1.3,
+ * this happens after the handshake, when the server sends a session ticket.
+ */
+static int
+newSessionCallback(SSL *SSL_, SSL_SESSION *session)
+{
+	const char *host = SSL_get_servername(SSL_, TLSEXT_NAMETYPE_host_name);
+	void *pool;
+	int ret = 0;
+
+	/*
+	 * OpenSSL neither verifies the certificate nor the host again when a
+	 * session is resumed, so only sessions of verified connections may be
+	 * cached. Sessions that authenticated with a client certificate are
+	 * not cached either, as they must not be resumed without it.
+	 */
+	if (host == NULL || !(SSL_get_verify_mode(SSL_) & SSL_VERIFY_PEER) ||
+	    SSL_get_verify_result(SSL_) != X509_V_OK ||
+	    SSL_get_certificate(SSL_) != NULL)
+		return 0;
+
+	pool = objc_autoreleasePoolPush();
+	lockSessionCache();
+	@try {
+		OFString *key;
+		OFOpenSSLTLSSession *cachedSession;
+
+		if (sessionCacheSize == 0)
+			return 0;
+
+		key = [OFString stringWithUTF8String: host];
+
+		/* Evict an arbitrary session to make room. */
+		if (sessionCache.count >= sessionCacheSize &&
+		    [sessionCache objectForKey: key] == nil)
+			[sessionCache removeObjectForKey:
+			    sessionCache.keyEnumerator.nextObject];
+
+		cachedSession = [[[OFOpenSSLTLSSession alloc]
+		    initWithSession: session] autorelease];
+		[sessionCache setObject: cachedSession forKey: key];
+
+		/* The cache took over the reference passed to us. */
+		ret = 1;
+	} @catch (id e) {
+		/* Exceptions must not be thrown through OpenSSL. */
+		ret = 0;
+	} @finally {
+		unlockSessionCache();
+		objc_autoreleasePoolPop(pool);
+	}
+
+	return ret;
+}
+
+static SSL_SESSION *
+copyCachedSession(OFString *host)
+{
+	SSL_SESSION *session = NULL;
+
+	lockSessionCache();
+	@try {
+		OFOpenSSLTLSSession *cachedSession =
+		    [sessionCache objectForKey: host];
+
+		if (cachedSession != nil &&
+#ifdef HAVE_SSL_SESSION_IS_RESUMABLE
+		    SSL_SESSION_is_resumable(cachedSession->_session) &&
+#endif
+		    SSL_SESSION_up_ref(cachedSession->_session) == 1)
+			session = cachedSession->_session;
+	} @finally {
+		unlockSessionCache();
+	}
+
+	return session;
+}
+
+static void
+countHandshake(SSL *SSL_)
+{
+	lockSessionCache();
+
+	if (SSL_session_reused(SSL_))
+		numberOfResumedHandshakes++;
+	else
+		numberOfFullHandshakes++;
+
+	unlockSessionCache();
+}
 
 static OFTLSStreamErrorCode
 verifyResultToErrorCode(const SSL *SSL_)
@@ -101,6 +231,100 @@ errToErrorCode(const SSL *SSL_)
 	if ((serverContext = SSL_CTX_new(TLS_server_method())) == NULL)
 		@throw [OFInitializationFailedException
 		    exceptionWithClass: self];
+
+#ifdef OF_HAVE_THREADS
+	if (OFPlainMutexNew(&sessionCacheMutex) != 0)
+		@throw [OFInitializationFailedException
+		    exceptionWithClass: self];
+#endif
+
+	sessionCache = [[OFMutableDictionary alloc] init];
+
+	SSL_CTX_set_session_cache_mode(clientContext,
+	    SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(clientContext, newSessionCallback);
+}
+
++ (size_t)sessionCacheSize
+{
+	size_t ret;
+
+	lockSessionCache();
+	ret = sessionCacheSize;
+	unlockSessionCache();
+
+	return ret;
+}
+
++ (void)setSessionCacheSize: (size_t)size
+{
+	lockSessionCache();
+	@try {
+		sessionCacheSize = size;
+
+		while (sessionCache.count > size)
+			[sessionCache removeObjectForKey:
+			    sessionCache.keyEnumerator.nextObject];
+
+		/*
+		 * For OpenSSL, a size of 0 means unlimited, so disable the
+		 * server cache instead. Session tickets do not need to be
+		 * stored by the server and thus keep working.
+		 */
+		if (size > 0) {
+			SSL_CTX_set_session_cache_mode(serverContext,
+			    SSL_SESS_CACHE_SERVER);
+			SSL_CTX_sess_set_cache_size(serverContext,
+			    (size <= LONG_MAX ? (long)size : LONG_MAX));
+		} else
+			SSL_CTX_set_session_cache_mode(serverContext,
+			    SSL_SESS_CACHE_OFF);
+	} @finally {
+		unlockSessionCache();
+	}
+}
+
++ (unsigned long long)numberOfResumedHandshakes
+{
+	unsigned long long ret;
+
+	lockSessionCache();
+	ret = numberOfResumedHandshakes;
+	unlockSessionCache();
+
+	return ret;
+}
+
++ (unsigned long long)numberOfFullHandshakes
+{
+	unsigned long long ret;
+
+	lockSessionCache();
+	ret = numberOfFullHandshakes;
+	unlockSessionCache();
+
+	return ret;
+}
+
+/*
+ * Writes everything that is pending in the write BIO to the underlying stream
+ * at once, directly from the memory of the BIO instead of copying it in chunks
+ * of bufferSize into _buffer first.
+ */
+static void
+flushWriteBIO(OFOpenSSLTLSStream *self)
+{
+	char *data;
+	long length = BIO_get_mem_data(self->_writeBIO, &data);
+
+	if (length <= 0)
+		return;
+
+	[self->_underlyingStream writeBuffer: data length: (size_t)length];
+	[self->_underlyingStream flushWriteBuffer];
+
+	/* Resetting a writable memory BIO discards its contents. */
+	OFEnsure(BIO_reset(self->_writeBIO) == 1);
 }
 
 - (instancetype)initWithStream: (OFStream <OFReadyForReadingObserving,
@@ -141,14 +365,7 @@ errToErrorCode(const SSL *SSL_)
 	if (_handshakeDone) {
 		SSL_shutdown(_SSL);
 
-		while (BIO_ctrl_pending(_writeBIO) > 0) {
-			int tmp = BIO_read(_writeBIO, _buffer, bufferSize);
-
-			OFEnsure(tmp >= 0);
-
-			[_underlyingStream writeBuffer: _buffer length: tmp];
-			[_underlyingStream flushWriteBuffer];
-		}
+		flushWriteBIO(self);
 	}
 
 	SSL_free(_SSL);
@@ -173,28 +390,36 @@ errToErrorCode(const SSL *SSL_)
 	ERR_clear_error();
 	ret = SSL_read_ex(_SSL, buffer, length, &bytesRead);
 
-	while (BIO_ctrl_pending(_writeBIO) > 0) {
-		int tmp = BIO_read(_writeBIO, _buffer, bufferSize);
-
-		OFEnsure(tmp >= 0);
-
-		[_underlyingStream writeBuffer: _buffer length: tmp];
-		[_underlyingStream flushWriteBuffer];
-	}
+	flushWriteBIO(self);
 
 	if (ret == 1)
 		return bytesRead;
 
 	if (SSL_get_error(_SSL, ret) == SSL_ERROR_WANT_READ) {
 		if (BIO_ctrl_pending(_readBIO) < 1) {
+			/*
+			 * If the buffer of the caller is larger than ours,
+			 * read the ciphertext into it so that a whole record
+			 * can be read at once. This is safe, as BIO_write()
+			 * copies it before SSL_read_ex() writes the plaintext.
+			 */
+			char *readBuffer = _buffer;
+			size_t readLength = bufferSize;
+
+			if (length > bufferSize) {
+				readBuffer = buffer;
+				readLength = (length <= INT_MAX
+				    ? length : INT_MAX);
+			}
+
 			@try {
 				size_t tmp = [_underlyingStream
-				    readIntoBuffer: _buffer
-					    length: bufferSize];
+				    readIntoBuffer: readBuffer
+					    length: readLength];
 
 				OFEnsure(tmp <= INT_MAX);
 				/* Writing to a memory BIO must never fail. */
-				OFEnsure(BIO_write(_readBIO, _buffer,
+				OFEnsure(BIO_write(_readBIO, readBuffer,
 				    (int)tmp) == (int)tmp);
 			} @catch (OFReadFailedException *e) {
 				if (e.errNo == EWOULDBLOCK || e.errNo != EAGAIN)
@@ -205,14 +430,7 @@ errToErrorCode(const SSL *SSL_)
 		ERR_clear_error();
 		ret = SSL_read_ex(_SSL, buffer, length, &bytesRead);
 
-		while (BIO_ctrl_pending(_writeBIO) > 0) {
-			int tmp = BIO_read(_writeBIO, _buffer, bufferSize);
-
-			OFEnsure(tmp >= 0);
-
-			[_underlyingStream writeBuffer: _buffer length: tmp];
-			[_underlyingStream flushWriteBuffer];
-		}
+		flushWriteBIO(self);
 
 		if (ret == 1)
 			return bytesRead;
@@ -250,14 +468,7 @@ errToErrorCode(const SSL *SSL_)
 							     errNo: errNo];
 	}
 
-	while (BIO_ctrl_pending(_writeBIO) > 0) {
-		int tmp = BIO_read(_writeBIO, _buffer, bufferSize);
-
-		OFEnsure(tmp >= 0);
-
-		[_underlyingStream writeBuffer: _buffer length: tmp];
-		[_underlyingStream flushWriteBuffer];
-	}
+	flushWriteBIO(self);
 
 	return bytesWritten;
 }
@@ -323,6 +534,8 @@ errToErrorCode(const SSL *SSL_)
 	_server = server;
 
 	if (!server) {
+		SSL_SESSION *session;
+
 		if (SSL_set_tlsext_host_name(_SSL, _host.UTF8String) != 1)
 			@throw [OFTLSHandshakeFailedException
 			    exceptionWithStream: self
@@ -337,6 +550,17 @@ errToErrorCode(const SSL *SSL_)
 				    exceptionWithStream: self
 						   host: host
 					      errorCode: initFailedErrorCode];
+
+			/*
+			 * Only verified sessions without a client certificate
+			 * are cached, see newSessionCallback().
+			 */
+			if (_certificateChain.count == 0 &&
+			    (session = copyCachedSession(_host)) != NULL) {
+				/* Failing to resume means a full handshake. */
+				SSL_set_session(_SSL, session);
+				SSL_SESSION_free(session);
+			}
 		}
 	}
 
@@ -370,18 +594,12 @@ errToErrorCode(const SSL *SSL_)
 	ERR_clear_error();
 	status = SSL_do_handshake(_SSL);
 
-	while (BIO_ctrl_pending(_writeBIO) > 0) {
-		int tmp = BIO_read(_writeBIO, _buffer, bufferSize);
-
-		OFEnsure(tmp >= 0);
-
-		[_underlyingStream writeBuffer: _buffer length: tmp];
-		[_underlyingStream flushWriteBuffer];
-	}
+	flushWriteBIO(self);
 
-	if (status == 1)
+	if (status == 1) {
 		_handshakeDone = true;
-	else {
+		countHandshake(_SSL);
+	} else {
 		switch (SSL_get_error(_SSL, status)) {
 		case SSL_ERROR_WANT_READ:
 			[_underlyingStream asyncReadIntoBuffer: _buffer
@@ -459,18 +677,12 @@ errToErrorCode(const SSL *SSL_)
 		ERR_clear_error();
 		status = SSL_do_handshake(_SSL);
 
-		while (BIO_ctrl_pending(_writeBIO) > 0) {
-			int tmp = BIO_read(_writeBIO, buffer, bufferSize);
-
-			OFEnsure(tmp >= 0);
-
-			[_underlyingStream writeBuffer: _buffer length: tmp];
-			[_underlyingStream flushWriteBuffer];
-		}
+		flushWriteBIO(self);
 
-		if (status == 1)
+		if (status == 1) {
 			_handshakeDone = true;
-		else {
+			countHandshake(_SSL);
+		} else {
 			switch (SSL_get_error(_SSL, status)) {
 			case SSL_ERROR_WANT_READ:
 				return true;
@@ -525,30 +737,17 @@ errToErrorCode(const SSL *SSL_)
 		int status;
 		OFRunLoopMode runLoopMode;
 
-		while (BIO_ctrl_pending(_writeBIO) > 0) {
-			int tmp = BIO_read(_writeBIO, _buffer, bufferSize);
-
-			OFEnsure(tmp >= 0);
-
-			[_underlyingStream writeBuffer: _buffer length: tmp];
-			[_underlyingStream flushWriteBuffer];
-		}
+		flushWriteBIO(self);
 
 		ERR_clear_error();
 		status = SSL_do_handshake(_SSL);
 
-		while (BIO_ctrl_pending(_writeBIO) > 0) {
-			int tmp = BIO_read(_writeBIO, _buffer, bufferSize);
-
-			OFEnsure(tmp >= 0);
+		flushWriteBIO(self);
 
-			[_underlyingStream writeBuffer: _buffer length: tmp];
-			[_underlyingStream flushWriteBuffer];
-		}
-
-		if (status == 1)
+		if (status == 1) {
 			_handshakeDone = true;
-		else {
+			countHandshake(_SSL);
+		} else {
 			switch (SSL_get_error(_SSL, status)) {
 			case SSL_ERROR_WANT_READ:
 				runLoopMode =
@@ -594,3 +793,21 @@ errToErrorCode(const SSL *SSL_)
 	return nil;
 }
 @end
+
+@implementation OFOpenSSLTLSSession
+- (instancetype)initWithSession: (SSL_SESSION *)session
+{
+	self = [super init];
+
+	_session = session;
+
+	return self;
+}
+
+- (void)dealloc
+{
+	SSL_SESSION_free(_session);
+
+	[super dealloc];
+}
+@end
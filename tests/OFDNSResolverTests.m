@@ -22,9 +22,78 @@
 #import "ObjFW.h"
 #import "ObjFWTest.h"
 
-@interface OFDNSResolverTests: OTTestCase
+#import "OFDNSResolverCache.h"
+
+@interface OFDNSResolverTests: OTTestCase <OFDNSResolverQueryDelegate>
+{
+	size_t _oldCacheSize;
+	OFDNSResponse *_response;
+	id _exception;
+}
 @end
 
+static OFDNSQuery *
+queryWithName(OFString *name)
+{
+	return [OFDNSQuery queryWithDomainName: name
+				      DNSClass: OFDNSClassIN
+				    recordType: OFDNSRecordTypeA];
+}
+
+static OFADNSResourceRecord *
+ARecord(uint32_t TTL)
+{
+	OFSocketAddress address = OFSocketAddressParseIP(@"192.0.2.1", 0);
+
+	return [[[OFADNSResourceRecord alloc] initWithName: @"example.com."
+						   address: &address
+						       TTL: TTL] autorelease];
+}
+
+static OFSOADNSResourceRecord *
+SOARecord(uint32_t TTL, uint32_t minTTL)
+{
+	return [[[OFSOADNSResourceRecord alloc]
+		  initWithName: @"example.com."
+		      DNSClass: OFDNSClassIN
+	     primaryNameServer: @"ns.example.com."
+	     responsiblePerson: @"hostmaster.example.com."
+		  serialNumber: 1
+	       refreshInterval: 3600
+		 retryInterval: 600
+	    expirationInterval: 86400
+			minTTL: minTTL
+			   TTL: TTL] autorelease];
+}
+
+static OFDNSResponse *
+responseWithRecords(OFArray *answerRecords, OFArray *authorityRecords)
+{
+	OFDictionary *empty = [OFDictionary dictionary];
+	OFDictionary *answers = empty, *authority = empty;
+
+	if (answerRecords != nil)
+		answers = [OFDictionary dictionaryWithObject: answerRecords
+						      forKey: @"example.com."];
+	if (authorityRecords != nil)
+		authority = [OFDictionary
+		    dictionaryWithObject: authorityRecords
+				  forKey: @"example.com."];
+
+	return [OFDNSResponse responseWithDomainName: @"example.com."
+				       answerRecords: answers
+				    authorityRecords: authority
+				   additionalRecords: empty];
+}
+
+static OFDNSResolverCacheEntry *
+lookUp(OFDNSResolverCache *cache, OFDNSQuery *query)
+{
+	bool shouldPrefetch;
+
+	return [cache entryForQuery: query shouldPrefetch: &shouldPrefetch];
+}
+
 @implementation OFDNSResolverTests
 + (OFArray OF_GENERIC(OFPair OF_GENERIC(OFString *, id) *) *)summary
 {
@@ -75,4 +144,182 @@
 
 	return summary;
 }
+
+- (void)setUp
+{
+	[super setUp];
+
+	_oldCacheSize = [OFDNSResolver cacheSize];
+}
+
+- (void)tearDown
+{
+	[OFDNSResolver setCacheSize: _oldCacheSize];
+
+	[super tearDown];
+}
+
+- (void)dealloc
+{
+	[_response release];
+	[_exception release];
+
+	[super dealloc];
+}
+
+-  (void)resolver: (OFDNSResolver *)resolver
+  didPerformQuery: (OFDNSQuery *)query
+	 response: (OFDNSResponse *)response
+	exception: (id)exception
+{
+	[_response release];
+	_response = [response retain];
+	[_exception release];
+	_exception = [exception retain];
+
+	[[OFRunLoop mainRunLoop] stop];
+}
+
+- (void)testCacheTTL
+{
+	OFArray *answers = [OFArray arrayWithObjects:
+	    ARecord(600), ARecord(300), nil];
+
+	/* Positive responses use the lowest TTL of all records. */
+	OTAssertEqual(_OFDNSResolverCacheTTL(
+	    responseWithRecords(answers, nil), false), 300);
+	OTAssertEqual(_OFDNSResolverCacheTTL(responseWithRecords(answers,
+	    [OFArray arrayWithObject: SOARecord(100, 3600)]), false), 100);
+	OTAssertEqual(_OFDNSResolverCacheTTL(responseWithRecords(
+	    [OFArray arrayWithObject: ARecord(UINT32_MAX)], nil), false),
+	    604800);
+
+	/* Negative responses use the lower of the SOA TTL and minimum. */
+	OTAssertEqual(_OFDNSResolverCacheTTL(responseWithRecords(nil,
+	    [OFArray arrayWithObject: SOARecord(3600, 60)]), true), 60);
+	OTAssertEqual(_OFDNSResolverCacheTTL(responseWithRecords(nil,
+	    [OFArray arrayWithObject: SOARecord(30, 600)]), false), 30);
+	OTAssertEqual(_OFDNSResolverCacheTTL(responseWithRecords(nil,
+	    [OFArray arrayWithObject: SOARecord(86400, 86400)]), true), 10800);
+
+	/* Negative responses without a SOA record are not cached. */
+	OTAssertEqual(_OFDNSResolverCacheTTL(
+	    responseWithRecords(nil, nil), false), 0);
+	OTAssertEqual(_OFDNSResolverCacheTTL(
+	    responseWithRecords(answers, nil), true), 0);
+}
+
+- (void)testCacheEvictsLeastRecentlyUsed
+{
+	OFDNSResponse *response = responseWithRecords(
+	    [OFArray arrayWithObject: ARecord(300)], nil);
+	OFDNSQuery *a = queryWithName(@"a.example.com.");
+	OFDNSQuery *b = queryWithName(@"b.example.com.");
+	OFDNSQuery *c = queryWithName(@"c.example.com.");
+	OFDNSResolverCache *cache;
+
+	[OFDNSResolver setCacheSize: 2];
+	cache = [OFDNSResolverCache cacheForNameServers:
+	    [OFArray arrayWithObject: @"192.0.2.1"]];
+
+	[cache addResponse: response nameError: false forQuery: a];
+	[cache addResponse: response nameError: false forQuery: b];
+
+	/* Makes b the least recently used entry. */
+	OTAssertNotNil(lookUp(cache, a));
+
+	[cache addResponse: response nameError: false forQuery: c];
+
+	OTAssertNil(lookUp(cache, b));
+	OTAssertNotNil(lookUp(cache, a));
+	OTAssertNotNil(lookUp(cache, c));
+	OTAssertEqual(cache.numberOfHits, 3);
+	OTAssertEqual(cache.numberOfMisses, 1);
+}
+
+- (void)testCacheNegativeResponses
+{
+	OFDNSResponse *positive = responseWithRecords(
+	    [OFArray arrayWithObject: ARecord(300)], nil);
+	OFDNSResponse *negative = responseWithRecords(nil,
+	    [OFArray arrayWithObject: SOARecord(3600, 60)]);
+	OFDNSResponse *negativeWithoutSOA = responseWithRecords(nil, nil);
+	OFDNSQuery *query = queryWithName(@"example.com.");
+	OFDNSResolverCache *cache;
+
+	cache = [OFDNSResolverCache cacheForNameServers:
+	    [OFArray arrayWithObject: @"192.0.2.2"]];
+
+	[cache addResponse: negative nameError: true forQuery: query];
+	OTAssertNotNil(lookUp(cache, query));
+
+	/* A response that can't be cached replaces the old entry. */
+	[cache addResponse: positive nameError: false forQuery: query];
+	[cache addResponse: negativeWithoutSOA nameError: true forQuery: query];
+	OTAssertNil(lookUp(cache, query));
+}
+
+- (void)testSetCacheSizeTrimsCaches
+{
+	OFDNSResponse *response = responseWithRecords(
+	    [OFArray arrayWithObject: ARecord(300)], nil);
+	OFDNSQuery *a = queryWithName(@"a.example.com.");
+	OFDNSQuery *b = queryWithName(@"b.example.com.");
+	OFDNSResolverCache *cache;
+
+	[OFDNSResolver setCacheSize: 2];
+	cache = [OFDNSResolverCache cacheForNameServers:
+	    [OFArray arrayWithObject: @"192.0.2.3"]];
+
+	[cache addResponse: response nameError: false forQuery: a];
+	[cache addResponse: response nameError: false forQuery: b];
+
+	[OFDNSResolver setCacheSize: 1];
+	OTAssertEqual([OFDNSResolver cacheSize], 1);
+	OTAssertNil(lookUp(cache, a));
+	OTAssertNotNil(lookUp(cache, b));
+
+	[OFDNSResolver setCacheSize: 0];
+	OTAssertNil(lookUp(cache, b));
+	[cache addResponse: response nameError: false forQuery: a];
+	OTAssertNil(lookUp(cache, a));
+}
+
+- (void)testCachedResponsesAreReplayed
+{
+	OFDNSResolver *resolver = [OFDNSResolver resolver];
+	OFArray *nameServers = [OFArray arrayWithObject: @"192.0.2.4"];
+	OFDNSResolverCache *cache =
+	    [OFDNSResolverCache cacheForNameServers: nameServers];
+	OFDNSQuery *existing = queryWithName(@"example.com.");
+	OFDNSQuery *nonexistent = queryWithName(@"nonexistent.example.com.");
+	OFDNSResponse *response = responseWithRecords(
+	    [OFArray arrayWithObject: ARecord(300)], nil);
+
+	resolver.nameServers = nameServers;
+
+	[cache addResponse: response nameError: false forQuery: existing];
+	[cache addResponse: responseWithRecords(nil,
+				[OFArray arrayWithObject: SOARecord(3600, 60)])
+		 nameError: true
+		  forQuery: nonexistent];
+
+	[resolver asyncPerformQuery: existing delegate: self];
+	[[OFRunLoop mainRunLoop] runUntilDate:
+	    [OFDate dateWithTimeIntervalSinceNow: 2]];
+
+	OTAssertEqual(_response, response);
+	OTAssertNil(_exception);
+
+	[resolver asyncPerformQuery: nonexistent delegate: self];
+	[[OFRunLoop mainRunLoop] runUntilDate:
+	    [OFDate dateWithTimeIntervalSinceNow: 2]];
+
+	OTAssertNil(_response);
+	OTAssertTrue([_exception isKindOfClass:
+	    [OFDNSQueryFailedException class]]);
+	OTAssertEqual(((OFDNSQueryFailedException *)_exception).errorCode,
+	    OFDNSResolverErrorCodeServerNameError);
+	OTAssertEqual(resolver.numberOfCacheHits, 2);
+}
 @end
@@ -280,6 +280,86 @@
 	    @"e72bfa007c2f76a823d10204d47d2e2d");
 }
 
+- (void)testDigestsOfDataInArray
+{
+	static const uint8_t SHA256Digest[] =
+	    "\x27\xC5\x21\x85\x9F\x6F\x5B\x10\xAE\xAC\x4E\x21\x0A\x6D\x00\x5C"
+	    "\x85\xE3\x82\xC5\x94\xE2\x62\x2A\xF9\xC4\x6C\x6D\xA8\x90\x68\x21";
+	static const uint8_t emptySHA256Digest[] =
+	    "\xE3\xB0\xC4\x42\x98\xFC\x1C\x14\x9A\xFB\xF4\xC8\x99\x6F\xB9\x24"
+	    "\x27\xAE\x41\xE4\x64\x9B\x93\x4C\xA4\x95\x99\x1B\x78\x52\xB8\x55";
+	OFData *digests = [OFData
+	    digestsOfDataInArray: [OFArray arrayWithObjects:
+				      _data, [OFData data], _data, nil]
+		       hashClass: [OFSHA256Hash class]];
+
+	OTAssertEqual(digests.count, 3);
+	OTAssertEqual(digests.itemSize, 32);
+	OTAssertEqual(memcmp([digests itemAtIndex: 0], SHA256Digest, 32), 0);
+	OTAssertEqual(memcmp([digests itemAtIndex: 1], emptySHA256Digest, 32),
+	    0);
+	OTAssertEqual(memcmp([digests itemAtIndex: 2], SHA256Digest, 32), 0);
+}
+
+- (void)testDigestsOfManyDataInArrayWithHashClass: (Class)hashClass
+{
+	/* Lengths around the block size, for more data than hashed at once. */
+	static const size_t lengths[] = {
+		0, 1, 55, 56, 63, 64, 65, 119, 120, 128, 200, 3, 290
+	};
+	OFMutableArray *array = [OFMutableArray array];
+	uint8_t buffer[290];
+	OFData *digests;
+
+	for (size_t i = 0; i < sizeof(buffer); i++)
+		buffer[i] = (uint8_t)(i * 17);
+
+	for (size_t i = 0; i < 2; i++)
+		for (size_t j = 0; j < sizeof(lengths) / sizeof(*lengths); j++)
+			[array addObject: [OFData dataWithItems: buffer + i
+							  count: lengths[j]]];
+
+	digests = [OFData digestsOfDataInArray: array hashClass: hashClass];
+	OTAssertEqual(digests.count, array.count);
+
+	for (size_t i = 0; i < array.count; i++) {
+		OFData *data = [array objectAtIndex: i];
+		id <OFCryptographicHash> hash =
+		    [hashClass hashWithAllowsSwappableMemory: true];
+
+		[hash updateWithBuffer: data.items length: data.count];
+		[hash calculate];
+
+		OTAssertEqual(memcmp([digests itemAtIndex: i], hash.digest,
+		    hash.digestSize), 0);
+	}
+}
+
+- (void)testDigestsOfManyDataInArrayWithMD5
+{
+	[self testDigestsOfManyDataInArrayWithHashClass: [OFMD5Hash class]];
+}
+
+- (void)testDigestsOfManyDataInArrayWithSHA1
+{
+	[self testDigestsOfManyDataInArrayWithHashClass: [OFSHA1Hash class]];
+}
+
+- (void)testDigestsOfManyDataInArrayWithSHA224
+{
+	[self testDigestsOfManyDataInArrayWithHashClass: [OFSHA224Hash class]];
+}
+
+- (void)testDigestsOfManyDataInArrayWithSHA256
+{
+	[self testDigestsOfManyDataInArrayWithHashClass: [OFSHA256Hash class]];
+}
+
+- (void)testDigestsOfManyDataInArrayWithSHA512
+{
+	[self testDigestsOfManyDataInArrayWithHashClass: [OFSHA512Hash class]];
+}
+
 - (void)testStringByBase64Encoding
 {
 	OTAssertEqualObjects([[self.dataClass dataWithItems: "abcde" count: 5]
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#import "ObjFW.h"
+#import "ObjFWTest.h"
+
+@interface OFGZIPStreamTests: OTTestCase
+@end
+
+/* "Hello BGZF World!\n" split into four BGZF blocks plus the EOF block. */
+static const uint8_t BGZFData[] = {
+	0x1F, 0x8B, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0xFF, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+	0x21, 0x00, 0xF3, 0x48, 0xCD, 0xC9, 0xC9, 0x57,
+	0x00, 0x00, 0xC0, 0xFC, 0x2D, 0xEA, 0x06, 0x00,
+	0x00, 0x00, 0x1F, 0x8B, 0x08, 0x04, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0xFF, 0x06, 0x00, 0x42, 0x43,
+	0x02, 0x00, 0x20, 0x00, 0x73, 0x72, 0x8F, 0x72,
+	0x53, 0x00, 0x00, 0x9D, 0xFF, 0xB4, 0x1E, 0x05,
+	0x00, 0x00, 0x00, 0x1F, 0x8B, 0x08, 0x04, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xFF, 0x06, 0x00, 0x42,
+	0x43, 0x02, 0x00, 0x20, 0x00, 0x0B, 0xCF, 0x2F,
+	0xCA, 0x49, 0x01, 0x00, 0x47, 0x3E, 0xB6, 0xFB,
+	0x05, 0x00, 0x00, 0x00, 0x1F, 0x8B, 0x08, 0x04,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x06, 0x00,
+	0x42, 0x43, 0x02, 0x00, 0x1D, 0x00, 0x53, 0xE4,
+	0x02, 0x00, 0x02, 0xEE, 0x93, 0x2D, 0x02, 0x00,
+	0x00, 0x00, 0x1F, 0x8B, 0x08, 0x04, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0xFF, 0x06, 0x00, 0x42, 0x43,
+	0x02, 0x00, 0x1B, 0x00, 0x03, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+/* "Hello GZIP World!\n" as a GZIP member without the BGZF extra field. */
+static const uint8_t GZIPData[] = {
+	0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0xFF, 0xF3, 0x48, 0xCD, 0xC9, 0xC9, 0x57,
+	0x70, 0x8F, 0xF2, 0x0C, 0x50, 0x08, 0xCF, 0x2F,
+	0xCA, 0x49, 0x51, 0xE4, 0x02, 0x00, 0xF7, 0xB2,
+	0xD4, 0x44, 0x12, 0x00, 0x00, 0x00
+};
+
+@implementation OFGZIPStreamTests
+- (void)readBGZFWithThreads: (size_t)numberOfThreads
+{
+	OFMemoryStream *stream = [OFMemoryStream
+	    streamWithMemoryAddress: (uint8_t *)BGZFData
+			       size: sizeof(BGZFData)
+			   writable: false];
+	OFGZIPStream *GZIPStream = [OFGZIPStream streamWithStream: stream
+							     mode: @"r"];
+
+	GZIPStream.numberOfThreads = numberOfThreads;
+
+	OTAssertEqualObjects([GZIPStream readLine], @"Hello BGZF World!");
+	OTAssertNil([GZIPStream readLine]);
+	OTAssertTrue(GZIPStream.atEndOfStream);
+}
+
+- (void)testBGZF
+{
+	[self readBGZFWithThreads: 1];
+}
+
+- (void)testBGZFInParallel
+{
+	[self readBGZFWithThreads: 3];
+}
+
+- (void)testNonBGZFWithThreads
+{
+	OFMemoryStream *stream = [OFMemoryStream
+	    streamWithMemoryAddress: (uint8_t *)GZIPData
+			       size: sizeof(GZIPData)
+			   writable: false];
+	OFGZIPStream *GZIPStream = [OFGZIPStream streamWithStream: stream
+							     mode: @"r"];
+
+	GZIPStream.numberOfThreads = 3;
+
+	OTAssertEqualObjects([GZIPStream readLine], @"Hello GZIP World!");
+	OTAssertNil([GZIPStream readLine]);
+	OTAssertTrue(GZIPStream.atEndOfStream);
+}
+@end
@@ -106,6 +106,61 @@ static const uint8_t SHA512Digest[] =
 	OTAssertEqual(memcmp(HMAC.digest, expectedDigest, HMAC.digestSize), 0);
 }
 
+- (void)testDigestsOfDataInArrayWithHashClass: (Class)hashClass
+{
+	OFHMAC *HMAC = [OFHMAC HMACWithHashClass: hashClass
+			   allowsSwappableMemory: true];
+	OFMutableArray *array = [OFMutableArray array];
+	char buffer[200];
+	OFData *digests;
+
+	OTAssertThrowsSpecific([HMAC digestsOfDataInArray: array],
+	    OFInvalidArgumentException);
+
+	[HMAC setKey: key length: keyLength];
+
+	for (size_t i = 0; i < 10; i++) {
+		memset(buffer, 'a' + i, sizeof(buffer));
+		[array addObject: [OFData dataWithItems: buffer
+						  count: i * 20]];
+	}
+
+	digests = [HMAC digestsOfDataInArray: array];
+	OTAssertEqual(digests.count, array.count);
+	OTAssertEqual(digests.itemSize, HMAC.digestSize);
+
+	for (size_t i = 0; i < array.count; i++) {
+		OFData *data = [array objectAtIndex: i];
+
+		[HMAC reset];
+		[HMAC updateWithBuffer: data.items length: data.count];
+		[HMAC calculate];
+
+		OTAssertEqual(memcmp([digests itemAtIndex: i], HMAC.digest,
+		    HMAC.digestSize), 0);
+	}
+}
+
+- (void)testDigestsOfDataInArrayWithMD5
+{
+	[self testDigestsOfDataInArrayWithHashClass: [OFMD5Hash class]];
+}
+
+- (void)testDigestsOfDataInArrayWithSHA1
+{
+	[self testDigestsOfDataInArrayWithHashClass: [OFSHA1Hash class]];
+}
+
+- (void)testDigestsOfDataInArrayWithSHA256
+{
+	[self testDigestsOfDataInArrayWithHashClass: [OFSHA256Hash class]];
+}
+
+- (void)testDigestsOfDataInArrayWithSHA512
+{
+	[self testDigestsOfDataInArrayWithHashClass: [OFSHA512Hash class]];
+}
+
 - (void)testHMACWithMD5
 {
 	[self testWithHashClass: [OFMD5Hash class] expectedDigest: MD5Digest];
@@ -28,6 +28,7 @@
 @interface OFHTTPClientTests: OTTestCase <OFHTTPClientDelegate>
 {
 	OFHTTPResponse *_response;
+	size_t _numberOfTCPSockets;
 }
 @end
 
@@ -41,6 +42,12 @@
 @property (readonly) uint16_t port;
 @end
 
+@interface HTTPClientTestsKeepAliveServer: HTTPClientTestsServer
+@end
+
+@interface HTTPClientTestsIdleConnectionServer: HTTPClientTestsServer
+@end
+
 @implementation OFHTTPClientTests
 - (void)dealloc
 {
@@ -56,6 +63,13 @@
 	[body writeString: @"Hello"];
 }
 
+-	(void)client: (OFHTTPClient *)client
+  didCreateTCPSocket: (OFTCPSocket *)TCPSocket
+	     request: (OFHTTPRequest *)request
+{
+	_numberOfTCPSockets++;
+}
+
 -      (void)client: (OFHTTPClient *)client
   didPerformRequest: (OFHTTPRequest *)request
 	   response: (OFHTTPResponse *)response_
@@ -113,6 +127,104 @@
 
 	OTAssertNil([server join]);
 }
+
+- (OFData *)performRequestWithPath: (OFString *)path
+			    client: (OFHTTPClient *)client
+			      port: (uint16_t)port
+{
+	OFIRI *IRI = [OFIRI IRIWithString:
+	    [OFString stringWithFormat: @"http://127.0.0.1:%" @PRIu16 "%@",
+					port, path]];
+
+	[_response release];
+	_response = nil;
+
+	[client asyncPerformRequest: [OFHTTPRequest requestWithIRI: IRI]];
+	[[OFRunLoop mainRunLoop] runUntilDate:
+	    [OFDate dateWithTimeIntervalSinceNow: 2]];
+
+	return [_response readDataUntilEndOfStream];
+}
+
+- (void)testKeepAlive
+{
+	HTTPClientTestsKeepAliveServer *server;
+	OFHTTPClient *client;
+
+	server = [[[HTTPClientTestsKeepAliveServer alloc] init] autorelease];
+	server.supportsSockets = true;
+
+	[server.condition lock];
+
+	[server start];
+
+	[server.condition wait];
+	[server.condition unlock];
+
+	client = [OFHTTPClient client];
+	client.delegate = self;
+
+	/* The second request must reuse the connection of the first. */
+	OTAssertEqualObjects([self performRequestWithPath: @"/1"
+						   client: client
+						     port: server.port],
+	    [OFData dataWithItems: "one" count: 3]);
+	OTAssertEqualObjects([self performRequestWithPath: @"/2"
+						   client: client
+						     port: server.port],
+	    [OFData dataWithItems: "two" count: 3]);
+	OTAssertEqual(_numberOfTCPSockets, 1);
+
+	/*
+	 * The second response had "Connection: close", so the connection must
+	 * not be reused, even though the server did not close it yet.
+	 */
+	OTAssertEqualObjects([self performRequestWithPath: @"/3"
+						   client: client
+						     port: server.port],
+	    [OFData dataWithItems: "three" count: 5]);
+	OTAssertEqual(_numberOfTCPSockets, 2);
+
+	[client close];
+
+	OTAssertNil([server join]);
+}
+
+- (void)testDeallocClosesIdleConnections
+{
+	HTTPClientTestsIdleConnectionServer *server;
+	void *pool;
+	OFHTTPClient *client;
+
+	server = [[[HTTPClientTestsIdleConnectionServer alloc] init]
+	    autorelease];
+	server.supportsSockets = true;
+
+	[server.condition lock];
+
+	[server start];
+
+	[server.condition wait];
+	[server.condition unlock];
+
+	pool = objc_autoreleasePoolPush();
+
+	client = [OFHTTPClient client];
+	client.delegate = self;
+
+	OTAssertEqualObjects([self performRequestWithPath: @"/1"
+						   client: client
+						     port: server.port],
+	    [OFData dataWithItems: "one" count: 3]);
+
+	[_response release];
+	_response = nil;
+
+	/* Neither the response nor the idle timer may keep the client. */
+	objc_autoreleasePoolPop(pool);
+
+	OTAssertNil([server join]);
+}
 @end
 
 @implementation HTTPClientTestsServer
@@ -203,3 +315,106 @@
 	return nil;
 }
 @end
+
+static OFString *
+readRequest(OFTCPSocket *client)
+{
+	OFString *line = [client readLine];
+	OFString *path;
+
+	if (![line hasPrefix: @"GET "] || ![line hasSuffix: @" HTTP/1.1"])
+		return nil;
+
+	path = [line substringWithRange: OFMakeRange(4, line.length - 13)];
+
+	while ((line = [client readLine]) != nil)
+		if (line.length == 0)
+			return path;
+
+	return nil;
+}
+
+@implementation HTTPClientTestsKeepAliveServer
+- (id)main
+{
+	OFTCPSocket *listener, *first, *second;
+	OFSocketAddress address;
+
+	[_condition lock];
+
+	listener = [OFTCPSocket socket];
+	address = [listener bindToHost: @"127.0.0.1" port: 0];
+	_port = OFSocketAddressIPPort(&address);
+	[listener listen];
+
+	[_condition signal];
+	[_condition unlock];
+
+	first = [listener accept];
+
+	if (![readRequest(first) isEqual: @"/1"])
+		return @"Wrong first request";
+	[first writeString: @"HTTP/1.1 200 OK\r\n"
+			    @"Content-Length: 3\r\n"
+			    @"\r\n"
+			    @"one"];
+
+	if (![readRequest(first) isEqual: @"/2"])
+		return @"Connection not reused";
+	[first writeString: @"HTTP/1.1 200 OK\r\n"
+			    @"Connection: close\r\n"
+			    @"Content-Length: 3\r\n"
+			    @"\r\n"
+			    @"two"];
+
+	second = [listener accept];
+
+	if (![readRequest(second) isEqual: @"/3"])
+		return @"Wrong third request";
+	[second writeString: @"HTTP/1.1 200 OK\r\n"
+			     @"Connection: close\r\n"
+			     @"Content-Length: 5\r\n"
+			     @"\r\n"
+			     @"three"];
+
+	[first close];
+	[second close];
+
+	return nil;
+}
+@end
+
+@implementation HTTPClientTestsIdleConnectionServer
+- (id)main
+{
+	OFTCPSocket *listener, *client;
+	OFSocketAddress address;
+
+	[_condition lock];
+
+	listener = [OFTCPSocket socket];
+	address = [listener bindToHost: @"127.0.0.1" port: 0];
+	_port = OFSocketAddressIPPort(&address);
+	[listener listen];
+
+	[_condition signal];
+	[_condition unlock];
+
+	client = [listener accept];
+
+	if (![readRequest(client) isEqual: @"/1"])
+		return @"Wrong request";
+	[client writeString: @"HTTP/1.1 200 OK\r\n"
+			     @"Content-Length: 3\r\n"
+			     @"\r\n"
+			     @"one"];
+
+	/* Deallocating the client needs to close the idle connection. */
+	if ([client readLine] != nil)
+		return @"Unexpected data";
+
+	[client close];
+
+	return nil;
+}
+@end
@@ -0,0 +1,565 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#import "ObjFW.h"
+#import "ObjFWTest.h"
+
+@interface HTTPServerTestsThread: OFThread <OFHTTPServerDelegate>
+{
+	OFCondition *_condition;
+	OFHTTPServer *_server;
+	uint16_t _port;
+	size_t _numberOfRequests;
+}
+
+@property (readonly, nonatomic) OFCondition *condition;
+@property (readonly, nonatomic) OFHTTPServer *server;
+@property (readonly) uint16_t port;
+@end
+
+@interface OFHTTPServerTests: OTTestCase
+{
+	HTTPServerTestsThread *_serverThread;
+}
+@end
+
+static OFString *
+readResponse(OFTCPSocket *sock, OFMutableDictionary *headers, OFString **body)
+{
+	OFString *status = [sock readLine];
+	OFString *line, *contentLength;
+
+	while ((line = [sock readLine]) != nil && line.length > 0) {
+		size_t pos = [line rangeOfString: @": "].location;
+
+		[headers setObject: [line substringFromIndex: pos + 2]
+			    forKey: [line substringToIndex: pos]];
+	}
+
+	*body = nil;
+	if ((contentLength = [headers objectForKey: @"Content-Length"]) !=
+	    nil) {
+		size_t length = (size_t)contentLength.unsignedLongLongValue;
+		char *buffer = OFAllocMemory(length, 1);
+
+		@try {
+			[sock readIntoBuffer: buffer exactLength: length];
+			*body = [OFString stringWithUTF8String: buffer
+							length: length];
+		} @finally {
+			OFFreeMemory(buffer);
+		}
+	}
+
+	return status;
+}
+
+@implementation OFHTTPServerTests
+- (void)setUp
+{
+	[super setUp];
+
+	_serverThread = [[HTTPServerTestsThread alloc] init];
+	_serverThread.supportsSockets = true;
+
+	[_serverThread.condition lock];
+
+	[_serverThread start];
+
+	[_serverThread.condition wait];
+	[_serverThread.condition unlock];
+}
+
+- (void)tearDown
+{
+	[_serverThread.runLoop stop];
+	OTAssertNil([_serverThread join]);
+
+	[super tearDown];
+}
+
+- (void)dealloc
+{
+	[_serverThread release];
+
+	[super dealloc];
+}
+
+- (OFTCPSocket *)connect
+{
+	OFTCPSocket *sock = [OFTCPSocket socket];
+
+	[sock connectToHost: @"127.0.0.1" port: _serverThread.port];
+
+	return sock;
+}
+
+- (OFString *)hostHeader
+{
+	return [OFString stringWithFormat: @"Host: 127.0.0.1:%" @PRIu16 "\r\n",
+					   _serverThread.port];
+}
+
+- (OFIRI *)IRIForPath: (OFString *)path
+{
+	return [OFIRI IRIWithString: [OFString stringWithFormat:
+	    @"http://127.0.0.1:%" @PRIu16 "%@", _serverThread.port, path]];
+}
+
+- (OFString *)requestPath: (OFString *)path
+	     extraHeaders: (OFString *)extraHeaders
+		  headers: (OFMutableDictionary *)headers
+		     body: (OFString **)body
+{
+	OFTCPSocket *sock = [self connect];
+
+	[sock writeFormat: @"GET %@ HTTP/1.1\r\n", path];
+	[sock writeString: [self hostHeader]];
+	[sock writeString: extraHeaders];
+	[sock writeString: @"Connection: close\r\n"
+			   @"\r\n"];
+
+	return readResponse(sock, headers, body);
+}
+
+- (OFString *)requestPath: (OFString *)path
+		  headers: (OFMutableDictionary *)headers
+		     body: (OFString **)body
+{
+	return [self requestPath: path
+		    extraHeaders: @""
+			 headers: headers
+			    body: body];
+}
+
+- (void)testHeaderNameNormalization
+{
+	OFTCPSocket *sock = [self connect];
+	OFMutableDictionary *headers = [OFMutableDictionary dictionary];
+	OFString *body;
+
+	[sock writeString: @"GET / HTTP/1.1\r\n"];
+	[sock writeString: [self hostHeader]];
+	[sock writeString: @"content-TYPE: text/plain\r\n"
+			   @"x-custom_header: foo\r\n"
+			   @"X-2nd-HEADER: bar\r\n"
+			   @"\r\n"];
+
+	OTAssertEqualObjects(readResponse(sock, headers, &body),
+	    @"HTTP/1.1 200 OK");
+	OTAssertTrue([body containsString: @"\nContent-Type: text/plain\n"]);
+	OTAssertTrue([body containsString: @"\nX-Custom_Header: foo\n"]);
+	OTAssertTrue([body containsString: @"\nX-2Nd-Header: bar\n"]);
+}
+
+- (void)testUnknownMethod
+{
+	OFTCPSocket *sock = [self connect];
+	OFMutableDictionary *headers = [OFMutableDictionary dictionary];
+	OFString *body;
+
+	[sock writeString: @"FOO / HTTP/1.1\r\n"];
+	[sock writeString: [self hostHeader]];
+	[sock writeString: @"\r\n"];
+
+	OTAssertEqualObjects(readResponse(sock, headers, &body),
+	    @"HTTP/1.1 405 Method Not Allowed");
+	OTAssertEqualObjects([headers objectForKey: @"Server"], @"ObjFW-Tests");
+}
+
+- (void)testFoldedHeaderIsRejected
+{
+	OFTCPSocket *sock = [self connect];
+	OFMutableDictionary *headers = [OFMutableDictionary dictionary];
+	OFString *body;
+
+	[sock writeString: @"GET / HTTP/1.1\r\n"];
+	[sock writeString: [self hostHeader]];
+	[sock writeString: @"X-Folded: foo\r\n"
+			   @" bar\r\n"
+			   @"\r\n"];
+
+	OTAssertEqualObjects(readResponse(sock, headers, &body),
+	    @"HTTP/1.1 400 Bad Request");
+}
+
+- (void)testDuplicateHeadersAreJoined
+{
+	OFTCPSocket *sock = [self connect];
+	OFMutableDictionary *headers = [OFMutableDictionary dictionary];
+	OFString *body;
+
+	[sock writeString: @"GET / HTTP/1.1\r\n"];
+	[sock writeString: [self hostHeader]];
+	[sock writeString: @"X-Duplicate: foo\r\n"
+			   @"x-duplicate: bar\r\n"
+			   @"\r\n"];
+
+	OTAssertEqualObjects(readResponse(sock, headers, &body),
+	    @"HTTP/1.1 200 OK");
+	OTAssertTrue([body containsString: @"\nX-Duplicate: foo,bar\n"]);
+}
+
+- (void)testKeepAlive
+{
+	OFTCPSocket *sock = [self connect];
+	OFMutableDictionary *headers = [OFMutableDictionary dictionary];
+	OFString *body;
+
+	[sock writeString: @"GET /1 HTTP/1.1\r\n"];
+	[sock writeString: [self hostHeader]];
+	[sock writeString: @"\r\n"];
+
+	OTAssertEqualObjects(readResponse(sock, headers, &body),
+	    @"HTTP/1.1 200 OK");
+	OTAssertEqualObjects([headers objectForKey: @"X-Requests"], @"1");
+	OTAssertNil([headers objectForKey: @"Connection"]);
+
+	/* The second request must be served on the same connection. */
+	[headers removeAllObjects];
+	[sock writeString: @"GET /2 HTTP/1.1\r\n"];
+	[sock writeString: [self hostHeader]];
+	[sock writeString: @"Connection: close\r\n"
+			   @"\r\n"];
+
+	OTAssertEqualObjects(readResponse(sock, headers, &body),
+	    @"HTTP/1.1 200 OK");
+	OTAssertEqualObjects([headers objectForKey: @"X-Requests"], @"2");
+	OTAssertEqualObjects([headers objectForKey: @"Connection"], @"close");
+}
+
+- (void)testCachedResponse
+{
+	OFHTTPServer *server = _serverThread.server;
+	OFMutableDictionary *headers = [OFMutableDictionary dictionary];
+	OFDictionary *cachedHeaders = [OFDictionary
+	    dictionaryWithObject: @"no-cache"
+			  forKey: @"Cache-Control"];
+	OFString *body;
+
+	server.responseCacheSize = 4096;
+	[server cacheResponseWithStatusCode: 200
+				    headers: cachedHeaders
+				       body: [OFData dataWithItems: "cached"
+							     count: 6]
+				     forIRI: [self IRIForPath: @"/cached"]];
+
+	OTAssertEqualObjects([self requestPath: @"/cached"
+				       headers: headers
+					  body: &body],
+	    @"HTTP/1.1 200 OK");
+	OTAssertEqualObjects(body, @"cached");
+	OTAssertNil([headers objectForKey: @"X-Requests"]);
+	OTAssertEqualObjects([headers objectForKey: @"Cache-Control"],
+	    @"no-cache");
+	OTAssertEqualObjects([headers objectForKey: @"Vary"],
+	    @"Accept-Encoding");
+	OTAssertEqualObjects([headers objectForKey: @"Server"], @"ObjFW-Tests");
+	OTAssertEqualObjects([headers objectForKey: @"Connection"], @"close");
+	OTAssertNotNil([headers objectForKey: @"ETag"]);
+	OTAssertNotNil([headers objectForKey: @"Date"]);
+}
+
+- (void)testCachedResponseUsesRequestProtocolVersion
+{
+	OFHTTPServer *server = _serverThread.server;
+	OFTCPSocket *sock = [self connect];
+	OFMutableDictionary *headers = [OFMutableDictionary dictionary];
+	OFString *body;
+
+	server.responseCacheSize = 4096;
+	[server cacheResponseWithStatusCode: 200
+				    headers: nil
+				       body: [OFData dataWithItems: "cached"
+							     count: 6]
+				     forIRI: [self IRIForPath: @"/cached"]];
+
+	[sock writeString: @"GET /cached HTTP/1.0\r\n"];
+	[sock writeString: [self hostHeader]];
+	[sock writeString: @"\r\n"];
+
+	OTAssertEqualObjects(readResponse(sock, headers, &body),
+	    @"HTTP/1.0 200 OK");
+	OTAssertEqualObjects(body, @"cached");
+	OTAssertNil([headers objectForKey: @"Connection"]);
+}
+
+- (void)testCachedResponseNotModified
+{
+	OFHTTPServer *server = _serverThread.server;
+	OFMutableDictionary *headers = [OFMutableDictionary dictionary];
+	OFDictionary *cachedHeaders = [OFDictionary
+	    dictionaryWithKeysAndObjects:
+	    @"ETag", @"\"foo\"",
+	    @"Cache-Control", @"max-age=60",
+	    @"Vary", @"Cookie",
+	    @"Content-Type", @"text/plain", nil];
+	OFString *body;
+
+	server.responseCacheSize = 4096;
+	[server cacheResponseWithStatusCode: 200
+				    headers: cachedHeaders
+				       body: [OFData dataWithItems: "cached"
+							     count: 6]
+				     forIRI: [self IRIForPath: @"/cached"]];
+
+	OTAssertEqualObjects([self requestPath: @"/cached"
+				  extraHeaders: @"If-None-Match: \"bar\", "
+						@"W/\"foo\"\r\n"
+				       headers: headers
+					  body: &body],
+	    @"HTTP/1.1 304 Not Modified");
+	OTAssertNil(body);
+	OTAssertEqualObjects([headers objectForKey: @"ETag"], @"\"foo\"");
+	OTAssertEqualObjects([headers objectForKey: @"Cache-Control"],
+	    @"max-age=60");
+	OTAssertEqualObjects([headers objectForKey: @"Vary"],
+	    @"Cookie, Accept-Encoding");
+	OTAssertEqualObjects([headers objectForKey: @"Server"], @"ObjFW-Tests");
+	OTAssertNotNil([headers objectForKey: @"Date"]);
+	OTAssertNil([headers objectForKey: @"Content-Type"]);
+
+	[headers removeAllObjects];
+	OTAssertEqualObjects([self requestPath: @"/cached"
+				  extraHeaders: @"If-None-Match: \"bar\"\r\n"
+				       headers: headers
+					  body: &body],
+	    @"HTTP/1.1 200 OK");
+	OTAssertEqualObjects(body, @"cached");
+}
+
+- (void)testCachedResponseEncodings
+{
+	OFHTTPServer *server = _serverThread.server;
+	OFMutableDictionary *headers = [OFMutableDictionary dictionary];
+	OFDictionary *gzipHeaders = [OFDictionary
+	    dictionaryWithObject: @"gzip"
+			  forKey: @"Content-Encoding"];
+	OFIRI *IRI = [self IRIForPath: @"/encoded"];
+	OFString *body;
+
+	server.responseCacheSize = 4096;
+	[server cacheResponseWithStatusCode: 200
+				    headers: nil
+				       body: [OFData dataWithItems: "identity"
+							     count: 8]
+				     forIRI: IRI];
+	[server cacheResponseWithStatusCode: 200
+				    headers: gzipHeaders
+				       body: [OFData dataWithItems: "gzip"
+							     count: 4]
+				     forIRI: IRI];
+
+	OTAssertEqualObjects([self requestPath: @"/encoded"
+				  extraHeaders: @"Accept-Encoding: br, GZIP\r\n"
+				       headers: headers
+					  body: &body],
+	    @"HTTP/1.1 200 OK");
+	OTAssertEqualObjects(body, @"gzip");
+	OTAssertEqualObjects([headers objectForKey: @"Content-Encoding"],
+	    @"gzip");
+	OTAssertEqualObjects([headers objectForKey: @"Vary"],
+	    @"Accept-Encoding");
+
+	[headers removeAllObjects];
+	OTAssertEqualObjects([self requestPath: @"/encoded"
+				  extraHeaders: @"Accept-Encoding: gzip;q=0\r\n"
+				       headers: headers
+					  body: &body],
+	    @"HTTP/1.1 200 OK");
+	OTAssertEqualObjects(body, @"identity");
+	OTAssertNil([headers objectForKey: @"Content-Encoding"]);
+	OTAssertEqualObjects([headers objectForKey: @"Vary"],
+	    @"Accept-Encoding");
+
+	[headers removeAllObjects];
+	OTAssertEqualObjects([self requestPath: @"/encoded"
+				       headers: headers
+					  body: &body],
+	    @"HTTP/1.1 200 OK");
+	OTAssertEqualObjects(body, @"identity");
+}
+
+- (void)testCacheEviction
+{
+	OFHTTPServer *server = _serverThread.server;
+	OFMutableDictionary *headers = [OFMutableDictionary dictionary];
+	char buffer[1000];
+	OFData *data;
+	OFString *body;
+
+	memset(buffer, 'x', sizeof(buffer));
+	data = [OFData dataWithItems: buffer count: sizeof(buffer)];
+
+	/* Each response uses about 1200 bytes. */
+	server.responseCacheSize = 2500;
+	[server cacheResponseWithStatusCode: 200
+				    headers: nil
+				       body: data
+				     forIRI: [self IRIForPath: @"/a"]];
+	[server cacheResponseWithStatusCode: 200
+				    headers: nil
+				       body: data
+				     forIRI: [self IRIForPath: @"/b"]];
+
+	/* Makes /b the least recently used response. */
+	OTAssertEqualObjects([self requestPath: @"/a"
+				       headers: headers
+					  body: &body],
+	    @"HTTP/1.1 200 OK");
+	OTAssertNil([headers objectForKey: @"X-Requests"]);
+
+	[server cacheResponseWithStatusCode: 200
+				    headers: nil
+				       body: data
+				     forIRI: [self IRIForPath: @"/c"]];
+
+	[headers removeAllObjects];
+	[self requestPath: @"/b" headers: headers body: &body];
+	OTAssertEqualObjects([headers objectForKey: @"X-Requests"], @"1");
+
+	[headers removeAllObjects];
+	[self requestPath: @"/a" headers: headers body: &body];
+	OTAssertNil([headers objectForKey: @"X-Requests"]);
+	OTAssertEqual(body.length, sizeof(buffer));
+
+	[headers removeAllObjects];
+	[self requestPath: @"/c" headers: headers body: &body];
+	OTAssertNil([headers objectForKey: @"X-Requests"]);
+	OTAssertEqual(body.length, sizeof(buffer));
+}
+
+- (void)testRemoveCachedResponses
+{
+	OFHTTPServer *server = _serverThread.server;
+	OFMutableDictionary *headers = [OFMutableDictionary dictionary];
+	OFDictionary *gzipHeaders = [OFDictionary
+	    dictionaryWithObject: @"gzip"
+			  forKey: @"Content-Encoding"];
+	OFIRI *IRI = [self IRIForPath: @"/removed"];
+	OFString *body;
+
+	server.responseCacheSize = 4096;
+	[server cacheResponseWithStatusCode: 200
+				    headers: nil
+				       body: [OFData dataWithItems: "cached"
+							     count: 6]
+				     forIRI: IRI];
+	[server cacheResponseWithStatusCode: 200
+				    headers: gzipHeaders
+				       body: [OFData dataWithItems: "gzip"
+							     count: 4]
+				     forIRI: IRI];
+	[server cacheResponseWithStatusCode: 200
+				    headers: nil
+				       body: [OFData dataWithItems: "kept"
+							     count: 4]
+				     forIRI: [self IRIForPath: @"/kept"]];
+
+	[server removeCachedResponsesForIRI: IRI];
+
+	[self requestPath: @"/removed"
+	     extraHeaders: @"Accept-Encoding: gzip\r\n"
+		  headers: headers
+		     body: &body];
+	OTAssertEqualObjects([headers objectForKey: @"X-Requests"], @"1");
+
+	[headers removeAllObjects];
+	[self requestPath: @"/kept" headers: headers body: &body];
+	OTAssertNil([headers objectForKey: @"X-Requests"]);
+	OTAssertEqualObjects(body, @"kept");
+}
+@end
+
+@implementation HTTPServerTestsThread
+@synthesize condition = _condition, server = _server, port = _port;
+
+- (instancetype)init
+{
+	self = [super init];
+
+	@try {
+		_condition = [[OFCondition alloc] init];
+	} @catch (id e) {
+		[self release];
+		@throw e;
+	}
+
+	return self;
+}
+
+- (void)dealloc
+{
+	[_condition release];
+	[_server release];
+
+	[super dealloc];
+}
+
+- (id)main
+{
+	[_condition lock];
+
+	_server = [[OFHTTPServer alloc] init];
+	_server.host = @"127.0.0.1";
+	_server.name = @"ObjFW-Tests";
+	_server.delegate = self;
+	[_server start];
+	_port = _server.port;
+
+	[_condition signal];
+	[_condition unlock];
+
+	[[OFRunLoop currentRunLoop] run];
+
+	[_server stop];
+
+	return nil;
+}
+
+-      (void)server: (OFHTTPServer *)server
+  didReceiveRequest: (OFHTTPRequest *)request
+	requestBody: (OFStream *)requestBody
+	   response: (OFHTTPResponse *)response
+{
+	OFDictionary *headers = request.headers;
+	OFMutableString *body = [OFMutableString stringWithString: @"\n"];
+
+	_numberOfRequests++;
+
+	/* Echo the received headers, sorted to make the order predictable. */
+	for (OFString *key in headers.allKeys.sortedArray)
+		[body appendFormat: @"%@: %@\n",
+				    key, [headers objectForKey: key]];
+
+	response.statusCode = 200;
+	response.headers = [OFDictionary dictionaryWithKeysAndObjects:
+	    @"Content-Length",
+	    [OFString stringWithFormat: @"%zu", body.UTF8StringLength],
+	    @"X-Requests",
+	    [OFString stringWithFormat: @"%zu", _numberOfRequests], nil];
+	[response writeString: body];
+	[response close];
+}
+@end
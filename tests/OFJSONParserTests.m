@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#import "ObjFW.h"
+#import "ObjFWTest.h"
+
+@interface OFJSONParserTests: OTTestCase <OFJSONParserDelegate>
+{
+	OFMutableArray *_events;
+}
+@end
+
+@implementation OFJSONParserTests
+- (void)setUp
+{
+	[super setUp];
+
+	_events = [[OFMutableArray alloc] init];
+}
+
+- (void)dealloc
+{
+	[_events release];
+
+	[super dealloc];
+}
+
+- (void)parserDidStartDictionary: (OFJSONParser *)parser
+{
+	[_events addObject: @"{"];
+}
+
+- (void)parserDidEndDictionary: (OFJSONParser *)parser
+{
+	[_events addObject: @"}"];
+}
+
+- (void)parserDidStartArray: (OFJSONParser *)parser
+{
+	[_events addObject: @"["];
+}
+
+- (void)parserDidEndArray: (OFJSONParser *)parser
+{
+	[_events addObject: @"]"];
+}
+
+- (void)parser: (OFJSONParser *)parser foundKey: (OFString *)key
+{
+	[_events addObject: [OFString stringWithFormat: @"key:%@", key]];
+}
+
+- (void)parser: (OFJSONParser *)parser foundValue: (id)value
+{
+	[_events addObject: value];
+}
+
+- (void)parserDidEndDocument: (OFJSONParser *)parser
+{
+	[_events addObject: @"end"];
+}
+
+- (void)testParser
+{
+	static const char *JSON = "{\"f\\u00F6o\": [1, -2.5, "
+	    "\"b\\na\\ud83d\\ude00r\", true, false, null],\n\"x\": {}} [] 3";
+	OFJSONParser *parser = [OFJSONParser parser];
+	size_t length = strlen(JSON);
+
+	parser.delegate = self;
+
+	/* Feed byte by byte to make sure chunk boundaries don't matter. */
+	for (size_t i = 0; i < length; i++)
+		[parser parseBuffer: JSON + i length: 1];
+
+	[parser finishParsing];
+
+	OTAssertEqualObjects(_events, ([OFArray arrayWithObjects:
+	    @"{", @"key:f\xC3\xB6o", @"[",
+	    [OFNumber numberWithInt: 1], [OFNumber numberWithDouble: -2.5],
+	    @"b\na\xF0\x9F\x98\x80r", [OFNumber numberWithBool: true],
+	    [OFNumber numberWithBool: false], [OFNull null], @"]",
+	    @"key:x", @"{", @"}", @"}", @"end", @"[", @"]", @"end",
+	    [OFNumber numberWithInt: 3], @"end", nil]));
+	OTAssertEqual(parser.lineNumber, 2);
+}
+
+- (void)testDetectionOfInvalidJSON
+{
+	OFJSONParser *parser;
+
+	parser = [OFJSONParser parser];
+	OTAssertThrowsSpecific([parser parseString: @"[1,]"],
+	    OFInvalidJSONException);
+
+	parser = [OFJSONParser parser];
+	OTAssertThrowsSpecific([parser parseString: @"{\"a\" 1}"],
+	    OFInvalidJSONException);
+
+	parser = [OFJSONParser parser];
+	OTAssertThrowsSpecific([parser parseString: @"[01]"],
+	    OFInvalidJSONException);
+
+	parser = [OFJSONParser parser];
+	OTAssertThrowsSpecific([parser parseString: @"[1}"],
+	    OFInvalidJSONException);
+
+	parser = [OFJSONParser parser];
+	[parser parseString: @"{\"a\": [1"];
+	OTAssertThrowsSpecific([parser finishParsing], OFInvalidJSONException);
+}
+
+- (void)testResetAfterError
+{
+	OFJSONParser *parser = [OFJSONParser parser];
+
+	parser.delegate = self;
+	OTAssertThrowsSpecific([parser parseString: @"{\"a\": [tru "],
+	    OFInvalidJSONException);
+
+	[_events removeAllObjects];
+	[parser parseString: @"[1]"];
+	[parser finishParsing];
+
+	OTAssertEqualObjects(_events, ([OFArray arrayWithObjects:
+	    @"[", [OFNumber numberWithInt: 1], @"]", @"end", nil]));
+}
+
+- (void)testDepthLimit
+{
+	OFJSONParser *parser = [OFJSONParser parser];
+
+	parser.depthLimit = 3;
+	[parser parseString: @"[[]]"];
+
+	parser = [OFJSONParser parser];
+	parser.depthLimit = 3;
+	OTAssertThrowsSpecific([parser parseString: @"[[[]]]"],
+	    OFInvalidJSONException);
+}
+@end
@@ -60,6 +60,32 @@ static OFString *string = @"{\"f\\0o\x6f\"\t:'b\\na\\r', \"x\":/*foo*/ [.5\r,"
 	OTAssertEqualObjects(string.objectByParsingJSON, _dictionary);
 }
 
+- (void)testObjectByParsingJSONFromData
+{
+	OFData *data = [OFData dataWithItems: string.UTF8String
+				       count: string.UTF8StringLength];
+
+	OTAssertEqualObjects(data.objectByParsingJSON, _dictionary);
+
+	OTAssertThrowsSpecific(
+	    [[OFData dataWithItems: "\"\xFF\"" count: 3] objectByParsingJSON],
+	    OFInvalidJSONException);
+}
+
+- (void)testObjectByParsingJSONWithRepeatedKeys
+{
+	OFDictionary *first = [OFDictionary dictionaryWithKeysAndObjects:
+	    @"a", [OFNumber numberWithInt: 1],
+	    @"b", [OFNumber numberWithInt: -2], nil];
+	OFDictionary *second = [OFDictionary dictionaryWithKeysAndObjects:
+	    @"a", [OFNumber numberWithInt: 3],
+	    @"b", [OFNumber numberWithInt: -4], nil];
+
+	OTAssertEqualObjects(
+	    @"[{\"a\":1,b:-2},{\"a\":3,b:-4}]".objectByParsingJSON,
+	    ([OFArray arrayWithObjects: first, second, nil]));
+}
+
 - (void)testJSONRepresentation
 {
 	OTAssert(_dictionary.JSONRepresentation,
@@ -91,6 +117,18 @@ static OFString *string = @"{\"f\\0o\x6f\"\t:'b\\na\\r', \"x\":/*foo*/ [.5\r,"
 	    @"{\"f\\0oo\":\"b\\\na\\r\",x:[0.5,15,null,\"fo\\0o\",false]}");
 }
 
+- (void)testStringJSONRepresentation
+{
+	OTAssertEqualObjects(@"\"t\\\u00E4st\b\f\t\"".JSONRepresentation,
+	    @"\"\\\"t\\\\\u00E4st\\b\\f\\t\\\"\"");
+	OTAssertEqualObjects([@"$foo" JSONRepresentationWithOptions:
+	    OFJSONRepresentationOptionJSON5 |
+	    OFJSONRepresentationOptionIsIdentifier], @"$foo");
+	OTAssertEqualObjects([@"fo'o" JSONRepresentationWithOptions:
+	    OFJSONRepresentationOptionJSON5 |
+	    OFJSONRepresentationOptionIsIdentifier], @"\"fo'o\"");
+}
+
 - (void)testObjectByParsingJSONFailsWithInvalidJSON
 {
 	OTAssertThrowsSpecific([@"{" objectByParsingJSON],
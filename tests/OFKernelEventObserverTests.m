@@ -28,6 +28,9 @@
 #ifdef HAVE_EPOLL
 # import "OFEpollKernelEventObserver.h"
 #endif
+#ifdef HAVE_IO_URING
+# import "OFIOUringKernelEventObserver.h"
+#endif
 #ifdef HAVE_POLL
 # import "OFPollKernelEventObserver.h"
 #endif
@@ -150,6 +153,17 @@ static const size_t numExpectedEvents = 3;
 }
 #endif
 
+#ifdef HAVE_IO_URING
+- (void)testIOUringKernelEventObserver
+{
+	if (![OFIOUringKernelEventObserver isSupported])
+		OTSkip(@"io_uring unsupported by kernel");
+
+	[self testKernelEventObserverWithClass:
+	    [OFIOUringKernelEventObserver class]];
+}
+#endif
+
 #ifdef HAVE_KQUEUE
 - (void)testKqueueKernelEventObserver
 {
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2008-2025 Jonathan Schleifer <js@nil.im>
+ *
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3.0 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * version 3.0 for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * version 3.0 along with this program. If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#import "ObjFW.h"
+#import "ObjFWTest.h"
+
+@interface OFMessagePackParserTests: OTTestCase <OFMessagePackParserDelegate>
+{
+	OFMutableArray *_objects;
+}
+@end
+
+/* {"a": [1, -1, bin "xyz"], "b": nil}, "test" */
+static const char *representation =
+    "\x82\xA1" "a" "\x93\x01\xFF\xC4\x03xyz\xA1" "b" "\xC0\xA4" "test";
+
+@implementation OFMessagePackParserTests
+- (void)setUp
+{
+	[super setUp];
+
+	_objects = [[OFMutableArray alloc] init];
+}
+
+- (void)dealloc
+{
+	[_objects release];
+
+	[super dealloc];
+}
+
+- (void)parser: (OFMessagePackParser *)parser didParseObject: (id)object
+{
+	[_objects addObject: object];
+}
+
+- (OFArray *)expectedObjects
+{
+	return [OFArray arrayWithObjects:
+	    [OFDictionary dictionaryWithKeysAndObjects:
+		@"a", [OFArray arrayWithObjects:
+		    [OFNumber numberWithUnsignedChar: 1],
+		    [OFNumber numberWithChar: -1],
+		    [OFData dataWithItems: "xyz" count: 3], nil],
+		@"b", [OFNull null], nil],
+	    @"test", nil];
+}
+
+- (void)testParseBuffer
+{
+	OFMessagePackParser *parser = [OFMessagePackParser parser];
+
+	parser.delegate = self;
+	[parser parseBuffer: representation length: strlen(representation)];
+	[parser finishParsing];
+
+	OTAssertEqualObjects(_objects, [self expectedObjects]);
+}
+
+- (void)testParseBufferByteByByte
+{
+	OFMessagePackParser *parser = [OFMessagePackParser parser];
+	size_t length = strlen(representation);
+
+	parser.delegate = self;
+
+	for (size_t i = 0; i < length; i++) {
+		[parser parseBuffer: representation + i length: 1];
+
+		if (i == 12)
+			OTAssertEqual(_objects.count, 0);
+	}
+
+	OTAssertFalse(parser.hasIncompleteObject);
+	OTAssertEqualObjects(_objects, [self expectedObjects]);
+}
+
+- (void)testParseStream
+{
+	OFMessagePackParser *parser = [OFMessagePackParser parser];
+	OFMemoryStream *stream = [OFMemoryStream
+	    streamWithMemoryAddress: (void *)representation
+			       size: strlen(representation)
+			   writable: false];
+
+	parser.delegate = self;
+	[parser parseStream: stream];
+
+	OTAssertEqualObjects(_objects, [self expectedObjects]);
+}
+
+- (void)testTruncatedInput
+{
+	OFMessagePackParser *parser = [OFMessagePackParser parser];
+
+	parser.delegate = self;
+	[parser parseBuffer: "\x92\x01" length: 2];
+
+	OTAssertTrue(parser.hasIncompleteObject);
+	OTAssertThrowsSpecific([parser finishParsing],
+	    OFTruncatedDataException);
+}
+
+- (void)testInvalidInput
+{
+	OFMessagePackParser *parser = [OFMessagePackParser parser];
+
+	parser.delegate = self;
+
+	OTAssertThrowsSpecific([parser parseBuffer: "\xC1" length: 1],
+	    OFInvalidFormatException);
+}
+
+- (void)testResetAfterError
+{
+	OFMessagePackParser *parser = [OFMessagePackParser parser];
+
+	parser.delegate = self;
+	[parser parseBuffer: "\x92\x01" length: 2];
+
+	OTAssertThrowsSpecific([parser parseBuffer: "\xC1" length: 1],
+	    OFInvalidFormatException);
+	OTAssertFalse(parser.hasIncompleteObject);
+
+	[parser parseBuffer: representation length: strlen(representation)];
+	[parser finishParsing];
+
+	OTAssertEqualObjects(_objects, [self expectedObjects]);
+}
+
+- (void)testDepthLimit
+{
+	OFMessagePackParser *parser = [OFMessagePackParser parser];
+
+	parser.delegate = self;
+	parser.depthLimit = 2;
+
+	OTAssertThrowsSpecific([parser parseBuffer: "\x91\x91\x91\x01"
+					    length: 4],
+	    OFOutOfRangeException);
+}
+@end
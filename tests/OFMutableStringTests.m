@@ -140,6 +140,37 @@ static OFString *const whitespace[] = {
 	OTAssertEqualObjects(_mutableString, @"tä😀€🤔");
 }
 
+- (void)testCharacterAtIndexAfterMutation
+{
+	for (size_t i = 0; i < 20; i++)
+		[_mutableString appendString: @"täṠ€🤔"];
+
+	OTAssertEqual([_mutableString characterAtIndex: 99], 0x1F914);
+
+	[_mutableString insertString: @"ö" atIndex: 0];
+	OTAssertEqual([_mutableString characterAtIndex: 99], 0x20AC);
+	OTAssertEqual([_mutableString characterAtIndex: 100], 0x1F914);
+}
+
+- (void)testAppendAndDeleteRepeatedly
+{
+	OFMutableString *string = [self.stringClass string];
+
+	for (size_t i = 0; i < 1000; i++)
+		[string appendString: @"aä"];
+
+	OTAssertEqual(string.length, 2000);
+	OTAssertEqual(string.UTF8StringLength, 3000);
+
+	[string deleteCharactersInRange: OFMakeRange(0, 1996)];
+	OTAssertEqualObjects(string, @"aäaä");
+
+	[string appendUTF8String: "b"];
+	[string insertString: @"c" atIndex: 2];
+	OTAssertEqualObjects(string, @"aäcaäb");
+	OTAssertEqual(string.UTF8StringLength, 8);
+}
+
 - (void)testDeleteCharactersInRange
 {
 	[_mutableString deleteCharactersInRange: OFMakeRange(2, 2)];
@@ -207,6 +238,11 @@ static OFString *const whitespace[] = {
 	string = [self.stringClass stringWithString: @"XX"];
 	[string replaceOccurrencesOfString: @"X" withString: @"XX"];
 	OTAssertEqualObjects(string, @"XXXX");
+
+	string = [self.stringClass stringWithString: @"a-ä-a-ä-a"];
+	[string replaceOccurrencesOfString: @"-" withString: @""];
+	OTAssertEqualObjects(string, @"aäaäa");
+	OTAssertEqual(string.length, 5);
 }
 
 - (void)testReplaceOccurrencesOfStringWithStringOptionsRange
@@ -214,6 +214,29 @@ static const unsigned char testVector4[64] = {
 
 	OTAssertEqual(memcmp(output, testVector2, 64), 0);
 }
+
+# ifdef OF_HAVE_THREADS
+- (void)testRFC7941TestVector2WithThreads
+{
+	unsigned char output[64];
+
+	OFScrypt((OFScryptParameters){
+		.blockSize             = 8,
+		.costFactor            = 1024,
+		.parallelization       = 16,
+		.salt                  = (unsigned char *)"NaCl",
+		.saltLength            = 4,
+		.password              = "password",
+		.passwordLength        = 8,
+		.key                   = output,
+		.keyLength             = 64,
+		.allowsSwappableMemory = true,
+		.numberOfThreads       = 3
+	});
+
+	OTAssertEqual(memcmp(output, testVector2, 64), 0);
+}
+# endif
 #endif
 
 /*
@@ -25,6 +25,11 @@
 
 #import "OFStringTests.h"
 
+#ifdef OF_OBJFW_RUNTIME
+# import "OFTaggedPointerString.h"
+#endif
+#import "OFUTF8String.h"
+
 #ifndef INFINITY
 # define INFINITY __builtin_inf()
 #endif
@@ -105,6 +110,51 @@ static const char *range80ToFF =
 	    @"täṠ€".hash);
 }
 
+- (void)testHashIsEqualAcrossClasses
+{
+	/* Covers all lengths around the maximum of tagged pointer strings. */
+	OFString *const strings[] = {
+		@"", @"a", @"abc", @"abcd", @"abcde", @"abcdefg", @"abcdefgh",
+		@"abcdefghi", @"ä", @"täṠ€🤔", @"Größenänderung",
+		@"The quick brown fox jumps over the lazy dog"
+	};
+
+	for (size_t i = 0; i < sizeof(strings) / sizeof(*strings); i++) {
+		OFString *constantString = strings[i];
+		const char *UTF8String = constantString.UTF8String;
+		unsigned long hash = constantString.hash;
+		OFString *string;
+
+		string = [[[OFUTF8String alloc]
+		    initWithUTF8String: UTF8String] autorelease];
+		OTAssertEqual(string.hash, hash);
+
+		/* May be a tagged pointer string or an OFUTF8String. */
+		string = [OFString stringWithUTF8String: UTF8String];
+		OTAssertEqual(string.hash, hash);
+
+		string = [OFMutableString stringWithUTF8String: UTF8String];
+		OTAssertEqual(string.hash, hash);
+
+		string = [CustomString stringWithString: constantString];
+		OTAssertEqual(string.hash, hash);
+
+#ifdef OF_OBJFW_RUNTIME
+		/* Only ASCII strings fit into a tagged pointer. */
+		if (constantString.length > 0 &&
+		    constantString.length <= sizeof(uintptr_t) &&
+		    constantString.length == constantString.UTF8StringLength) {
+			string = [OFTaggedPointerString
+			    stringWithASCIIString: UTF8String
+					   length: constantString.length];
+
+			OTAssertTrue(object_isTaggedPointer(string));
+			OTAssertEqual(string.hash, hash);
+		}
+#endif
+	}
+}
+
 - (void)testCopy
 {
 	OTAssertEqualObjects([[_string copy] autorelease], _string);
@@ -185,6 +235,31 @@ static const char *range80ToFF =
 	OTAssertEqual([_string characterAtIndex: 4], 0x1F914);
 }
 
+- (void)testCharacterAtIndexInLongString
+{
+	OFMutableString *tmp = [OFMutableString string];
+	OFString *string;
+	OFUnichar characters[3];
+
+	for (size_t i = 0; i < 100; i++)
+		[tmp appendString: @"täṠ€🤔"];
+
+	string = [self.stringClass stringWithString: tmp];
+
+	for (size_t i = 0; i < 500; i += 5) {
+		OTAssertEqual([string characterAtIndex: i], 't');
+		OTAssertEqual([string characterAtIndex: i + 4], 0x1F914);
+	}
+
+	OTAssertEqualObjects([string substringWithRange: OFMakeRange(317, 4)],
+	    @"Ṡ€🤔t");
+
+	[string getCharacters: characters inRange: OFMakeRange(497, 3)];
+	OTAssertEqual(characters[0], 0x1E60);
+	OTAssertEqual(characters[1], 0x20AC);
+	OTAssertEqual(characters[2], 0x1F914);
+}
+
 - (void)testCharacterAtIndexFailsWithOutOfRangeIndex
 {
 	OTAssertThrowsSpecific([_string characterAtIndex: 5],
@@ -254,6 +329,23 @@ static const char *range80ToFF =
 	    OFInvalidEncodingException);
 }
 
+- (void)testStringWithLongUTF8String
+{
+	OFString *string = [self.stringClass stringWithUTF8String:
+	    "0123456789abcdef" "t\xC3\xA4st" "0123456789abcdef"
+	    "\xF0\x9F\xA4\x94"];
+
+	OTAssertEqual(string.length, 37);
+	OTAssertEqual(string.UTF8StringLength, 41);
+
+	OTAssertEqual([self.stringClass stringWithUTF8String: "0123456789abcdef"
+	    "0123\0" "56789abcdef" length: 27].length, 27);
+
+	OTAssertThrowsSpecific([self.stringClass stringWithUTF8String:
+	    "0123456789abcdef" "0123456789abcde\x80"],
+	    OFInvalidEncodingException);
+}
+
 - (void)testStringWithCStringEncodingISO8859_1
 {
 	OTAssertEqualObjects([self.stringClass
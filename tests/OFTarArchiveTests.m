@@ -69,4 +69,55 @@
 
 	OTAssertNil([archive nextEntry]);
 }
+
+- (void)testRandomAccess
+{
+	OFMemoryStream *stream = [OFMemoryStream
+	    streamWithMemoryAddress: _buffer
+			       size: bufferSize
+			   writable: true];
+	OFTarArchive *archive = [OFTarArchive archiveWithStream: stream
+							   mode: @"w"];
+	OFData *index;
+	size_t size;
+
+	for (OFString *name in [OFArray arrayWithObjects:
+	    @"a.txt", @"b.txt", @"c.txt", nil]) {
+		OFMutableTarArchiveEntry *entry =
+		    [OFMutableTarArchiveEntry entryWithFileName: name];
+		OFStream *entryStream;
+
+		entry.uncompressedSize = name.UTF8StringLength;
+		entryStream = [archive streamForWritingEntry: entry];
+		[entryStream writeString: name];
+	}
+
+	[archive close];
+
+	size = (size_t)[stream seekToOffset: 0 whence: OFSeekCurrent];
+	OTAssertLessThanOrEqual(size, bufferSize);
+
+	stream = [OFMemoryStream streamWithMemoryAddress: _buffer
+						    size: size
+						writable: false];
+	archive = [OFTarArchive archiveWithStream: stream mode: @"r"];
+
+	OTAssertEqualObjects(
+	    [[archive streamForReadingFile: @"b.txt"] readLine], @"b.txt");
+	OTAssertEqualObjects([archive nextEntry].fileName, @"c.txt");
+	OTAssertEqualObjects(
+	    [[archive streamForReadingFile: @"a.txt"] readLine], @"a.txt");
+	OTAssertThrowsSpecific([archive streamForReadingFile: @"d.txt"],
+	    OFOpenItemFailedException);
+
+	index = [archive index];
+
+	[stream seekToOffset: 0 whence: OFSeekSet];
+	archive = [OFTarArchive archiveWithStream: stream mode: @"r"];
+	[archive loadIndex: index];
+
+	OTAssertEqualObjects(
+	    [[archive streamForReadingFile: @"c.txt"] readLine], @"c.txt");
+	OTAssertNil([archive nextEntry]);
+}
 @end
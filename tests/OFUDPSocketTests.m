@@ -24,10 +24,30 @@
 #import "ObjFW.h"
 #import "ObjFWTest.h"
 
-@interface OFUDPSocketTests: OTTestCase
+@interface OFUDPSocketTests: OTTestCase <OFDatagramSocketDelegate>
+{
+	OFMutableArray OF_GENERIC(OFString *) *_receivedStrings;
+	size_t _sentCount;
+	id _exception;
+}
 @end
 
 @implementation OFUDPSocketTests
+- (void)setUp
+{
+	[super setUp];
+
+	_receivedStrings = [[OFMutableArray alloc] init];
+}
+
+- (void)dealloc
+{
+	[_receivedStrings release];
+	[_exception release];
+
+	[super dealloc];
+}
+
 - (void)testUDPSocket
 {
 	OFUDPSocket *sock = [OFUDPSocket socket];
@@ -47,4 +67,108 @@
 	OTAssertEqual(OFSocketAddressIPPort(&addr2),
 	    OFSocketAddressIPPort(&addr1));
 }
+
+- (void)testSendAndReceivePackets
+{
+	OFUDPSocket *sock = [OFUDPSocket socket];
+	OFSocketAddress addr;
+	char sendBuffers[3][4] = { "foo", "bar", "baz" }, buffers[3][4];
+	OFDatagramSocketPacket packets[3];
+	size_t received = 0;
+
+	addr = [sock bindToHost: @"127.0.0.1" port: 0];
+
+	for (size_t i = 0; i < 3; i++) {
+		packets[i].buffer = sendBuffers[i];
+		packets[i].length = 4;
+		packets[i].address = addr;
+	}
+
+	[sock sendPackets: packets count: 3];
+
+	for (size_t i = 0; i < 3; i++) {
+		packets[i].buffer = buffers[i];
+		packets[i].length = 4;
+	}
+
+	while (received < 3)
+		received += [sock receivePackets: packets + received
+					   count: 3 - received];
+
+	OTAssertEqual(received, 3);
+	OTAssertEqual(memcmp(buffers[0], "foo", 4), 0);
+	OTAssertEqual(memcmp(buffers[1], "bar", 4), 0);
+	OTAssertEqual(memcmp(buffers[2], "baz", 4), 0);
+
+	for (size_t i = 0; i < 3; i++) {
+		OTAssertEqual(packets[i].length, 4);
+		OTAssertEqual(OFSocketAddressIPPort(&packets[i].address),
+		    OFSocketAddressIPPort(&addr));
+	}
+}
+
+- (void)testAsyncSendAndReceivePackets
+{
+	OFUDPSocket *sock = [OFUDPSocket socket];
+	OFSocketAddress addr;
+	char sendBuffers[3][4] = { "foo", "bar", "baz" }, buffers[3][4];
+	OFDatagramSocketPacket sendPackets[3], packets[3];
+
+	addr = [sock bindToHost: @"127.0.0.1" port: 0];
+	sock.delegate = self;
+
+	for (size_t i = 0; i < 3; i++) {
+		sendPackets[i].buffer = sendBuffers[i];
+		sendPackets[i].length = 4;
+		sendPackets[i].address = addr;
+
+		packets[i].buffer = buffers[i];
+		packets[i].length = 4;
+	}
+
+	[sock asyncReceivePackets: packets count: 3];
+	[sock asyncSendPackets: sendPackets count: 3];
+
+	[[OFRunLoop mainRunLoop] runUntilDate:
+	    [OFDate dateWithTimeIntervalSinceNow: 1]];
+
+	OTAssertNil(_exception);
+	OTAssertEqual(_sentCount, 3);
+	OTAssertEqualObjects(_receivedStrings,
+	    ([OFArray arrayWithObjects: @"foo", @"bar", @"baz", nil]));
+}
+
+-   (bool)socket: (OFDatagramSocket *)sock
+  didSendPackets: (const OFDatagramSocketPacket *)packets
+	   count: (size_t)count
+       exception: (id)exception
+{
+	_sentCount = count;
+	[_exception release];
+	_exception = [exception retain];
+
+	return false;
+}
+
+-    (bool)socket: (OFDatagramSocket *)sock
+  didReceivePackets: (OFDatagramSocketPacket *)packets
+	      count: (size_t)count
+	  exception: (id)exception
+{
+	if (exception != nil) {
+		[_exception release];
+		_exception = [exception retain];
+
+		return false;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		OTAssertEqual(packets[i].length, 4);
+		[_receivedStrings addObject:
+		    [OFString stringWithCString: packets[i].buffer
+				       encoding: OFStringEncodingASCII]];
+	}
+
+	return (_receivedStrings.count < 3);
+}
 @end
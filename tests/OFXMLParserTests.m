@@ -40,6 +40,22 @@ enum EventType {
 	eventTypeComment
 };
 
+static const char *document = "\xEF\xBB\xBF<?xml version='1.0'?><?p?i?>"
+    "<!DOCTYPE foo><root>\r\r"
+    " <![CDATA[f<]]]oo]]]><bar/>\n"
+    " <foobar xmlns='urn:objfw:test:foobar'>\r\n"
+    "  <qux xmlns:foo='urn:objfw:test:foo'>\n"
+    "   <foo:bla foo:bla = '&#x62;&#x6c;&#x61;' blafoo='foo'>\n"
+    "    <blup foo:qux='asd' quxqux='test'/>\n"
+    "    <bla:bla\r\rxmlns:bla\r=\t\"urn:objfw:test:bla\" qux='qux'\r\n"
+    "     bla:foo='blafoo'/>\n"
+    "    <abc xmlns='urn:objfw:test:abc' abc='abc' foo:abc='abc'/>\n"
+    "   </foo:bla>\n"
+    "   <!-- commänt -->\n"
+    "  </qux>\n"
+    " </foobar>\n"
+    "</root>";
+
 @implementation OFXMLParserTests
 -   (void)parser: (OFXMLParser *)parser
   didCreateEvent: (enum EventType)type
@@ -344,21 +360,6 @@ enum EventType {
 
 - (void)testParser
 {
-	static const char *string = "\xEF\xBB\xBF<?xml version='1.0'?><?p?i?>"
-	    "<!DOCTYPE foo><root>\r\r"
-	    " <![CDATA[f<]]]oo]]]><bar/>\n"
-	    " <foobar xmlns='urn:objfw:test:foobar'>\r\n"
-	    "  <qux xmlns:foo='urn:objfw:test:foo'>\n"
-	    "   <foo:bla foo:bla = '&#x62;&#x6c;&#x61;' blafoo='foo'>\n"
-	    "    <blup foo:qux='asd' quxqux='test'/>\n"
-	    "    <bla:bla\r\rxmlns:bla\r=\t\"urn:objfw:test:bla\" qux='qux'\r\n"
-	    "     bla:foo='blafoo'/>\n"
-	    "    <abc xmlns='urn:objfw:test:abc' abc='abc' foo:abc='abc'/>\n"
-	    "   </foo:bla>\n"
-	    "   <!-- commänt -->\n"
-	    "  </qux>\n"
-	    " </foobar>\n"
-	    "</root>";
 	OFXMLParser *parser;
 	size_t j, length;
 
@@ -366,16 +367,16 @@ enum EventType {
 	parser.delegate = self;
 
 	/* Simulate a stream where we only get chunks */
-	length = strlen(string);
+	length = strlen(document);
 
 	for (j = 0; j < length; j+= 2) {
 		if (parser.hasFinishedParsing)
 			abort();
 
 		if (j + 2 > length)
-			[parser parseBuffer: string + j length: 1];
+			[parser parseBuffer: document + j length: 1];
 		else
-			[parser parseBuffer: string + j length: 2];
+			[parser parseBuffer: document + j length: 2];
 	}
 
 	OTAssertEqual(_i, 32);
@@ -395,6 +396,18 @@ enum EventType {
 	    OFMalformedXMLException);
 }
 
+- (void)testParserWithSingleBuffer
+{
+	OFXMLParser *parser = [OFXMLParser parser];
+	parser.delegate = self;
+
+	[parser parseBuffer: document length: strlen(document)];
+
+	OTAssertEqual(_i, 32);
+	OTAssertEqual(parser.lineNumber, 18);
+	OTAssertTrue(parser.hasFinishedParsing);
+}
+
 - (void)testDetectionOfInvalidXMLProcessingInstructions
 {
 	OFXMLParser *parser;
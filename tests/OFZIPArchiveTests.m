@@ -64,4 +64,52 @@
 	OTAssertEqualObjects([entryStream readLine], @"Hello World!");
 	OTAssertNil([entryStream readLine]);
 }
+
+- (void)testInterleavedReading
+{
+	OFMemoryStream *stream = [OFMemoryStream
+	    streamWithMemoryAddress: _buffer
+			       size: bufferSize
+			   writable: true];
+	OFZIPArchive *archive = [OFZIPArchive archiveWithStream: stream
+							   mode: @"w"];
+	OFMutableZIPArchiveEntry *entry;
+	OFStream *entryStream1, *entryStream2;
+	size_t size;
+
+	entry = [OFMutableZIPArchiveEntry entryWithFileName: @"file1.txt"];
+	entryStream1 = [archive streamForWritingEntry: entry];
+	[entryStream1 writeString: @"Line 1\nLine 2\n"];
+
+	entry = [OFMutableZIPArchiveEntry entryWithFileName: @"file2.txt"];
+	entryStream2 = [archive streamForWritingEntry: entry];
+	[entryStream2 writeString: @"Line A\nLine B\n"];
+
+	[archive close];
+
+	size = (size_t)[stream seekToOffset: 0 whence: OFSeekCurrent];
+	OTAssertLessThanOrEqual(size, bufferSize);
+
+	stream = [OFMemoryStream streamWithMemoryAddress: _buffer
+						    size: size
+						writable: false];
+	archive = [OFZIPArchive archiveWithStream: stream mode: @"r"];
+
+	OTAssertThrowsSpecific([archive streamForReadingFile: @"file3.txt"],
+	    OFOpenItemFailedException);
+
+	entryStream1 = [archive streamForReadingFile: @"file1.txt"];
+	entryStream2 = [archive streamForReadingFile: @"file2.txt"];
+
+	OTAssertEqualObjects([entryStream2 readLine], @"Line A");
+	OTAssertEqualObjects([entryStream1 readLine], @"Line 1");
+	OTAssertEqualObjects([entryStream2 readLine], @"Line B");
+	OTAssertEqualObjects([entryStream1 readLine], @"Line 2");
+	OTAssertNil([entryStream1 readLine]);
+	OTAssertNil([entryStream2 readLine]);
+
+	OTAssertEqual(archive.entries.count, 2);
+	OTAssertEqualObjects([archive.entries.lastObject fileName],
+	    @"file2.txt");
+}
 @end